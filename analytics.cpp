@@ -0,0 +1,544 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the SeriesBatch class and its
+  kernels. Each kernel walks the years of the batch in order and, for each
+  year, a group of series at a time: as many as fit in a SIMD register
+  (LANES). The small set of operations the kernels need is defined below,
+  once with SSE2 intrinsics and once with plain doubles for other targets,
+  so each kernel is only written once.
+*/
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BETHYW_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "analytics.h"
+
+namespace {
+
+#ifdef BETHYW_SSE2
+
+const size_t LANES = 2;
+
+//A value for each of LANES series, and a true/false for each
+using Lanes = __m128d;
+using Mask = __m128d;
+
+inline Lanes load(const double* from) noexcept { return _mm_loadu_pd(from); }
+inline void store(double* to, Lanes x) noexcept { _mm_storeu_pd(to, x); }
+inline Lanes broadcast(double x) noexcept { return _mm_set1_pd(x); }
+inline Lanes add(Lanes a, Lanes b) noexcept { return _mm_add_pd(a, b); }
+inline Lanes sub(Lanes a, Lanes b) noexcept { return _mm_sub_pd(a, b); }
+inline Lanes mul(Lanes a, Lanes b) noexcept { return _mm_mul_pd(a, b); }
+inline Lanes div(Lanes a, Lanes b) noexcept { return _mm_div_pd(a, b); }
+inline Lanes lanesMin(Lanes a, Lanes b) noexcept { return _mm_min_pd(a, b); }
+inline Lanes lanesMax(Lanes a, Lanes b) noexcept { return _mm_max_pd(a, b); }
+inline Lanes lanesAbs(Lanes a) noexcept { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+inline Mask greater(Lanes a, Lanes b) noexcept { return _mm_cmpgt_pd(a, b); }
+inline Mask greaterOrEqual(Lanes a, Lanes b) noexcept { return _mm_cmpge_pd(a, b); }
+inline Mask notEqual(Lanes a, Lanes b) noexcept { return _mm_cmpneq_pd(a, b); }
+inline Mask both(Mask a, Mask b) noexcept { return _mm_and_pd(a, b); }
+inline Mask either(Mask a, Mask b) noexcept { return _mm_or_pd(a, b); }
+inline Mask butNot(Mask a, Mask b) noexcept { return _mm_andnot_pd(b, a); }
+inline Mask none() noexcept { return _mm_setzero_pd(); }
+//a where mask is true, otherwise b
+inline Lanes select(Mask mask, Lanes a, Lanes b) noexcept {
+	return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+#else
+
+const size_t LANES = 1;
+
+using Lanes = double;
+using Mask = bool;
+
+inline Lanes load(const double* from) noexcept { return *from; }
+inline void store(double* to, Lanes x) noexcept { *to = x; }
+inline Lanes broadcast(double x) noexcept { return x; }
+inline Lanes add(Lanes a, Lanes b) noexcept { return a + b; }
+inline Lanes sub(Lanes a, Lanes b) noexcept { return a - b; }
+inline Lanes mul(Lanes a, Lanes b) noexcept { return a * b; }
+inline Lanes div(Lanes a, Lanes b) noexcept { return a / b; }
+inline Lanes lanesMin(Lanes a, Lanes b) noexcept { return a < b ? a : b; }
+inline Lanes lanesMax(Lanes a, Lanes b) noexcept { return a > b ? a : b; }
+inline Lanes lanesAbs(Lanes a) noexcept { return std::fabs(a); }
+inline Mask greater(Lanes a, Lanes b) noexcept { return a > b; }
+inline Mask greaterOrEqual(Lanes a, Lanes b) noexcept { return a >= b; }
+inline Mask notEqual(Lanes a, Lanes b) noexcept { return a != b; }
+inline Mask both(Mask a, Mask b) noexcept { return a && b; }
+inline Mask either(Mask a, Mask b) noexcept { return a || b; }
+inline Mask butNot(Mask a, Mask b) noexcept { return a && !b; }
+inline Mask none() noexcept { return false; }
+inline Lanes select(Mask mask, Lanes a, Lanes b) noexcept { return mask ? a : b; }
+
+#endif
+
+/*
+  Add x to a compensated sum (Neumaier's variant of Kahan summation): comp
+  collects the low-order bits lost when adding to sum, and the total is
+  sum + comp.
+*/
+inline void accumulate(Lanes& sum, Lanes& comp, Lanes x) noexcept {
+	Lanes total = add(sum, x);
+	Mask sumLarger = greaterOrEqual(lanesAbs(sum), lanesAbs(x));
+	comp = add(comp, select(sumLarger, add(sub(sum, total), x), add(sub(x, total), sum)));
+	sum = total;
+}
+
+//As above, for a single value
+inline void accumulateOne(double& sum, double& comp, double x) noexcept {
+	double total = sum + x;
+	comp += std::fabs(sum) >= std::fabs(x) ? (sum - total) + x : (x - total) + sum;
+	sum = total;
+}
+
+//Returns count rounded up to a whole number of lanes
+inline size_t roundToLanes(size_t count) noexcept {
+	return (count + LANES - 1) / LANES * LANES;
+}
+
+} // namespace
+
+/*
+  stableSum(values, count)
+
+  Add up an array of values, LANES at a time, with a compensated sum.
+
+  @param values
+    The values to add up
+
+  @param count
+    The number of values
+
+  @return
+    The sum of the values
+
+  @example
+    std::vector<double> values = {1e16, 1, -1e16};
+    double sum = stableSum(values.data(), values.size()); // returns 1
+*/
+double stableSum(const double* values, size_t count) noexcept {
+	Lanes sum = broadcast(0), comp = broadcast(0);
+	const size_t whole = count / LANES * LANES;
+	for (size_t i = 0; i < whole; i += LANES){
+		accumulate(sum, comp, load(values + i));
+	}
+
+	double sums[LANES], comps[LANES];
+	store(sums, sum);
+	store(comps, comp);
+
+	double total = 0, error = 0;
+	for (size_t lane = 0; lane < LANES; lane++){
+		accumulateOne(total, error, sums[lane]);
+		accumulateOne(total, error, comps[lane]);
+	}
+	for (size_t i = whole; i < count; i++){
+		accumulateOne(total, error, values[i]);
+	}
+	return total + error;
+}
+
+//Returns the number of series in the summary
+size_t SeriesSummary::size() const noexcept {
+	return counts.size();
+}
+
+/*
+  SeriesBatch::SeriesBatch()
+
+  Construct an empty batch, with no series and no years.
+*/
+SeriesBatch::SeriesBatch() : firstYear(0), years(0), stride(0) {
+}
+
+/*
+  SeriesBatch::SeriesBatch(keys, firstYear, lastYear)
+
+  Construct a batch of series with no readings, covering a range of years.
+
+  @param keys
+    The area and measure of each series
+
+  @param firstYear
+    The first year of every series
+
+  @param lastYear
+    The last year of every series; if it is before firstYear, the batch has
+    no years
+
+  @example
+    SeriesBatch batch({{area, pop}, {area, dens}}, 2010, 2020);
+    batch.setValue(0, 2010, 242316);
+*/
+SeriesBatch::SeriesBatch(std::vector<Key> _keys, int _firstYear, int lastYear)
+		: keys(std::move(_keys)),
+		  firstYear(_firstYear),
+		  years(lastYear < _firstYear ? 0 : size_t(int64_t(lastYear) - _firstYear + 1)),
+		  stride(roundToLanes(keys.size())),
+		  values(years * stride, 0),
+		  present(years * stride, 0) {
+}
+
+/*
+  SeriesBatch::SeriesBatch(areas)
+
+  Construct a batch holding every measure of every area in a container of
+  Area objects, as one series each, over the years from the earliest
+  reading of any of them to the latest.
+
+  @param areas
+    The Area objects to copy the readings of
+
+  @example
+    Areas data = Areas();
+    data.populate(...);
+    SeriesBatch batch = data.toSeriesBatch();
+    SeriesSummary summary = batch.summarise();
+*/
+SeriesBatch::SeriesBatch(const AreasContainer& areas) : SeriesBatch() {
+	std::vector<Key> found;
+	int first = INT_MAX, last = INT_MIN;
+	for (auto ar = areas.begin(); ar != areas.end(); ar++){
+		const std::map<InternId, Measure>& measures = ar->second.getMeasuresById();
+		for (auto it = measures.begin(); it != measures.end(); it++){
+			found.push_back(Key{ar->first, it->first});
+			if (it->second.size() > 0){
+				first = std::min(first, it->second.getFirstYear());
+				last = std::max(last, it->second.getLastYear());
+			}
+		}
+	}
+
+	*this = first <= last ? SeriesBatch(std::move(found), first, last)
+	                      : SeriesBatch(std::move(found), 0, -1);
+
+	size_t series = 0;
+	for (auto ar = areas.begin(); ar != areas.end(); ar++){
+		const std::map<InternId, Measure>& measures = ar->second.getMeasuresById();
+		for (auto it = measures.begin(); it != measures.end(); it++, series++){
+			for (auto yearValue : it->second){
+				const size_t i = size_t(yearValue.first - firstYear) * stride + series;
+				values[i] = yearValue.second;
+				present[i] = 1;
+			}
+		}
+	}
+}
+
+//Returns the number of series in the batch
+size_t SeriesBatch::size() const noexcept {
+	return keys.size();
+}
+
+//Returns the first year of every series
+int SeriesBatch::getFirstYear() const noexcept {
+	return firstYear;
+}
+
+//Returns the last year of every series, which is before the first if there
+//are no years
+int SeriesBatch::getLastYear() const noexcept {
+	return firstYear + static_cast<int>(years) - 1;
+}
+
+//Returns the area and measure of each series
+const std::vector<SeriesBatch::Key>& SeriesBatch::getKeys() const noexcept {
+	return keys;
+}
+
+//Returns the index in values and present of a series' reading for a year
+size_t SeriesBatch::slot(size_t series, int year) const {
+	if (series >= keys.size()){
+		throw std::out_of_range("SeriesBatch::slot: No series " + std::to_string(series));
+	}
+	if (year < firstYear || year > getLastYear()){
+		throw std::out_of_range("SeriesBatch::slot: Year " + std::to_string(year)
+				+ " is outside the batch");
+	}
+	return size_t(year - firstYear) * stride + series;
+}
+
+/*
+  SeriesBatch::setValue(series, year, value)
+
+  Set the reading of a series for a year.
+
+  @param series
+    The index of the series
+
+  @param year
+    The year, which must be within the batch's years
+
+  @param value
+    The reading
+
+  @throws
+    std::out_of_range if there is no such series or year in the batch
+*/
+void SeriesBatch::setValue(size_t series, int year, double value) {
+	const size_t i = slot(series, year);
+	values[i] = value;
+	present[i] = 1;
+}
+
+/*
+  SeriesBatch::hasValue(series, year)
+
+  @param series
+    The index of the series
+
+  @param year
+    The year
+
+  @return
+    true if the series has a reading for the year
+
+  @throws
+    std::out_of_range if there is no such series in the batch
+*/
+bool SeriesBatch::hasValue(size_t series, int year) const {
+	if (series >= keys.size()){
+		throw std::out_of_range("SeriesBatch::hasValue: No series " + std::to_string(series));
+	}
+	if (year < firstYear || year > getLastYear()){
+		return false;
+	}
+	return present[slot(series, year)] != 0;
+}
+
+/*
+  SeriesBatch::getValue(series, year)
+
+  @param series
+    The index of the series
+
+  @param year
+    The year
+
+  @return
+    The reading of the series for the year
+
+  @throws
+    std::out_of_range if there is no such series, or it has no reading for
+    the year
+*/
+double SeriesBatch::getValue(size_t series, int year) const {
+	if (!hasValue(series, year)){
+		throw std::out_of_range("SeriesBatch::getValue: No value found for year "
+				+ std::to_string(year));
+	}
+	return values[slot(series, year)];
+}
+
+/*
+  SeriesBatch::summarise()
+
+  Calculate the count, mean, minimum, maximum, standard deviation, first and
+  last readings, change and compound annual growth rate of every series.
+  Each group of LANES series is read twice: once for the sum and everything
+  else, then once more for the deviations from the mean, while its readings
+  are still in the cache.
+
+  @return
+    The statistics of every series
+
+  @example
+    SeriesSummary summary = areas.toSeriesBatch().summarise();
+    for (size_t i = 0; i < summary.size(); i++) {
+      ... batch.getKeys()[i], summary.means[i] ...
+    }
+*/
+SeriesSummary SeriesBatch::summarise() const {
+	SeriesSummary summary;
+	summary.counts.resize(keys.size());
+	summary.means.resize(keys.size());
+	summary.minimums.resize(keys.size());
+	summary.maximums.resize(keys.size());
+	summary.deviations.resize(keys.size());
+	summary.firsts.resize(keys.size());
+	summary.lasts.resize(keys.size());
+	summary.differences.resize(keys.size());
+	summary.percentages.resize(keys.size());
+	summary.growthRates.resize(keys.size());
+
+	const Lanes zero = broadcast(0), one = broadcast(1);
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	for (size_t s = 0; s < stride; s += LANES){
+		Lanes count = zero, sum = zero, comp = zero;
+		Lanes minimum = broadcast(infinity), maximum = broadcast(-infinity);
+		Lanes first = zero, firstAt = zero, last = zero, lastAt = zero;
+		Mask seen = none();
+
+		for (size_t y = 0; y < years; y++){
+			const Lanes value = load(&values[y * stride + s]);
+			const Lanes has = load(&present[y * stride + s]);
+			const Mask reading = greater(has, zero);
+			const Lanes year = broadcast(static_cast<double>(y));
+
+			//missing years hold 0, so they add nothing to the sum
+			count = add(count, has);
+			accumulate(sum, comp, value);
+
+			minimum = select(reading, lanesMin(minimum, value), minimum);
+			maximum = select(reading, lanesMax(maximum, value), maximum);
+
+			const Mask firstReading = butNot(reading, seen);
+			first = select(firstReading, value, first);
+			firstAt = select(firstReading, year, firstAt);
+			seen = either(seen, reading);
+			last = select(reading, value, last);
+			lastAt = select(reading, year, lastAt);
+		}
+
+		//the squared deviations from the mean, over the same (cached) years
+		const Lanes mean = div(add(sum, comp), lanesMax(count, one));
+		Lanes squares = zero;
+		for (size_t y = 0; y < years; y++){
+			const Lanes value = load(&values[y * stride + s]);
+			const Mask reading = greater(load(&present[y * stride + s]), zero);
+			const Lanes deviation = select(reading, sub(value, mean), zero);
+			squares = add(squares, mul(deviation, deviation));
+		}
+
+		double counts[LANES], means[LANES], squaresOut[LANES];
+		double minimums[LANES], maximums[LANES];
+		double firsts[LANES], firstAts[LANES], lasts[LANES], lastAts[LANES];
+		store(counts, count);
+		store(means, mean);
+		store(squaresOut, squares);
+		store(minimums, minimum);
+		store(maximums, maximum);
+		store(firsts, first);
+		store(firstAts, firstAt);
+		store(lasts, last);
+		store(lastAts, lastAt);
+
+		for (size_t lane = 0; lane < LANES && s + lane < keys.size(); lane++){
+			const size_t i = s + lane;
+			const double n = counts[lane];
+			if (n == 0){
+				continue;
+			}
+
+			summary.counts[i] = static_cast<size_t>(n);
+			summary.means[i] = means[lane];
+			summary.minimums[i] = minimums[lane];
+			summary.maximums[i] = maximums[lane];
+			summary.deviations[i] = std::sqrt(squaresOut[lane] / n);
+			summary.firsts[i] = firsts[lane];
+			summary.lasts[i] = lasts[lane];
+			summary.differences[i] = lasts[lane] - firsts[lane];
+			if (firsts[lane] != 0){
+				summary.percentages[i] = summary.differences[i] / firsts[lane] * 100;
+			}
+			const double span = lastAts[lane] - firstAts[lane];
+			if (span > 0 && firsts[lane] > 0 && lasts[lane] >= 0){
+				summary.growthRates[i] = std::pow(lasts[lane] / firsts[lane], 1 / span) - 1;
+			}
+		}
+	}
+
+	return summary;
+}
+
+/*
+  SeriesBatch::growth()
+
+  Calculate the year-over-year growth of every series: the change from one
+  year to the next as a percentage of the first. There is a reading for a
+  year only where the series has readings for it and the year before, and
+  the year before is not 0.
+
+  @return
+    A batch of the same series and years holding the growth
+*/
+SeriesBatch SeriesBatch::growth() const {
+	SeriesBatch result(keys, firstYear, getLastYear());
+	const Lanes zero = broadcast(0), one = broadcast(1), hundred = broadcast(100);
+
+	for (size_t y = 1; y < years; y++){
+		for (size_t s = 0; s < stride; s += LANES){
+			const size_t now = y * stride + s, before = now - stride;
+			const Lanes value = load(&values[now]);
+			const Lanes previous = load(&values[before]);
+			const Mask reading = both(both(greater(load(&present[now]), zero),
+			                               greater(load(&present[before]), zero)),
+			                          notEqual(previous, zero));
+
+			//lanes divided by 0 are thrown away by the select
+			const Lanes change = mul(div(sub(value, previous), previous), hundred);
+			store(&result.values[now], select(reading, change, zero));
+			store(&result.present[now], select(reading, one, zero));
+		}
+	}
+
+	return result;
+}
+
+/*
+  SeriesBatch::rollingMean(window)
+
+  Calculate the rolling mean of every series: for each year, the mean of the
+  readings in the window of years ending with it. There is a reading for a
+  year if there is at least one reading in its window.
+
+  @param window
+    The number of years in each window
+
+  @return
+    A batch of the same series and years holding the rolling means
+
+  @throws
+    std::invalid_argument if window is 0
+
+  @example
+    //the three-year rolling mean of every series
+    SeriesBatch smoothed = batch.rollingMean(3);
+*/
+SeriesBatch SeriesBatch::rollingMean(unsigned int window) const {
+	if (window == 0){
+		throw std::invalid_argument("SeriesBatch::rollingMean: The window must be at least 1 year");
+	}
+
+	SeriesBatch result(keys, firstYear, getLastYear());
+	const Lanes zero = broadcast(0), one = broadcast(1);
+
+	for (size_t y = 0; y < years; y++){
+		//each window is summed afresh, as a running sum would gather error
+		const size_t from = y + 1 >= window ? y + 1 - window : 0;
+		for (size_t s = 0; s < stride; s += LANES){
+			Lanes count = zero, sum = zero, comp = zero;
+			for (size_t w = from; w <= y; w++){
+				count = add(count, load(&present[w * stride + s]));
+				accumulate(sum, comp, load(&values[w * stride + s]));
+			}
+
+			const Mask reading = greater(count, zero);
+			const Lanes mean = div(add(sum, comp), lanesMax(count, one));
+			store(&result.values[y * stride + s], select(reading, mean, zero));
+			store(&result.present[y * stride + s], select(reading, one, zero));
+		}
+	}
+
+	return result;
+}
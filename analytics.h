@@ -0,0 +1,111 @@
+#ifndef ANALYTICS_H_
+#define ANALYTICS_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the SeriesBatch class, which computes
+  statistics over the time series of many measures at once. Measure can
+  already give the average and change of one series, but asking that of
+  every area and measure means visiting each Measure in turn. A SeriesBatch
+  instead copies every series into one dense matrix of years by series, so
+  that a kernel walks the years once and works on several series side by
+  side in each step, using SIMD instructions where the target has them
+  (SSE2 on x86-64).
+
+  Sums are compensated (Kahan-Babuska-Neumaier), and the variance is summed
+  from the deviations from the mean rather than from the squares of the
+  values, so long series of large, similar values (e.g. population counts)
+  do not lose precision.
+ */
+
+#include <cstddef>
+#include <vector>
+
+#include "areas.h"
+#include "intern.h"
+
+/*
+  Add up values with a compensated sum, which keeps the error to about one
+  rounding whatever the number of values.
+*/
+double stableSum(const double* values, size_t count) noexcept;
+
+/*
+  Statistics for every series in a SeriesBatch. Element i of each array
+  belongs to series i of the batch. Statistics that cannot be calculated
+  (e.g. the mean of a series with no readings, or the percentage change
+  from 0) are 0, as in Measure.
+*/
+struct SeriesSummary {
+  std::vector<size_t> counts;
+  std::vector<double> means;
+  std::vector<double> minimums;
+  std::vector<double> maximums;
+  //population standard deviation
+  std::vector<double> deviations;
+  std::vector<double> firsts;
+  std::vector<double> lasts;
+  //last - first, and that as a percentage of first
+  std::vector<double> differences;
+  std::vector<double> percentages;
+  //compound annual growth rate from the first to the last reading, as a
+  //fraction (0.05 is 5% a year)
+  std::vector<double> growthRates;
+
+  size_t size() const noexcept;
+};
+
+/*
+  The readings of many series over a shared range of years, held as a dense
+  matrix: the readings of every series for one year are next to each other
+  in memory, so a kernel loads the same year of several series in one go.
+  Years without a reading hold 0 and are marked as missing.
+
+  Each series is identified by the area and measure it came from, if it was
+  built from an Areas instance. A SeriesBatch is a snapshot: it does not
+  change if the Areas instance it was built from is modified afterwards.
+*/
+class SeriesBatch {
+public:
+  struct Key {
+    InternId area;
+    InternId measure;
+  };
+
+private:
+	std::vector<Key> keys;
+	int firstYear;
+	size_t years;
+	//series per year in values and present, rounded up to a whole number of
+	//SIMD lanes; the padding series never have readings
+	size_t stride;
+	std::vector<double> values;
+	//1 where there is a reading and 0 where there is not
+	std::vector<double> present;
+
+	size_t slot(size_t series, int year) const;
+public:
+  SeriesBatch();
+  SeriesBatch(std::vector<Key> keys, int firstYear, int lastYear);
+  explicit SeriesBatch(const AreasContainer& areas);
+
+  size_t size() const noexcept;
+  int getFirstYear() const noexcept;
+  int getLastYear() const noexcept;
+  const std::vector<Key>& getKeys() const noexcept;
+
+  void setValue(size_t series, int year, double value);
+  bool hasValue(size_t series, int year) const;
+  double getValue(size_t series, int year) const;
+
+  SeriesSummary summarise() const;
+  SeriesBatch growth() const;
+  SeriesBatch rollingMean(unsigned int window) const;
+};
+
+#endif // ANALYTICS_H_
@@ -17,10 +17,14 @@
   must implement has a TODO block comment. 
 */
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
+#include <string_view>
+#include <utility>
 
 #include "area.h"
+#include "tablewriter.h"
 
 /*
   TODO: Area::Area(localAuthorityCode)
@@ -33,10 +37,26 @@
   @example
     Area("W06000023");
 */
-Area::Area(const std::string& localAuthorityCode): authorityCode(localAuthorityCode) {
+Area::Area(const std::string& localAuthorityCode)
+    : authorityCode(InternTable::global().intern(localAuthorityCode)) {
   //throw std::logic_error("Area::Area() has not been implemented!");
 }
 
+/*
+  Area::Area(localAuthorityCode)
+
+  Construct an Area with a local authority code that is already interned.
+
+  @param localAuthorityCode
+    The ID of the local authority code in InternTable::global()
+
+  @example
+    Area(InternTable::global().intern("W06000023"));
+*/
+Area::Area(InternId localAuthorityCode) noexcept
+    : authorityCode(localAuthorityCode) {
+}
+
 /*
   TODO: Area::getLocalAuthorityCode()
 
@@ -51,7 +71,12 @@ Area::Area(const std::string& localAuthorityCode): authorityCode(localAuthorityC
     ...
     auto authCode = area.getLocalAuthorityCode();
 */
-const std::string Area::getLocalAuthorityCode() const{
+const std::string& Area::getLocalAuthorityCode() const{
+	return InternTable::global().lookup(this->authorityCode);
+}
+
+//Returns the ID of the local authority code in InternTable::global()
+InternId Area::getLocalAuthorityCodeId() const noexcept{
 	return this->authorityCode;
 }
 
@@ -79,24 +104,28 @@ const std::string Area::getLocalAuthorityCode() const{
     ...
     auto name = area.getName(langCode);
 */
-const std::string Area::getName(std::string lang) const{
+const std::string& Area::getName(const std::string& lang) const{
 	if (lang.length() != 3){
 			throw std::invalid_argument("Area::getName: Language code must be three alphabetical letters only");
 		}
+		//lowercase into a local buffer rather than a new string
+		char lower[3];
 		for (size_t i =0; i<lang.length();i++){
-			if(isdigit(lang[i])){
+			if(isdigit(static_cast<unsigned char>(lang[i]))){
 				throw std::invalid_argument("Area::getName: Language code must be three alphabetical letters only");
 			} else {
-				lang[i] = (char) tolower(lang[i]);
+				lower[i] = InternTable::toLower(lang[i]);
 			}
 		}
-	auto it = this->names.find(lang);
-
-	if (it != this->names.end()){
-		return it->second;
-	} else {
-		throw std::out_of_range("Could not find name of language");
+	InternTable& strings = InternTable::global();
+	InternId langId;
+	if (strings.find(std::string_view(lower, 3), langId)){
+		auto it = this->names.find(langId);
+		if (it != this->names.end()){
+			return strings.lookup(it->second);
+		}
 	}
+	throw std::out_of_range("Could not find name of language");
 }
 
 /*
@@ -129,18 +158,36 @@ void Area::setName(std::string lang, std::string name){
 		throw std::invalid_argument("Area::setName: Language code must be three alphabetical letters only");
 	}
 	for (size_t i =0; i<lang.length();i++){
-		if(isdigit(lang[i])){
+		if(isdigit(static_cast<unsigned char>(lang[i]))){
 			throw std::invalid_argument("Area::setName: Language code must be three alphabetical letters only");
 		} else {
-			lang[i] = (char) tolower(lang[i]);
+			lang[i] = InternTable::toLower(lang[i]);
 		}
 	}
-	auto it = names.find(lang);
-	if (it != names.end()){
-		names.erase(it);
-	}
-	names.insert({lang,name});
+	InternTable& strings = InternTable::global();
+	setName(strings.intern(lang), strings.intern(name));
+}
+
+/*
+  Area::setName(lang, name)
+
+  As above, but with a language code and name that are already interned. The
+  language code is not checked, so it must already be a lowercase three
+  letter code.
+
+  @param lang
+    The ID of the language code
 
+  @param name
+    The ID of the name of the Area in `lang`
+
+  @example
+    InternTable& strings = InternTable::global();
+    Area area("W06000023");
+    area.setName(strings.intern("eng"), strings.intern("Powys"));
+*/
+void Area::setName(InternId lang, InternId name){
+	names.insert_or_assign(lang,name);
 }
 
 /*
@@ -167,17 +214,55 @@ void Area::setName(std::string lang, std::string name){
     ...
     auto measure2 = area.getMeasure("pop");
 */
-Measure& Area::getMeasure(std::string key){
-	for (size_t i = 0; i<key.length();i++){
-		key[i] = (char) tolower(key[i]);
+Measure& Area::getMeasure(const std::string& key){
+	return const_cast<Measure&>(static_cast<const Area&>(*this).getMeasure(key));
+}
+
+//As above, but for a constant Area
+const Measure& Area::getMeasure(const std::string& key) const{
+	std::string lower = key;
+	for (size_t i = 0; i<lower.length();i++){
+		lower[i] = InternTable::toLower(lower[i]);
 	}
-	auto it = this->measures.find(key);
+	InternId keyId;
+	if (InternTable::global().find(lower, keyId)){
+		auto it = this->measures.find(keyId);
+		if (it != this->measures.end()){
+			return it->second;
+		}
+	}
+	throw std::out_of_range("No measure found matching " + lower);
+}
 
-	if (it != this->measures.end()){
-		return it->second;
-	} else {
-		throw std::out_of_range("No measure found matching " + key);
+/*
+  Area::getMeasure(key, label)
+
+  Retrieve a Measure object given the ID of its codename, adding an empty
+  Measure with that codename and label if there is not one already. This lets
+  the parsers add values to a Measure in place.
+
+  @param key
+    The ID of the lowercase codename for the measure
+
+  @param label
+    The ID of the label to use if the Measure has to be added
+
+  @return
+    Reference to the Measure stored in this Area
+
+  @example
+    InternTable& strings = InternTable::global();
+    Area area("W06000023");
+    Measure& measure = area.getMeasure(strings.intern("pop"),
+                                       strings.intern("Population"));
+    measure.setValue(1999, 12345678.9);
+*/
+Measure& Area::getMeasure(InternId key, InternId label){
+	auto it = this->measures.find(key);
+	if (it == this->measures.end()){
+		it = this->measures.emplace(key, Measure(key, label)).first;
 	}
+	return it->second;
 }
 
 /*
@@ -213,30 +298,105 @@ Measure& Area::getMeasure(std::string key){
     area.setMeasure(codename, measure);
 */
 void Area::setMeasure(std::string key, Measure measure){
-	for (size_t i = 0; i<key.length();i++){
-			key[i] = (char) tolower(key[i]);
-	}
+	setMeasure(InternTable::global().internLower(key), std::move(measure));
+}
+
+/*
+  Area::setMeasure(key, measure)
+
+  As above, but with the ID of the lowercase codename.
+
+  @param key
+    The ID of the lowercase codename for the Measure
+
+  @param measure
+    The Measure object
+
+  @example
+    Area area("W06000023");
+    Measure measure("Pop", "Population");
+    area.setMeasure(measure.getCodenameId(), measure);
+*/
+void Area::setMeasure(InternId key, Measure measure){
 	auto meas = this->measures.find(key);
 	if (meas==this->measures.end()){
-		this->measures.insert({key,measure});
+		this->measures.emplace(key,std::move(measure));
 	} else {
 		Measure& oldMeasure = meas->second;
-		std::map<int,double> vals = measure.getValues();
-		for (auto it = vals.begin(); it != vals.end();it++){
-			oldMeasure.setValue(it->first,it->second);
+		for (auto yearValue : measure){
+			oldMeasure.setValue(yearValue.first, yearValue.second);
 		}
 	}
 }
 
-//Returns the full list of measures for the area
+//Returns a copy of the measures for the area, keyed by codename. Only kept for
+//the coursework interface; use getMeasuresInOrder() or getMeasuresById() instead
 std::map<std::string,Measure> Area::getMeasures() const{
-	return this->measures;
+	InternTable& strings = InternTable::global();
+	std::map<std::string,Measure> result;
+	for (auto it = this->measures.begin(); it != this->measures.end(); it++){
+		result.emplace(strings.lookup(it->first), it->second);
+	}
+	return result;
 }
 
-//Returns full list of names for the area
+//Returns a copy of the names for the area, keyed by language code. Only kept for
+//the coursework interface; use getNamesById() instead
 const std::map<std::string,std::string> Area::getNames() const{
+	InternTable& strings = InternTable::global();
+	std::map<std::string,std::string> result;
+	for (auto it = this->names.begin(); it != this->names.end(); it++){
+		result.emplace(strings.lookup(it->first), strings.lookup(it->second));
+	}
+	return result;
+}
+//Returns the measures for the area, keyed by the ID of their codename
+const std::map<InternId,Measure>& Area::getMeasuresById() const noexcept{
+	return this->measures;
+}
+
+//Returns the names for the area, keyed by the ID of their language code
+const std::map<InternId,InternId>& Area::getNamesById() const noexcept{
 	return this->names;
 }
+
+/*
+  Area::getMeasuresInOrder()
+
+  Retrieve the measures for the area in order of their codenames, without
+  copying them. Measures are stored by the ID of their codename, which is not
+  alphabetical, so this is what output functions should iterate over.
+
+  @return
+    Pointers to the Measure objects stored in this Area, valid until the Area
+    is next modified
+
+  @example
+    Area area("W06000023");
+    ...
+    for (const Measure* measure : area.getMeasuresInOrder()) {
+      std::cout << *measure;
+    }
+*/
+std::vector<const Measure*> Area::getMeasuresInOrder() const{
+	InternTable& strings = InternTable::global();
+	std::vector<std::pair<const std::string*, const Measure*>> ordered;
+	ordered.reserve(this->measures.size());
+	for (auto it = this->measures.begin(); it != this->measures.end(); it++){
+		ordered.emplace_back(&strings.lookup(it->first), &it->second);
+	}
+	std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+		return *a.first < *b.first;
+	});
+
+	std::vector<const Measure*> result;
+	result.reserve(ordered.size());
+	for (auto it = ordered.begin(); it != ordered.end(); it++){
+		result.push_back(it->second);
+	}
+	return result;
+}
+
 /*
   TODO: Area::size()
 
@@ -286,6 +446,9 @@ const int Area::namesSize() const noexcept{
 
   See the coursework specification for more examples.
 
+  The output is rendered by TableWriter (see tablewriter.h) and reaches the
+  stream in a few large writes.
+
   @param os
     The output stream to write to
 
@@ -300,17 +463,9 @@ const int Area::namesSize() const noexcept{
     area.setName("eng", "Powys");
     std::cout << area << std::endl;
 */
-std::ostream& operator<<(std::ostream& os, Area ar){
-	os << ar.getName("eng") << " / " << ar.getName("cym") << " ("
-			<< ar.getLocalAuthorityCode() << ")\n";
-	if (ar.size() > 0){
-		std::map<std::string,Measure> measures = ar.getMeasures();
-		for (auto it = measures.begin(); it != measures.end();it++){
-			os << it->second;
-		}
-	}else {
-		os << "<no measures>\n";
-	}
+std::ostream& operator<<(std::ostream& os, const Area& ar){
+	TableWriter writer(os);
+	writer.write(ar);
 	return os;
 }
 
@@ -337,17 +492,18 @@ std::ostream& operator<<(std::ostream& os, Area ar){
 
     bool eq = area1 == area2;
 */
-bool operator==(Area lhs, Area rhs){
-	if (lhs.getLocalAuthorityCode() != rhs.getLocalAuthorityCode()){
+bool operator==(const Area& lhs, const Area& rhs){
+	if (lhs.getLocalAuthorityCodeId() != rhs.getLocalAuthorityCodeId()){
 		return false;
 	}
 	if (lhs.size() != rhs.size()){
 		return false;
 	}
-	if (lhs.getMeasures() != rhs.getMeasures()){
+	//equal strings have equal IDs, so the maps can be compared directly
+	if (lhs.getMeasuresById() != rhs.getMeasuresById()){
 		return false;
 	}
-	if (lhs.getNames() != rhs.getNames()){
+	if (lhs.getNamesById() != rhs.getNamesById()){
 		return false;
 	}
 	return true;
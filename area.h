@@ -18,6 +18,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "measure.h"
 
@@ -26,28 +27,44 @@
   for the area in any number of different languages, and a container for the
   Measures objects.
 
+  The authority code, language codes, names and measure codenames are held as
+  IDs in InternTable::global(). The containers are therefore ordered by ID
+  rather than alphabetically. getNames() and getMeasures() are only kept
+  for the coursework interface: they build copies keyed by the strings, in
+  alphabetical order, on every call, so nothing in the program calls them;
+  use getNamesById(), getMeasuresById() or getMeasuresInOrder() instead.
+
   TODO: Based on your implementation, there may be additional constructors
   or functions you implement here, and perhaps additional operators you may wish
   to overload.
 */
 class Area {
 private:
-  const std::string authorityCode;
-  std::map<std::string,std::string> names;
-  std::map<std::string,Measure> measures;
+  InternId authorityCode;
+  std::map<InternId,InternId> names;
+  std::map<InternId,Measure> measures;
 public:
   Area(const std::string& localAuthorityCode);
-  const std::string getLocalAuthorityCode() const;
-  const std::string getName(std::string lang) const;
+  Area(InternId localAuthorityCode) noexcept;
+  const std::string& getLocalAuthorityCode() const;
+  InternId getLocalAuthorityCodeId() const noexcept;
+  const std::string& getName(const std::string& lang) const;
   void setName(std::string lang, std::string name);
-  Measure& getMeasure(std::string key);
+  void setName(InternId lang, InternId name);
+  Measure& getMeasure(const std::string& key);
+  const Measure& getMeasure(const std::string& key) const;
+  Measure& getMeasure(InternId key, InternId label);
   void setMeasure(std::string key, Measure measure);
+  void setMeasure(InternId key, Measure measure);
   std::map<std::string,Measure> getMeasures() const;
   const std::map<std::string,std::string> getNames() const;
+  const std::map<InternId,Measure>& getMeasuresById() const noexcept;
+  const std::map<InternId,InternId>& getNamesById() const noexcept;
+  std::vector<const Measure*> getMeasuresInOrder() const;
   const int size() const noexcept;
   const int namesSize() const noexcept;
 };
-bool operator==(Area lhs, Area rhs);
-std::ostream& operator<<(std::ostream&, Area ar);
+bool operator==(const Area& lhs, const Area& rhs);
+std::ostream& operator<<(std::ostream&, const Area& ar);
 
 #endif // AREA_H_
@@ -0,0 +1,187 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the AreaParts class. See
+  areaparts.h for details.
+*/
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "areaparts.h"
+#include "scheduler.h"
+
+/*
+  AreaParts::AreaParts(shards)
+
+  Construct an empty AreaParts.
+
+  @param shards
+    The number of buckets of areas, i.e. how many threads can hand over
+    parts at once without waiting for each other
+
+  @throws
+    std::invalid_argument if shards is 0, with the message:
+    AreaParts::AreaParts: There must be at least one shard
+
+  @example
+    AreaParts combined;
+*/
+AreaParts::AreaParts(size_t shards) {
+	if (shards == 0){
+		throw std::invalid_argument(
+				"AreaParts::AreaParts: There must be at least one shard");
+	}
+	for (size_t i = 0; i < shards; i++){
+		this->shards.push_back(std::make_unique<Shard>());
+	}
+}
+
+//The shard an area is kept in. IDs are handed out in order, so consecutive
+//codes land in different shards.
+size_t AreaParts::shardOf(InternId code) const noexcept {
+	return code % shards.size();
+}
+
+/*
+  AreaParts::setArea(code, area, order)
+
+  Add an Area, to be combined with any others for the same code by
+  moveInto(). This can be called from several threads at once.
+
+  @param code
+    The ID of the local authority code of the Area
+
+  @param area
+    The Area to add
+
+  @param order
+    Where the Area comes relative to the others for the same code: data from
+    a higher order takes precedence. Parts should not share an order.
+
+  @example
+    combined.setArea(area.getLocalAuthorityCodeId(), area, 0);
+*/
+void AreaParts::setArea(InternId code, Area area, size_t order) {
+	Shard& shard = *shards[shardOf(code)];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	shard.areas[code].emplace_back(order, std::move(area));
+}
+
+/*
+  AreaParts::merge(part, order)
+
+  Move all the Area objects from an Areas instance into this one, as with
+  setArea(). This can be called from several threads at once, and locks
+  each shard once however many areas part has.
+
+  @param part
+    The Areas instance to move the data from, which is left empty
+
+  @param order
+    Where part comes relative to the other parts, see setArea()
+
+  @example
+    combined.merge(std::move(shard), i);
+*/
+void AreaParts::merge(Areas&& part, size_t order) {
+	AreasContainer taken = part.takeAreas();
+
+	std::vector<std::vector<std::pair<InternId, Area*>>> byShard(shards.size());
+	for (auto& codeArea : taken){
+		byShard[shardOf(codeArea.first)].emplace_back(codeArea.first, &codeArea.second);
+	}
+	for (size_t i = 0; i < shards.size(); i++){
+		if (byShard[i].empty()){
+			continue;
+		}
+		Shard& shard = *shards[i];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		for (auto& codeArea : byShard[i]){
+			shard.areas[codeArea.first].emplace_back(order, std::move(*codeArea.second));
+		}
+	}
+}
+
+/*
+  AreaParts::size()
+
+  @return
+    The number of different areas added so far
+*/
+size_t AreaParts::size() const {
+	size_t total = 0;
+	for (const auto& shard : shards){
+		std::lock_guard<std::mutex> lock(shard->mutex);
+		total += shard->areas.size();
+	}
+	return total;
+}
+
+/*
+  AreaParts::moveInto(areas, threads)
+
+  Combine the parts added for each area in chunk order, and move the results
+  into an Areas instance. The buckets are combined in parallel, as tasks on
+  BethYw::TaskScheduler::global(), as no area is in more than one. This
+  instance is left empty. Nothing else may add areas meanwhile.
+
+  @param areas
+    The Areas instance to move the data into. Areas that already exist there
+    are combined using Areas::setArea(), so the data added here takes
+    precedence.
+
+  @param threads
+    The most shards to combine at once
+
+  @return
+    void
+
+  @example
+    Areas data = Areas();
+    combined.moveInto(data, 4);
+*/
+void AreaParts::moveInto(Areas& areas, unsigned int threads) {
+	std::vector<Areas> combined(shards.size());
+	auto combine = [&](size_t i) {
+		Shard& shard = *shards[i];
+		for (auto& codeParts : shard.areas){
+			auto& parts = codeParts.second;
+			std::stable_sort(parts.begin(), parts.end(), [](const auto& a, const auto& b) {
+				return a.first < b.first;
+			});
+			for (auto& part : parts){
+				combined[i].setArea(codeParts.first, std::move(part.second));
+			}
+		}
+		shard.areas.clear();
+	};
+
+	size_t blocks = std::min<size_t>(std::max(1u, threads), shards.size());
+	if (blocks == 1){
+		for (size_t i = 0; i < shards.size(); i++){
+			combine(i);
+		}
+	} else {
+		BethYw::TaskGroup group;
+		for (size_t b = 0; b < blocks; b++){
+			group.run([&, b]() {
+				for (size_t i = shards.size() * b / blocks; i < shards.size() * (b + 1) / blocks; i++){
+					combine(i);
+				}
+			});
+		}
+		group.wait();
+	}
+
+	for (Areas& shard : combined){
+		areas.merge(std::move(shard));
+	}
+}
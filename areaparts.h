@@ -0,0 +1,76 @@
+#ifndef AREAPARTS_H_
+#define AREAPARTS_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the AreaParts class, which collects
+  the Areas instances parsed from the chunks of a large file by tasks
+  running at once (see Areas::populateFromWelshStatsJSON()), and then
+  merges them in chunk order.
+
+  Each task parses its chunk into an Areas instance of its own, as an Areas
+  instance is not thread-safe, and hands it over with its chunk number when
+  it finishes. So that tasks finishing together wait little for each other,
+  the areas handed over are kept in buckets by the ID of their authority
+  code, each with its own lock. moveInto() then combines the parts of each
+  area in chunk order, one task per group of buckets, so the result is the
+  same as merging the chunks one after another: a value from a later chunk
+  replaces one from an earlier chunk, as with Measure::setValue().
+
+  Records are not added one at a time; a chunk is only handed over once it
+  has been parsed.
+ */
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "area.h"
+#include "areas.h"
+#include "intern.h"
+
+/*
+  The Areas instances parsed from the chunks of a file, waiting to be
+  merged, in chunk order, into another Areas instance:
+
+    AreaParts combined;
+    BethYw::TaskGroup group;
+    for (size_t i = 0; i < parts.size(); i++){
+      group.run([&, i]() { combined.merge(std::move(parts[i]), i); });
+    }
+    group.wait();
+    combined.moveInto(areas);
+*/
+class AreaParts {
+private:
+	//the parts for each area, tagged with their chunk number
+	struct Shard {
+		std::mutex mutex;
+		std::map<InternId, std::vector<std::pair<size_t, Area>>> areas;
+	};
+
+	std::vector<std::unique_ptr<Shard>> shards;
+
+	size_t shardOf(InternId code) const noexcept;
+public:
+  static constexpr size_t DEFAULT_SHARDS = 64;
+
+  explicit AreaParts(size_t shards = DEFAULT_SHARDS);
+  AreaParts(const AreaParts&) = delete;
+  AreaParts& operator=(const AreaParts&) = delete;
+
+  void setArea(InternId code, Area area, size_t order);
+  void merge(Areas&& part, size_t order);
+
+  size_t size() const;
+  void moveInto(Areas& areas, unsigned int threads = 1);
+};
+
+#endif // AREAPARTS_H_
@@ -18,24 +18,105 @@
   must implement has a TODO block comment. 
 */
 
+#include <algorithm>
+#include <exception>
 #include <stdexcept>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <thread>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <sstream>
+#include <iterator>
 
-#include "lib_json.hpp"
-
+#include "analytics.h"
+#include "csv.h"
 #include "datasets.h"
+#include "facts.h"
+#include "index.h"
+#include "intern.h"
+#include "jsonwriter.h"
 #include "areas.h"
+#include "areaparts.h"
 #include "measure.h"
+#include "pipeline.h"
+#include "scheduler.h"
+#include "tablewriter.h"
+
+namespace {
+
+/*
+  The smallest share of a StatsWales JSON file worth parsing on its own
+  thread. Smaller files are parsed on the calling thread.
+*/
+constexpr size_t MIN_JSON_CHUNK_BYTES = 4 * 1024 * 1024;
+
+/*
+  The size of the blocks that the import pipeline reads and parses StatsWales
+  JSON files in. Files of fewer than two blocks are parsed in one go.
+*/
+constexpr size_t PIPELINE_BLOCK_BYTES = 1024 * 1024;
+
+//The most blocks, or batches of records, waiting between two stages
+constexpr size_t PIPELINE_QUEUE_CAPACITY = 4;
+
+//The size of a page of memory
+constexpr size_t PAGE_BYTES = 4096;
+
+/*
+  Read a byte from each page of block, so that the pages of a mapped file
+  are loaded from disk by the read stage of the import pipeline, rather than
+  one at a time as the parse stage gets to them.
+*/
+void touchPages(std::string_view block) {
+	volatile char sink = 0;
+	for (size_t i = 0; i < block.size(); i += PAGE_BYTES){
+		sink = block[i];
+	}
+	(void) sink;
+}
 
 /*
-  An alias for the imported JSON parsing library.
+  The fewest areas worth formatting as a block of their own. Smaller outputs
+  are formatted on the calling thread.
 */
-using json = nlohmann::json;
+constexpr size_t MIN_FORMAT_AREAS = 256;
+
+/*
+  Split areas, in order, into `blocks` blocks of about the same size, and
+  format each into a string with format(first, last, text) as a task on
+  BethYw::TaskScheduler::global(). The strings are returned in order.
+*/
+template <typename Format>
+std::vector<std::string> formatBlocks(const std::vector<const Area*>& areas,
+		size_t blocks,
+		Format format) {
+	std::vector<std::string> text(blocks);
+	BethYw::TaskGroup group;
+	for (size_t i = 0; i < blocks; i++){
+		group.run([&, i]() {
+			const Area* const* first = areas.data() + areas.size() * i / blocks;
+			const Area* const* last = areas.data() + areas.size() * (i + 1) / blocks;
+			format(first, last, text[i]);
+		});
+	}
+	group.wait();
+	return text;
+}
+
+/*
+  Read the whole of a stream into a string, so that the stream-based populate
+  functions can share the buffer-based implementations.
+*/
+std::string readAll(std::istream& is) {
+	return std::string(std::istreambuf_iterator<char>(is),
+			std::istreambuf_iterator<char>());
+}
+
+} // namespace
 
 /*
   TODO: Areas::Areas()
@@ -76,22 +157,157 @@ Areas::Areas() {
 */
 
 void Areas::setArea(std::string code, Area area){
+	setArea(InternTable::global().intern(code), std::move(area));
+}
+
+/*
+  Areas::setArea(localAuthorityCode, area)
+
+  As above, but with the ID of the local authority code.
+
+  @param localAuthorityCode
+    The ID of the local authority code of the Area
+
+  @param area
+    The Area object that will contain the Measure objects
+
+  @example
+    Areas data = Areas();
+    Area area("W06000023");
+    data.setArea(area.getLocalAuthorityCodeId(), area);
+*/
+void Areas::setArea(InternId code, Area area){
 	auto ar = areas.find(code);
 	if (ar!=areas.end()){
 
 		Area& oldArea = ar->second;
-		std::map<std::string, Measure> measures = area.getMeasures();
+		const std::map<InternId, Measure>& measures = area.getMeasuresById();
 		for (auto it = measures.begin(); it != measures.end();it++){
 			oldArea.setMeasure(it->first,it->second);
 		}
-		std::map<std::string,std::string> names = area.getNames();
+		const std::map<InternId,InternId>& names = area.getNamesById();
 		for (auto it2 = names.begin(); it2 != names.end();it2++){
 			oldArea.setName(it2->first,it2->second);
 		}
 	} else {
-		areas.insert({code,area});
+		areas.emplace(code,std::move(area));
+	}
+}
+/*
+  Areas::merge(other)
+
+  Move all the Area objects from another Areas instance into this one. Areas
+  that already exist here are combined using setArea(), so data from `other`
+  takes precedence, exactly as if `other` had been populated straight into
+  this instance after its existing data. `other` is left empty.
+
+  @param other
+    The Areas instance to take the data from
+
+  @return
+    void
+
+  @example
+    Areas data = Areas();
+    Areas shard = Areas();
+    shard.populate(...);
+    data.merge(std::move(shard));
+*/
+void Areas::merge(Areas&& other){
+	for (auto it = other.areas.begin(); it != other.areas.end(); it++){
+		auto ar = areas.find(it->first);
+		if (ar == areas.end()){
+			areas.emplace(it->first, std::move(it->second));
+		} else {
+			setArea(it->first, std::move(it->second));
+		}
 	}
+	other.areas.clear();
 }
+
+/*
+  Areas::takeAreas()
+
+  Move all the Area objects out of this instance, leaving it empty, e.g. to
+  hand them to an AreaParts (see areaparts.h).
+
+  @return
+    The Area objects, keyed by the ID of their local authority code
+
+  @example
+    AreasContainer taken = data.takeAreas();
+*/
+AreasContainer Areas::takeAreas() noexcept {
+	AreasContainer taken;
+	taken.swap(areas);
+	return taken;
+}
+
+/*
+  Areas::merge(other, filter)
+
+  Copy the Area objects from another Areas instance into this one, keeping
+  only the areas, measures and years that pass a filter. The result is the
+  same as if the data `other` was populated from had been populated into
+  this instance with the same filter: an Area that had data, but has none
+  left after filtering, is not copied at all, while an Area that only ever
+  had names (e.g. from areas.csv) is copied if its code passes the filter.
+
+  @param other
+    The Areas instance to copy the data from, which is not modified
+
+  @param filter
+    The filter to apply
+
+  @return
+    void
+
+  @example
+    StringFilterSet areasFilter = {"W06000011"};
+    RecordFilter filter(&areasFilter, nullptr, nullptr);
+
+    Areas swansea = Areas();
+    swansea.merge(data, filter);
+*/
+void Areas::merge(const Areas& other, const RecordFilter& filter){
+	for (const auto& codeArea : other.areas){
+		const Area& area = codeArea.second;
+		if (!filter.keepArea(codeArea.first)){
+			continue;
+		}
+
+		Area copy(codeArea.first);
+		for (const auto& langName : area.getNamesById()){
+			copy.setName(langName.first, langName.second);
+		}
+		for (const auto& codeMeasure : area.getMeasuresById()){
+			const Measure& measure = codeMeasure.second;
+			if (!filter.keepMeasure(codeMeasure.first)){
+				continue;
+			}
+			//the year filter is a range, so if it keeps both ends it keeps everything
+			if (filter.keepYear(measure.getFirstYear()) && filter.keepYear(measure.getLastYear())){
+				copy.setMeasure(codeMeasure.first, measure);
+				continue;
+			}
+			Measure kept(measure.getCodenameId(), measure.getLabelId());
+			for (auto yearValue : measure){
+				if (filter.keepYear(yearValue.first)){
+					kept.setValue(yearValue.first, yearValue.second);
+				}
+			}
+			if (kept.size() > 0){
+				copy.setMeasure(codeMeasure.first, std::move(kept));
+			}
+		}
+
+		if (area.size() > 0 && copy.size() == 0){
+			continue;
+		}
+		setArea(codeArea.first, std::move(copy));
+	}
+}
+
 /*
   TODO: Areas::getArea(localAuthorityCode)
 
@@ -115,18 +331,63 @@ void Areas::setArea(std::string code, Area area){
     ...
     Area area2 = areas.getArea("W06000023");
 */
-Area& Areas::getArea(std::string code) {
-	auto ar = this->areas.find(code);
-	if (ar != this->areas.end()){
-		return ar->second;
-	} else {
-		throw std::out_of_range("No area found matching " + code);
+Area& Areas::getArea(const std::string& code) {
+	return const_cast<Area&>(static_cast<const Areas&>(*this).getArea(code));
+}
+
+//As above, but for a constant Areas instance
+const Area& Areas::getArea(const std::string& code) const {
+	InternId codeId;
+	if (InternTable::global().find(code, codeId)){
+		auto ar = this->areas.find(codeId);
+		if (ar != this->areas.end()){
+			return ar->second;
+		}
 	}
+	throw std::out_of_range("No area found matching " + code);
 }
 
-AreasContainer Areas::getAreas(){
+//Returns the Area objects, keyed by the ID of their local authority code
+const AreasContainer& Areas::getAreas() const noexcept{
 	return this->areas;
 }
+
+/*
+  Areas::getAreasInOrder()
+
+  Retrieve the Area objects in order of their local authority codes, without
+  copying them. Areas are stored by the ID of their code, which is not
+  alphabetical, so this is what output functions should iterate over.
+
+  @return
+    Pointers to the Area objects stored in this instance, valid until this
+    instance is next modified
+
+  @example
+    Areas areas();
+    ...
+    for (const Area* area : areas.getAreasInOrder()) {
+      std::cout << *area;
+    }
+*/
+std::vector<const Area*> Areas::getAreasInOrder() const{
+	InternTable& strings = InternTable::global();
+	std::vector<std::pair<const std::string*, const Area*>> ordered;
+	ordered.reserve(this->areas.size());
+	for (auto it = this->areas.begin(); it != this->areas.end(); it++){
+		ordered.emplace_back(&strings.lookup(it->first), &it->second);
+	}
+	std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+		return *a.first < *b.first;
+	});
+
+	std::vector<const Area*> result;
+	result.reserve(ordered.size());
+	for (auto it = ordered.begin(); it != ordered.end(); it++){
+		result.push_back(it->second);
+	}
+	return result;
+}
 /*
   TODO: Areas::size()
 
@@ -204,32 +465,64 @@ void Areas::populateFromAuthorityCodeCSV(
     std::istream &is,
     const BethYw::SourceColumnMapping &cols,
     const StringFilterSet * const areasFilter) {
-	std::string english = "eng";
-	std::string welsh = "cym";
-
-	std::string line;
-	std::vector<std::string> data;
-	std::getline(is,line);
-
-	while(std::getline(is,line)){
-		int i = 0;
-		std::string areaCode;
-		std::stringstream lineStream(line);
-		while (std::getline(lineStream, line, ',')){
-			if (i == 0) {
-				areaCode = line;
-				Area ar(line);
-				setArea(line,ar);
-			} else if (i == 1){
-				Area& ar = getArea(areaCode);
-				ar.setName(english,line);
-			} else if (i ==2){
-				Area& ar = getArea(areaCode);
-				ar.setName(welsh,line);
-			}
-			i++;
+	std::string contents = readAll(is);
+	populateFromAuthorityCodeCSV(std::string_view(contents), areasFilter);
+}
+
+/*
+  Areas::populateFromAuthorityCodeCSV(buffer, areasFilter, stats)
+
+  As above, but parses the file from a buffer already in memory (e.g. one
+  returned by InputMmapFile::open()) rather than from a stream. There is no
+  cols parameter, as areas.csv always has the same three columns in the same
+  order (the code, then the English and Welsh names).
+
+  @param stats
+    If not nullptr, the rows read, filtered out and kept are added to it
+    (see stats.h)
+
+  @example
+    InputMmapFile input("data/areas.csv");
+
+    Areas data = Areas();
+    areas.populateFromAuthorityCodeCSV(input.open());
+*/
+void Areas::populateFromAuthorityCodeCSV(
+    std::string_view buffer,
+    const StringFilterSet * const areasFilter,
+    BethYw::ImportStats * const stats) {
+	InternTable& strings = InternTable::global();
+	const InternId english = strings.intern("eng");
+	const InternId welsh = strings.intern("cym");
+
+	RecordFilter filter(areasFilter, nullptr, nullptr);
+	CSVReader reader(buffer);
+	std::vector<std::string_view> cells;
+	reader.nextRow(cells);
+
+	size_t rows = 0;
+	size_t kept = 0;
+	while(reader.nextRow(cells)){
+		rows++;
+		if (cells[0].empty() || !filter.keepArea(cells[0])){
+			continue;
+		}
+		kept++;
+		InternId areaCode = strings.intern(cells[0]);
+		Area& newArea = areas.try_emplace(areaCode, areaCode).first->second;
+		if (cells.size() > 1){
+			newArea.setName(english,strings.intern(cells[1]));
+		}
+		if (cells.size() > 2){
+			newArea.setName(welsh,strings.intern(cells[2]));
 		}
 	}
+
+	if (stats != nullptr){
+		stats->recordsParsed += rows;
+		stats->recordsFiltered += rows - kept;
+		stats->recordsMerged += kept;
+	}
 }
 
 /*
@@ -285,6 +578,10 @@ void Areas::populateFromAuthorityCodeCSV(
   them as ints. When retrieving values from the JSON library, you will
   have to cast them to the right type.
 
+  The file is not loaded into a JSON document: the "value" array is streamed
+  through BethYw::parseWelshStatsJSON() (see statswales.h) and each row is
+  filtered and merged as soon as it has been read.
+
   @param is
     The input stream from InputSource
 
@@ -341,65 +638,339 @@ void Areas::populateFromWelshStatsJSON(std::istream &is,
 		const StringFilterSet * const areasFilter,
 		const StringFilterSet * const measuresFilter,
 		const YearFilterTuple * const yearsFilter){
-	//opens json stream
-	json j;
-	is >> j;
-	std::string measureCode;
-	std::string measureLabel;
-	if (cols.count(BethYw::SINGLE_MEASURE_CODE)>0){
-		 measureCode = cols.at(BethYw::MEASURE_CODE);
-		 measureLabel = cols.at(BethYw::MEASURE_NAME);
-	}
-
-		//gets all values from json
-	for (auto& el : j["value"].items()) {
-	   auto &data = el.value();
-	   //gets all needed values from the JSON
-	   std::string localAuthorityCode = data[cols.at(BethYw::AUTH_CODE)];
-	   std::string localAuthorityName = data[cols.at(BethYw::AUTH_NAME_ENG)];
-	   measureCode = data[cols.at(BethYw::MEASURE_CODE)];
-	   measureLabel = data[cols.at(BethYw::MEASURE_NAME)];
-	   std::string year = data[cols.at(BethYw::YEAR)];
-	   int yearInt = stoi(year);
-	   double measureData = data[cols.at(BethYw::VALUE)];
-
-	   //Does not retrieve value if not in filters
-	   if (!areasFilter->empty()){
-		   if(areasFilter->count(localAuthorityCode) <= 0){
-			   continue;
-		   }
-	   }
-
-	   Measure meas(measureCode, measureLabel);
-	   meas.setValue(yearInt, measureData);
-
-	   if (!measuresFilter->empty()){
-		   if(measuresFilter->count(meas.getCodename()) <= 0){
-			   continue;
-		   }
-	   }
-
-	   //retrieves values from the year tuple
-	   int year1 = std::get<0>(*yearsFilter);
-	   int year2 = std::get<1>(*yearsFilter);
-	   if(year1 != 0 && year2 != 0){
-		   if (yearInt < year1 || yearInt > year2){
-			   continue;
-		   }
-	   }
-
-	   //If area doesn't exist creates a new one
-	   auto it = areas.find(localAuthorityCode);
-	   if (it == areas.end()){
-		   Area ar(localAuthorityCode);
-		   setArea(localAuthorityCode,ar);
-	   }
-	   Area& ar = getArea(localAuthorityCode);
-	   ar.setName("eng",localAuthorityName);
-	   ar.setMeasure(measureCode,meas);
+	//streams the value array, so only one record is held at a time
+	RecordFilter filter(areasFilter, measuresFilter, yearsFilter);
+	InternCache strings;
+	BethYw::parseWelshStatsJSON(is, cols,
+			[&](const BethYw::WelshStatsRecord& record) {
+		mergeWelshStatsRecord(record, strings);
+	}, &filter);
+}
+
+/*
+  Areas::populateFromWelshStatsJSON(buffer,
+                                    cols,
+                                    areasFilter,
+                                    measuresFilter,
+                                    yearsFilter)
+
+  As above, but parses the file from a buffer already in memory (e.g. one
+  returned by InputMmapFile::open()) rather than from a stream.
+
+  @param stats
+    If not nullptr, the rows read, filtered out and kept are added to it
+    (see stats.h)
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+    auto cols = InputFiles::DATASETS["popden"].COLS;
+
+    Areas data = Areas();
+    areas.populateFromWelshStatsJSON(input.open(), cols);
+*/
+void Areas::populateFromWelshStatsJSON(std::string_view buffer,
+		const BethYw::SourceColumnMapping &cols,
+		const StringFilterSet * const areasFilter,
+		const StringFilterSet * const measuresFilter,
+		const YearFilterTuple * const yearsFilter,
+		BethYw::ImportStats * const stats){
+	RecordFilter filter(areasFilter, measuresFilter, yearsFilter);
+	size_t rows = 0;
+	size_t kept = 0;
+	InternCache strings;
+	BethYw::parseWelshStatsJSON(buffer, cols,
+			[&](const BethYw::WelshStatsRecord& record) {
+		mergeWelshStatsRecord(record, strings);
+		kept++;
+	}, &filter, &rows);
+
+	if (stats != nullptr){
+		stats->recordsParsed += rows;
+		stats->recordsFiltered += rows - kept;
+		stats->recordsMerged += kept;
+	}
+}
+
+/*
+  Areas::populateFromWelshStatsJSON(buffer,
+                                    cols,
+                                    areasFilter,
+                                    measuresFilter,
+                                    yearsFilter,
+                                    threads)
+
+  As above, but large files are split into ranges of rows (see
+  BethYw::splitWelshStatsJSON()) which are parsed as up to `threads` tasks on
+  BethYw::TaskScheduler::global(), each into its own Areas instance. These
+  are gathered in an AreaParts as each task finishes, and combined in
+  file order, so a value for the same area, measure and year later in the
+  file still replaces an earlier one, as with Measure::setValue().
+
+  Files too small to share out this way, but of at least two
+  PIPELINE_BLOCK_BYTES blocks, are instead imported through a pipeline of
+  read, parse and merge stages if threads is more than 1 (see
+  populateFromWelshStatsPipeline()).
+
+  If the file could not be split cleanly (e.g. a split point fell inside a
+  string), the partial results are discarded and the file is parsed again on
+  the calling thread, which also reports any genuine parsing errors.
+
+  @param threads
+    The maximum number of ranges to split the file into
+
+  @param stats
+    If not nullptr, the rows read, filtered out and kept are added to it
+    (see stats.h)
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+    auto cols = InputFiles::DATASETS["popden"].COLS;
+
+    Areas data = Areas();
+    areas.populateFromWelshStatsJSON(
+      input.open(),
+      cols,
+      &areasFilter,
+      &measuresFilter,
+      &yearsFilter,
+      std::thread::hardware_concurrency());
+*/
+void Areas::populateFromWelshStatsJSON(std::string_view buffer,
+		const BethYw::SourceColumnMapping &cols,
+		const StringFilterSet * const areasFilter,
+		const StringFilterSet * const measuresFilter,
+		const YearFilterTuple * const yearsFilter,
+		unsigned int threads,
+		BethYw::ImportStats * const stats){
+	size_t chunks = std::min<size_t>(threads, buffer.size() / MIN_JSON_CHUNK_BYTES);
+	std::vector<std::string_view> ranges;
+	if (chunks > 1){
+		ranges = BethYw::splitWelshStatsJSON(buffer, chunks);
+	}
+	if (ranges.size() <= 1){
+		//too small to share out, but big enough to overlap the stages of the import
+		if (threads > 1 && populateFromWelshStatsPipeline(buffer, cols,
+				areasFilter, measuresFilter, yearsFilter, stats)){
+			return;
+		}
+		populateFromWelshStatsJSON(buffer, cols, areasFilter, measuresFilter, yearsFilter, stats);
+		return;
+	}
+
+	RecordFilter filter(areasFilter, measuresFilter, yearsFilter);
+	AreaParts combined;
+	std::vector<char> endsArray(ranges.size(), false);
+	std::vector<std::exception_ptr> errors(ranges.size());
+	std::vector<size_t> rows(ranges.size(), 0);
+	std::vector<size_t> kept(ranges.size(), 0);
+	BethYw::TaskGroup group;
+	for (size_t i = 0; i < ranges.size(); i++){
+		group.run([&, i]() {
+			try {
+				Areas shard = Areas();
+				InternCache strings;
+				size_t shardKept = 0;
+				endsArray[i] = BethYw::parseWelshStatsRecords(ranges[i], cols,
+						[&](const BethYw::WelshStatsRecord& record) {
+					shard.mergeWelshStatsRecord(record, strings);
+					shardKept++;
+				}, &filter, &rows[i]);
+				kept[i] = shardKept;
+				combined.merge(std::move(shard), i);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+		});
+	}
+	group.wait();
+
+	//only the last range may contain the end of the value array
+	bool clean = endsArray.back();
+	for (size_t i = 0; i < ranges.size(); i++){
+		if (errors[i] || (endsArray[i] && i + 1 < ranges.size())){
+			clean = false;
+		}
+	}
+	if (!clean){
+		populateFromWelshStatsJSON(buffer, cols, areasFilter, measuresFilter, yearsFilter, stats);
+		return;
+	}
+
+	combined.moveInto(*this, threads);
+
+	if (stats != nullptr){
+		for (size_t i = 0; i < ranges.size(); i++){
+			stats->recordsParsed += rows[i];
+			stats->recordsFiltered += rows[i] - kept[i];
+			stats->recordsMerged += kept[i];
+		}
 	}
 }
 
+/*
+  Areas::populateFromWelshStatsPipeline(buffer,
+                                        cols,
+                                        areasFilter,
+                                        measuresFilter,
+                                        yearsFilter,
+                                        stats)
+
+  Import a StatsWales JSON file in blocks of PIPELINE_BLOCK_BYTES through a
+  pipeline of three stages (see pipeline.h), which run as tasks on
+  BethYw::TaskScheduler::global() and overlap with each other:
+
+    read     loads the pages of the next few blocks
+    parse    turns a block into a batch of the records that pass the filters
+    merge    merges the records into a new Areas instance, in file order
+
+  which is then merged into this one, so the result is the same as parsing
+  the file in one go.
+
+  @param stats
+    If not nullptr, the rows read, filtered out and kept are added to it
+
+  @return
+    True if the file was imported. False, with nothing changed, if it has
+    fewer than two blocks, could not be split into blocks of whole rows or
+    failed to parse; it should then be parsed in one go, which also reports
+    any genuine parsing errors.
+*/
+bool Areas::populateFromWelshStatsPipeline(std::string_view buffer,
+		const BethYw::SourceColumnMapping &cols,
+		const StringFilterSet * const areasFilter,
+		const StringFilterSet * const measuresFilter,
+		const YearFilterTuple * const yearsFilter,
+		BethYw::ImportStats * const stats){
+	std::vector<std::string_view> blocks;
+	if (buffer.size() / PIPELINE_BLOCK_BYTES > 1){
+		blocks = BethYw::splitWelshStatsJSON(buffer, buffer.size() / PIPELINE_BLOCK_BYTES);
+	}
+	if (blocks.size() <= 1){
+		return false;
+	}
+
+	struct Batch {
+		std::vector<BethYw::WelshStatsRecord> records;
+		size_t rows = 0;
+		bool endsArray = false;
+	};
+
+	RecordFilter filter(areasFilter, measuresFilter, yearsFilter);
+	BethYw::BoundedQueue<std::string_view> readBlocks(PIPELINE_QUEUE_CAPACITY);
+	BethYw::BoundedQueue<Batch> parsedBatches(PIPELINE_QUEUE_CAPACITY);
+	Areas merged = Areas();
+	//only the merge stage uses it, and it runs one task at a time
+	InternCache strings;
+	size_t nextBlock = 0;
+	size_t mergedBlocks = 0;
+	size_t rows = 0;
+	size_t kept = 0;
+	bool clean = true;
+
+	//each stage wakes the next when it adds to their queue, and the one
+	//before when it makes room in its own
+	std::unique_ptr<BethYw::PipelineStage> read, parse, merge;
+	BethYw::TaskGroup group;
+	read = std::make_unique<BethYw::PipelineStage>(group, [&]() {
+		while (nextBlock < blocks.size() && !readBlocks.full()){
+			touchPages(blocks[nextBlock]);
+			readBlocks.tryPush(blocks[nextBlock]);
+			nextBlock++;
+			parse->wake();
+		}
+		if (nextBlock == blocks.size()){
+			readBlocks.close();
+			parse->wake();
+		}
+	});
+	parse = std::make_unique<BethYw::PipelineStage>(group, [&]() {
+		std::string_view block;
+		while (!parsedBatches.full() && readBlocks.tryPop(block)){
+			read->wake();
+			//the parser applies the filters, so only the kept records are copied
+			Batch batch;
+			batch.endsArray = BethYw::parseWelshStatsRecords(block, cols,
+					[&](const BethYw::WelshStatsRecord& record) {
+				batch.records.push_back(record);
+			}, &filter, &batch.rows);
+			parsedBatches.tryPush(batch);
+			merge->wake();
+		}
+		if (readBlocks.isDrained()){
+			parsedBatches.close();
+			merge->wake();
+		}
+	});
+	merge = std::make_unique<BethYw::PipelineStage>(group, [&]() {
+		Batch batch;
+		while (parsedBatches.tryPop(batch)){
+			parse->wake();
+			for (const BethYw::WelshStatsRecord& record : batch.records){
+				merged.mergeWelshStatsRecord(record, strings);
+			}
+			rows += batch.rows;
+			kept += batch.records.size();
+
+			//only the last block may contain the end of the value array
+			mergedBlocks++;
+			if (batch.endsArray != (mergedBlocks == blocks.size())){
+				clean = false;
+			}
+		}
+	});
+
+	read->wake();
+	try {
+		group.wait();
+	} catch (...) {
+		return false;
+	}
+	if (!clean || mergedBlocks != blocks.size()){
+		return false;
+	}
+
+	this->merge(std::move(merged));
+	if (stats != nullptr){
+		stats->recordsParsed += rows;
+		stats->recordsFiltered += rows - kept;
+		stats->recordsMerged += kept;
+	}
+	return true;
+}
+
+/*
+  Areas::mergeWelshStatsRecord(record, strings)
+
+  Merge the value from a single row read from a StatsWales JSON file into the
+  matching Area and Measure, creating them if they do not exist yet. Later
+  rows replace values from earlier rows for the same year. The filters have
+  already been applied by the parser.
+
+  @param record
+    A row from the "value" array, see statswales.h
+
+  @param strings
+    The cache of interned strings for the parse the row came from, so that
+    each distinct code, name and label only goes to the global table once
+
+  @return
+    void
+*/
+void Areas::mergeWelshStatsRecord(const BethYw::WelshStatsRecord& record,
+		InternCache& strings){
+	static const InternId english = InternTable::global().intern("eng");
+	InternId measureCode = strings.internLower(record.measureCode);
+
+	//If area doesn't exist creates a new one
+	InternId areaCode = strings.intern(record.authCode);
+	Area& ar = areas.try_emplace(areaCode, areaCode).first->second;
+	if (!record.authNameEng.empty()){
+		ar.setName(english,strings.intern(record.authNameEng));
+	}
+	ar.getMeasure(measureCode, strings.intern(record.measureLabel))
+			.setValue(record.year, record.value);
+}
+
 
 /*
   TODO: Areas::populateFromAuthorityByYearCSV(is,
@@ -414,7 +985,8 @@ void Areas::populateFromWelshStatsJSON(std::istream &is,
 
   Note that these files do not include the names for areas, instead you
   have to rely on the names already populated through 
-  Areas::populateFromAuthorityCodeCSV();
+  Areas::populateFromAuthorityCodeCSV(); Areas that have not been populated
+  yet are created without names.
 
   The datasets that will be parsed by this function are
    - complete-popu1009-area.csv
@@ -441,6 +1013,10 @@ void Areas::populateFromWelshStatsJSON(std::istream &is,
     where if both values are 0, then all years should be imported, otherwise
     they should be treated as a the range of years to be imported
 
+  The filters are checked against the raw cells before anything is converted
+  or interned, and filtered year columns are skipped without being parsed.
+  An Area is only created once a value has been kept for it.
+
   @return
     void
 
@@ -473,62 +1049,114 @@ void Areas::populateFromAuthorityByYearCSV(
 		  const StringFilterSet * const areasFilter,
 		  const StringFilterSet * const measuresFilter,
 		  const YearFilterTuple * yearFilter){
+	std::string contents = readAll(is);
+	populateFromAuthorityByYearCSV(std::string_view(contents), cols,
+			areasFilter, measuresFilter, yearFilter);
+}
+
+/*
+  Areas::populateFromAuthorityByYearCSV(buffer,
+                                        cols,
+                                        areasFilter,
+                                        measuresFilter,
+                                        yearFilter,
+                                        stats)
+
+  As above, but parses the file from a buffer already in memory (e.g. one
+  returned by InputMmapFile::open()) rather than from a stream.
+
+  @param stats
+    If not nullptr, the rows read and filtered out, and the values kept, are
+    added to it (see stats.h)
+
+  @example
+    InputMmapFile input("data/complete-popu1009-pop.csv");
+    auto cols = InputFiles::DATASETS["complete-pop"].COLS;
+
+    Areas data = Areas();
+    areas.populateFromAuthorityByYearCSV(input.open(), cols);
+*/
+void Areas::populateFromAuthorityByYearCSV(
+		  std::string_view buffer,
+		  const BethYw::SourceColumnMapping& cols,
+		  const StringFilterSet * const areasFilter,
+		  const StringFilterSet * const measuresFilter,
+		  const YearFilterTuple * yearFilter,
+		  BethYw::ImportStats * const stats){
 	if (cols.count(BethYw::SINGLE_MEASURE_CODE) <= 0 || cols.count(BethYw::SINGLE_MEASURE_NAME) <= 0){
 		throw std::out_of_range("there are not enough columns in cols");
 	}
 
+	RecordFilter filter(areasFilter, measuresFilter, yearFilter);
+	if (!filter.keepMeasure(cols.at(BethYw::SINGLE_MEASURE_CODE))){
+		return;
+	}
+
 	//Get values for assigning to measure
-	std::string line;
-	std::string measureCode = cols.at(BethYw::SINGLE_MEASURE_CODE);
-	std::string measureName = cols.at(BethYw::SINGLE_MEASURE_NAME);
+	InternTable& strings = InternTable::global();
+	InternId measureId = strings.internLower(cols.at(BethYw::SINGLE_MEASURE_CODE));
+	InternId measureName = strings.intern(cols.at(BethYw::SINGLE_MEASURE_NAME));
 	std::vector<int> yearsColumns;
+	std::vector<char> keepColumns;
 
-	if (!measuresFilter->empty()){
-		if (measuresFilter->count(measureCode) <= 0){
-			return;
+	//populate years map from the header
+	CSVReader reader(buffer);
+	std::vector<std::string_view> cells;
+	if (!reader.nextRow(cells)){
+		return;
+	}
+	for (size_t i = 1; i < cells.size(); i++){
+		int year;
+		if (!CSVReader::toInt(cells[i], year) || !Measure::isValidYear(year)){
+			throw std::runtime_error(
+					"Areas::populateFromAuthorityByYearCSV: Invalid year " + std::string(cells[i]));
 		}
+		yearsColumns.push_back(year);
+		keepColumns.push_back(filter.keepYear(year));
 	}
 
 	//iterate over lines
-	while(std::getline(is,line)){
-		int i = 0;
-		std::string areaCode;
-		std::stringstream lineStream(line);
-		Measure meas(measureCode,measureName);
-		bool addCurrentArea;
-
-		//populate years map
-		if (yearsColumns.empty()){
-			while (std::getline(lineStream, line, ',')){
-				if (i != 0){
-					yearsColumns.push_back(stoi(line));
-				}
-				i++;
-			}
+	size_t rows = 0;
+	size_t keptRows = 0;
+	size_t values = 0;
+	while(reader.nextRow(cells)){
+		rows++;
+		if (cells[0].empty() || !filter.keepArea(cells[0])){
+			continue;
 		}
-		//insert value for each year to measure
-		while (std::getline(lineStream, line, ',')){
-			if (i == 0){
-				if (!areasFilter->empty()){
-					if(areasFilter->count(line) <= 0){
-						addCurrentArea = false;
-						break;
-					}
-				}
-				areaCode = line;
-				addCurrentArea = true;
-			} else {
-				meas.setValue(yearsColumns.at(i-1),stod(line));
-			}
-			i++;
+		if (cells.size() - 1 > yearsColumns.size()){
+			throw std::runtime_error(
+					"Areas::populateFromAuthorityByYearCSV: Too many values for " + std::string(cells[0]));
 		}
 
-		//only add after measure has been fully populated to save computation
-		if (addCurrentArea){
-			Area& ar = getArea(areaCode);
-			ar.setMeasure(measureCode,meas);
+		//the area and measure are only created once a value has been kept
+		Measure* meas = nullptr;
+		for (size_t i = 1; i < cells.size(); i++){
+			if (cells[i].empty() || !keepColumns[i - 1]){
+				continue;
+			}
+			double value;
+			if (!CSVReader::toDouble(cells[i], value)){
+				throw std::runtime_error(
+						"Areas::populateFromAuthorityByYearCSV: Invalid value " + std::string(cells[i]));
+			}
+			if (meas == nullptr){
+				//If area doesn't exist creates a new one
+				InternId areaCode = strings.intern(cells[0]);
+				Area& ar = areas.try_emplace(areaCode, areaCode).first->second;
+				meas = &ar.getMeasure(measureId, measureName);
+				keptRows++;
+			}
+			meas->setValue(yearsColumns[i - 1],value);
+			values++;
 		}
 	}
+
+	if (stats != nullptr){
+		stats->recordsParsed += rows;
+		stats->recordsFiltered += rows - keptRows;
+		stats->recordsMerged += values;
+	}
 }
 /*
   TODO: Areas::populate(is, type, cols)
@@ -593,6 +1221,32 @@ void Areas::populate(std::istream &is,
   }
 }
 
+/*
+  Areas::populate(buffer, type, cols)
+
+  As above, but parses data from a buffer already in memory (e.g. one
+  returned by InputMmapFile::open()) rather than from a stream.
+
+  @example
+    InputMmapFile input("data/areas.csv");
+
+    Areas data = Areas();
+    areas.populate(
+      input.open(),
+      DataType::AuthorityCodeCSV,
+      InputFiles::AREAS.COLS);
+*/
+void Areas::populate(std::string_view buffer,
+                     const BethYw::SourceDataType &type,
+                     const BethYw::SourceColumnMapping &cols) {
+  if (type == BethYw::AuthorityCodeCSV) {
+    populateFromAuthorityCodeCSV(buffer);
+  }
+  else {
+    throw std::runtime_error("Areas::populate: Unexpected data type");
+  }
+}
+
 /*
   TODO: Areas::populate(is,
                         type,
@@ -694,6 +1348,199 @@ void Areas::populate(
   }
 }
 
+/*
+  Areas::populate(buffer,
+                  type,
+                  cols,
+                  areasFilter,
+                  measuresFilter,
+                  yearsFilter)
+
+  As above, but parses data from a buffer already in memory (e.g. one
+  returned by InputMmapFile::open()) rather than from a stream, so the
+  parsers read the file contents directly. If stats is not nullptr, the
+  records read, filtered out and merged are added to it (see stats.h).
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+
+    Areas data = Areas();
+    areas.populate(
+      input.open(),
+      DataType::WelshStatsJSON,
+      InputFiles::DATASETS["popden"].COLS,
+      &areasFilter,
+      &measuresFilter,
+      &yearsFilter);
+*/
+void Areas::populate(
+    std::string_view buffer,
+    const BethYw::SourceDataType &type,
+    const BethYw::SourceColumnMapping &cols,
+    const StringFilterSet * const areasFilter,
+    const StringFilterSet * const measuresFilter,
+    const YearFilterTuple * const yearsFilter,
+    BethYw::ImportStats * const stats) {
+  if (type == BethYw::AuthorityCodeCSV) {
+    populateFromAuthorityCodeCSV(buffer, areasFilter, stats);
+  } else if (type == BethYw::AuthorityByYearCSV){
+	  populateFromAuthorityByYearCSV(buffer, cols, areasFilter, measuresFilter,yearsFilter, stats);
+  } else if (type == BethYw::WelshStatsJSON){
+	  populateFromWelshStatsJSON(buffer, cols, areasFilter, measuresFilter,yearsFilter, stats);
+  } else {
+    throw std::runtime_error("Areas::populate: Unexpected data type");
+  }
+}
+
+/*
+  Areas::populate(buffer,
+                  type,
+                  cols,
+                  areasFilter,
+                  measuresFilter,
+                  yearsFilter,
+                  threads)
+
+  As above, but large StatsWales JSON files may be parsed on up to `threads`
+  threads. Other types are parsed on the calling thread.
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+
+    Areas data = Areas();
+    areas.populate(
+      input.open(),
+      DataType::WelshStatsJSON,
+      InputFiles::DATASETS["popden"].COLS,
+      &areasFilter,
+      &measuresFilter,
+      &yearsFilter,
+      8);
+*/
+void Areas::populate(
+    std::string_view buffer,
+    const BethYw::SourceDataType &type,
+    const BethYw::SourceColumnMapping &cols,
+    const StringFilterSet * const areasFilter,
+    const StringFilterSet * const measuresFilter,
+    const YearFilterTuple * const yearsFilter,
+    unsigned int threads,
+    BethYw::ImportStats * const stats) {
+  if (type == BethYw::WelshStatsJSON){
+	  populateFromWelshStatsJSON(buffer, cols, areasFilter, measuresFilter,yearsFilter,threads,stats);
+  } else {
+	  populate(buffer, type, cols, areasFilter, measuresFilter, yearsFilter, stats);
+  }
+}
+
+/*
+  Areas::populateFromIndex(buffer,
+                           index,
+                           type,
+                           cols,
+                           areasFilter,
+                           measuresFilter,
+                           yearsFilter,
+                           threads,
+                           stats)
+
+  As populate(), but if the areas and measures filters only keep a small
+  part of the file, the sidecar index of the file (see index.h) is used to
+  read just the records for them. Rows of a StatsWales export are parsed
+  straight from the buffer, range by range; the selected lines of a CSV file
+  are copied after its header line and parsed as a file of their own. The
+  filters still apply to every record read, so the result is the same as
+  reading the whole file, which is what happens if the filters are wide.
+
+  Records outside the selected ranges are not read at all, so errors in
+  them are not reported.
+
+  @param index
+    The index of the file in buffer, e.g. from BethYw::loadDatasetIndex()
+
+  @param threads
+    The maximum number of threads to use if the whole file is read
+
+  @param stats
+    If not nullptr, the records read, filtered out and merged are added to
+    it as for populate(), and bytesRead is set to the bytes actually read
+
+  @throws
+    std::runtime_error if a parsing error occurs, or the index is for a file
+    of a different size
+    std::out_of_range if there are not enough columns in cols
+
+  @example
+    InputMmapFile input("datasets/complete-popu1009-pop.csv");
+    auto source = BethYw::InputFiles::COMPLETE_POP;
+    auto index = BethYw::loadDatasetIndex("datasets/complete-popu1009-pop.csv",
+        input.open(), source);
+
+    Areas data = Areas();
+    areas.populateFromIndex(input.open(), *index, source.PARSER, source.COLS,
+        &areasFilter, &measuresFilter, &yearsFilter);
+*/
+void Areas::populateFromIndex(
+    std::string_view buffer,
+    const BethYw::DatasetIndex& index,
+    const BethYw::SourceDataType &type,
+    const BethYw::SourceColumnMapping &cols,
+    const StringFilterSet * const areasFilter,
+    const StringFilterSet * const measuresFilter,
+    const YearFilterTuple * const yearsFilter,
+    unsigned int threads,
+    BethYw::ImportStats * const stats) {
+	if (index.getFileSize() != buffer.size()){
+		throw std::runtime_error("Areas::populateFromIndex: The index is for another file");
+	}
+
+	RecordFilter filter(areasFilter, measuresFilter, yearsFilter);
+	std::vector<BethYw::ByteRange> ranges;
+	if (!index.select(filter, ranges)){
+		populate(buffer, type, cols, areasFilter, measuresFilter, yearsFilter, threads, stats);
+		return;
+	}
+
+	if (type != BethYw::WelshStatsJSON){
+		std::string selected(buffer.substr(0, index.getHeaderSize()));
+		for (const BethYw::ByteRange& range : ranges){
+			selected += buffer.substr(range.first, range.second - range.first);
+			//the last line of a file may not end with a line break
+			if (selected.back() != '\n'){
+				selected += '\n';
+			}
+		}
+		populate(selected, type, cols, areasFilter, measuresFilter, yearsFilter, stats);
+		if (stats != nullptr){
+			stats->bytesRead = selected.size();
+		}
+		return;
+	}
+
+	size_t rows = 0;
+	size_t kept = 0;
+	size_t bytes = 0;
+	InternCache strings;
+	for (const BethYw::ByteRange& range : ranges){
+		size_t rangeRows = 0;
+		BethYw::parseWelshStatsRecords(
+				buffer.substr(range.first, range.second - range.first), cols,
+				[&](const BethYw::WelshStatsRecord& record) {
+			mergeWelshStatsRecord(record, strings);
+			kept++;
+		}, &filter, &rangeRows);
+		rows += rangeRows;
+		bytes += range.second - range.first;
+	}
+
+	if (stats != nullptr){
+		stats->bytesRead = bytes;
+		stats->recordsParsed += rows;
+		stats->recordsFiltered += rows - kept;
+		stats->recordsMerged += kept;
+	}
+}
+
 /*
   TODO: Areas::toJSON()
 
@@ -750,6 +1597,9 @@ void Areas::populate(
 
   An empty JSON is "{}" (without the quotes), which you must return if your
   Areas object is empty.
+
+  Rather than building a JSON document and dumping it, the text is written
+  straight into a string by writeJSON() below.
   
   @return
     std::string of JSON
@@ -768,9 +1618,175 @@ void Areas::populate(
     std::cout << data.toJSON();
 */
 std::string Areas::toJSON() const {
-  json j;
-  
-  return j.dump();
+	JSONWriter writer;
+	writeJSON(writer);
+	return writer.str();
+}
+
+/*
+  Areas::writeJSON(os)
+
+  Write this Areas object as JSON to a stream, in the same format as
+  toJSON(), without holding the whole text in memory. Areas, measures,
+  names and years are written in sorted order as the output is produced.
+
+  @param os
+    The stream to write to
+
+  @return
+    void
+
+  @example
+    Areas data = Areas();
+    ...
+    data.writeJSON(std::cout);
+*/
+void Areas::writeJSON(std::ostream& os) const {
+	JSONWriter writer(os);
+	writeJSON(writer);
+}
+
+/*
+  Areas::writeJSON(os, threads)
+
+  As above, but large outputs are split into up to `threads` blocks of
+  areas, which are formatted as tasks on BethYw::TaskScheduler::global() and
+  then written in order. The output is the same.
+
+  @param os
+    The stream to write to
+
+  @param threads
+    The most blocks to format at once
+
+  @return
+    void
+
+  @example
+    data.writeJSON(std::cout, 4);
+*/
+void Areas::writeJSON(std::ostream& os, unsigned int threads) const {
+	std::vector<const Area*> inOrder = getAreasInOrder();
+	size_t blocks = std::min<size_t>(threads, inOrder.size() / MIN_FORMAT_AREAS);
+	if (blocks <= 1){
+		JSONWriter writer(os);
+		writeJSON(writer, inOrder.data(), inOrder.data() + inOrder.size());
+		return;
+	}
+
+	//each block is a whole object, so its braces are dropped when joined
+	std::vector<std::string> text = formatBlocks(inOrder, blocks,
+			[](const Area* const* first, const Area* const* last, std::string& text) {
+		JSONWriter writer;
+		writeJSON(writer, first, last);
+		text = writer.str();
+	});
+	os.put('{');
+	for (size_t i = 0; i < text.size(); i++){
+		if (i > 0){
+			os.put(',');
+		}
+		os.write(text[i].data() + 1, text[i].size() - 2);
+	}
+	os.put('}');
+}
+
+//Writes every Area to writer as one JSON object
+void Areas::writeJSON(JSONWriter& writer) const {
+	std::vector<const Area*> inOrder = getAreasInOrder();
+	writeJSON(writer, inOrder.data(), inOrder.data() + inOrder.size());
+}
+
+//Writes the Areas from first up to last to writer as one JSON object
+void Areas::writeJSON(JSONWriter& writer,
+		const Area* const* first,
+		const Area* const* last) {
+	InternTable& strings = InternTable::global();
+	std::vector<std::pair<const std::string*, const std::string*>> names;
+
+	writer.beginObject();
+	for (const Area* const* it = first; it != last; it++){
+		const Area* area = *it;
+		writer.key(area->getLocalAuthorityCode());
+		writer.beginObject();
+
+		//empty "measures" and "names" objects are left out altogether
+		if (area->size() > 0){
+			writer.key("measures");
+			writer.beginObject();
+			for (const Measure* measure : area->getMeasuresInOrder()){
+				writer.key(measure->getCodename());
+				writer.beginObject();
+				for (auto yearValue : *measure){
+					writer.key(yearValue.first);
+					writer.value(yearValue.second);
+				}
+				writer.endObject();
+			}
+			writer.endObject();
+		}
+
+		//names are stored by language ID, so sort them by language code
+		names.clear();
+		for (const auto& langName : area->getNamesById()){
+			names.emplace_back(&strings.lookup(langName.first), &strings.lookup(langName.second));
+		}
+		std::sort(names.begin(), names.end(), [](const auto& a, const auto& b) {
+			return *a.first < *b.first;
+		});
+		if (!names.empty()){
+			writer.key("names");
+			writer.beginObject();
+			for (const auto& langName : names){
+				writer.key(*langName.first);
+				writer.value(*langName.second);
+			}
+			writer.endObject();
+		}
+
+		writer.endObject();
+	}
+	writer.endObject();
+}
+
+/*
+  Areas::toFactTable()
+
+  Copy all the values in this Areas instance into a columnar FactTable, for
+  scans and aggregates across areas. The table is a snapshot, so build a new
+  one after populating or modifying this instance.
+
+  @return
+    A FactTable holding every value
+
+  @example
+    Areas areas();
+    areas.populate(...);
+    FactTable table = areas.toFactTable();
+    double average = table.average("pop", 2015);
+*/
+FactTable Areas::toFactTable() const {
+	return FactTable(this->areas);
+}
+
+/*
+  Areas::toSeriesBatch()
+
+  Copy every measure of every area in this Areas instance into a SeriesBatch,
+  to calculate statistics for all of them at once. The batch is a snapshot,
+  so build a new one after populating or modifying this instance.
+
+  @return
+    A SeriesBatch with one series for each measure of each area
+
+  @example
+    Areas areas();
+    areas.populate(...);
+    SeriesBatch batch = areas.toSeriesBatch();
+    SeriesSummary summary = batch.summarise();
+*/
+SeriesBatch Areas::toSeriesBatch() const {
+	return SeriesBatch(this->areas);
 }
 
 /*
@@ -879,11 +1895,52 @@ std::string Areas::toJSON() const {
     Areas areas();
     std::cout << areas << std::end;
 */
-std::ostream& operator<<(std::ostream& os, Areas ars){
-	std::map<std::string,Area> areasToPrint = ars.getAreas();
-	for (auto it = areasToPrint.begin(); it != areasToPrint.end();it++){
-		os << it->second;
-	}
+std::ostream& operator<<(std::ostream& os, const Areas& ars){
+	TableWriter writer(os);
+	writer.write(ars);
 	return os;
 }
 
+/*
+  Areas::writeTables(os, threads)
+
+  Write the same tables as operator<<, but with large outputs split into up
+  to `threads` blocks of areas, which are formatted as tasks on
+  BethYw::TaskScheduler::global() and then written in order.
+
+  @param os
+    The stream to write to
+
+  @param threads
+    The most blocks to format at once
+
+  @return
+    void
+
+  @example
+    data.writeTables(std::cout, 4);
+*/
+void Areas::writeTables(std::ostream& os, unsigned int threads) const {
+	std::vector<const Area*> inOrder = getAreasInOrder();
+	size_t blocks = std::min<size_t>(threads, inOrder.size() / MIN_FORMAT_AREAS);
+	if (blocks <= 1){
+		os << *this;
+		return;
+	}
+
+	std::vector<std::string> text = formatBlocks(inOrder, blocks,
+			[](const Area* const* first, const Area* const* last, std::string& text) {
+		std::ostringstream block;
+		{
+			TableWriter writer(block);
+			for (const Area* const* it = first; it != last; it++){
+				writer.write(**it);
+			}
+		}
+		text = block.str();
+	});
+	for (const std::string& block : text){
+		os.write(block.data(), block.size());
+	}
+}
+
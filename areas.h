@@ -28,31 +28,34 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_set>
+#include <vector>
 
 
 #include "datasets.h"
 #include "area.h"
+#include "filter.h"
+#include "stats.h"
+#include "statswales.h"
 
-/*
-  An alias for filters based on strings such as categorisations e.g. area,
-  and measures.
-*/
-using StringFilterSet = std::unordered_set<std::string>;
+class FactTable;
+class SeriesBatch;
+class JSONWriter;
 
-/*
-  An alias for a year filter.
-*/
-using YearFilterTuple = std::tuple<unsigned int, unsigned int>;
+namespace BethYw {
+class DatasetIndex;
+}
 
 /*
-  An alias for the data within an Areas object stores Area objects.
+  An alias for the data within an Areas object stores Area objects, keyed by
+  the ID of their local authority code in InternTable::global().
 
   TODO: you should remove the declaration of the Null class below, and set
   AreasContainer to a valid Standard Library container of your choosing.
 */
-using AreasContainer = std::map<std::string,Area>;
+using AreasContainer = std::map<InternId,Area>;
 
 /*
   Areas is a class that stores all the data categorised by area. The 
@@ -71,6 +74,19 @@ using AreasContainer = std::map<std::string,Area>;
 class Areas {
 private:
 	AreasContainer areas;
+
+	void mergeWelshStatsRecord(const BethYw::WelshStatsRecord& record,
+	                           InternCache& strings);
+	bool populateFromWelshStatsPipeline(std::string_view buffer,
+	                                    const BethYw::SourceColumnMapping &cols,
+	                                    const StringFilterSet * const areasFilter,
+	                                    const StringFilterSet * const measuresFilter,
+	                                    const YearFilterTuple * const yearsFilter,
+	                                    BethYw::ImportStats * const stats);
+	void writeJSON(JSONWriter& writer) const;
+	static void writeJSON(JSONWriter& writer,
+	                      const Area* const* first,
+	                      const Area* const* last);
 public:
   Areas();
   
@@ -80,6 +96,12 @@ public:
       const StringFilterSet * const areas = nullptr)
       noexcept(false);
 
+  void populateFromAuthorityCodeCSV(
+      std::string_view buffer,
+      const StringFilterSet * const areas = nullptr,
+      BethYw::ImportStats * const stats = nullptr)
+      noexcept(false);
+
   void populateFromAuthorityByYearCSV(
 		  std:: istream& is,
 		  const BethYw::SourceColumnMapping& cols,
@@ -87,11 +109,26 @@ public:
 		  const StringFilterSet * const measuresFilter = nullptr,
 		  const YearFilterTuple * yearFilter = nullptr)
   	  	  noexcept(false);
+
+  void populateFromAuthorityByYearCSV(
+		  std::string_view buffer,
+		  const BethYw::SourceColumnMapping& cols,
+		  const StringFilterSet * const areasFilter = nullptr,
+		  const StringFilterSet * const measuresFilter = nullptr,
+		  const YearFilterTuple * yearFilter = nullptr,
+		  BethYw::ImportStats * const stats = nullptr)
+  	  	  noexcept(false);
+
   void populate(
       std::istream& is,
       const BethYw::SourceDataType& type,
       const BethYw::SourceColumnMapping& cols) noexcept(false);
 
+  void populate(
+      std::string_view buffer,
+      const BethYw::SourceDataType& type,
+      const BethYw::SourceColumnMapping& cols) noexcept(false);
+
   void populate(
       std::istream& is,
       const BethYw::SourceDataType& type,
@@ -101,18 +138,79 @@ public:
       const YearFilterTuple * const yearsFilter)
       noexcept(false);
 
+  void populate(
+      std::string_view buffer,
+      const BethYw::SourceDataType& type,
+      const BethYw::SourceColumnMapping& cols,
+      const StringFilterSet * const areasFilter,
+      const StringFilterSet * const measuresFilter,
+      const YearFilterTuple * const yearsFilter,
+      BethYw::ImportStats * const stats = nullptr)
+      noexcept(false);
+
+  void populate(
+      std::string_view buffer,
+      const BethYw::SourceDataType& type,
+      const BethYw::SourceColumnMapping& cols,
+      const StringFilterSet * const areasFilter,
+      const StringFilterSet * const measuresFilter,
+      const YearFilterTuple * const yearsFilter,
+      unsigned int threads,
+      BethYw::ImportStats * const stats = nullptr)
+      noexcept(false);
+
+  void populateFromIndex(
+      std::string_view buffer,
+      const BethYw::DatasetIndex& index,
+      const BethYw::SourceDataType& type,
+      const BethYw::SourceColumnMapping& cols,
+      const StringFilterSet * const areasFilter,
+      const StringFilterSet * const measuresFilter,
+      const YearFilterTuple * const yearsFilter,
+      unsigned int threads = 1,
+      BethYw::ImportStats * const stats = nullptr)
+      noexcept(false);
+
   void populateFromWelshStatsJSON(std::istream &is,
 		  const BethYw::SourceColumnMapping &cols,
 		  const StringFilterSet * const areasFilter = nullptr,
 		  const StringFilterSet * const measuresFilter = nullptr,
 		  const YearFilterTuple * const yearsFilter = nullptr)
   	  	  noexcept(false);
+
+  void populateFromWelshStatsJSON(std::string_view buffer,
+		  const BethYw::SourceColumnMapping &cols,
+		  const StringFilterSet * const areasFilter = nullptr,
+		  const StringFilterSet * const measuresFilter = nullptr,
+		  const YearFilterTuple * const yearsFilter = nullptr,
+		  BethYw::ImportStats * const stats = nullptr)
+  	  	  noexcept(false);
+
+  void populateFromWelshStatsJSON(std::string_view buffer,
+		  const BethYw::SourceColumnMapping &cols,
+		  const StringFilterSet * const areasFilter,
+		  const StringFilterSet * const measuresFilter,
+		  const YearFilterTuple * const yearsFilter,
+		  unsigned int threads,
+		  BethYw::ImportStats * const stats = nullptr)
+  	  	  noexcept(false);
   std::string toJSON() const;
+  void writeJSON(std::ostream& os) const;
+  void writeJSON(std::ostream& os, unsigned int threads) const;
+  void writeTables(std::ostream& os, unsigned int threads) const;
+  FactTable toFactTable() const;
+  SeriesBatch toSeriesBatch() const;
 
   void setArea(std::string code, Area area);
-  Area& getArea(std::string localAuthorityCode);
-  AreasContainer getAreas();
+  void setArea(InternId code, Area area);
+  void merge(Areas&& other);
+  AreasContainer takeAreas() noexcept;
+  void merge(const Areas& other, const RecordFilter& filter);
+  Area& getArea(const std::string& localAuthorityCode);
+  const Area& getArea(const std::string& localAuthorityCode) const;
+  const AreasContainer& getAreas() const noexcept;
+  std::vector<const Area*> getAreasInOrder() const;
   const int size() const noexcept;
 };
-std::ostream& operator<<(std::ostream& os, Areas ars);
+std::ostream& operator<<(std::ostream& os, const Areas& ars);
 #endif // AREAS_H
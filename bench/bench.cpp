@@ -0,0 +1,135 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the benchmark harness. The global operator new and
+  operator delete are replaced so that every heap allocation made anywhere
+  in the program (including inside the Standard Library) is counted. The
+  timing loop itself is Bench::run() in bench.h.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "bench.h"
+
+namespace {
+
+std::atomic<size_t> allocationCount(0);
+
+//Set from the command line, see main.cpp
+std::string nameFilter;
+unsigned int repetitionCount = 5;
+
+} // namespace
+
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = std::malloc(size == 0 ? 1 : size);
+	if (ptr == nullptr){
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+//Returns the number of heap allocations made so far
+size_t Bench::allocations() noexcept {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+/*
+  Bench::setFilter(filter)
+
+  Only run the benchmarks whose names contain filter, e.g. "populate" or
+  "Measure::". An empty filter runs every benchmark.
+
+  @param filter
+    The text to look for in each benchmark's name
+*/
+void Bench::setFilter(const std::string& filter) {
+	nameFilter = filter;
+}
+
+/*
+  Bench::setRepetitions(repetitions)
+
+  Set how many times each benchmark is timed. More repetitions give a more
+  reliable median, at the cost of a longer run.
+
+  @param repetitions
+    The number of repetitions, at least 1
+*/
+void Bench::setRepetitions(unsigned int repetitions) {
+	repetitionCount = repetitions > 0 ? repetitions : 1;
+}
+
+//Returns the number of times each benchmark is timed
+unsigned int Bench::repetitions() noexcept {
+	return repetitionCount;
+}
+
+//Returns whether a benchmark matches the filter, and so should be run
+bool Bench::selected(const std::string& name) {
+	return name.find(nameFilter) != std::string::npos;
+}
+
+/*
+  Bench::report(name, nsPerOp, allocationsPerOp, bytesPerOp)
+
+  Print one line for a benchmark: the median time per operation, the spread
+  of the repetitions around it, the allocations per operation, and the
+  throughput.
+
+  @param name
+    The name of the benchmark
+
+  @param nsPerOp
+    The time per operation of each repetition
+
+  @param allocationsPerOp
+    The heap allocations per operation
+
+  @param bytesPerOp
+    The number of bytes each operation reads or writes, or 0
+*/
+void Bench::report(const std::string& name,
+                   std::vector<double> nsPerOp,
+                   double allocationsPerOp,
+                   size_t bytesPerOp) {
+	std::sort(nsPerOp.begin(), nsPerOp.end());
+	double median = nsPerOp[nsPerOp.size() / 2];
+	double spread = median > 0 ? (nsPerOp.back() - nsPerOp.front()) / median * 100 : 0;
+
+	char throughput[32];
+	if (bytesPerOp > 0){
+		std::snprintf(throughput, sizeof(throughput), "%10.1f MB/s",
+				bytesPerOp / median * 1e9 / 1e6);
+	} else {
+		std::snprintf(throughput, sizeof(throughput), "%10.3g op/s", 1e9 / median);
+	}
+
+	std::printf("%-50s %12.1f ns/op %5.1f%% %10.1f allocs/op %s\n",
+			name.c_str(),
+			median,
+			spread,
+			allocationsPerOp,
+			throughput);
+	std::fflush(stdout);
+}
@@ -0,0 +1,121 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations for the benchmarks, which are built with
+  `build.sh bench` into bin/bethyw-bench and run from the repository root
+  (so that the datasets directory can be found).
+
+  Every heap allocation in the benchmark binary is counted (see bench.cpp),
+  so each benchmark reports allocations per operation as well as time.
+
+  Each benchmark is warmed up first, then timed over several repetitions of
+  a fixed number of operations. The median time per operation is reported,
+  with the spread between the fastest and slowest repetition so that noisy
+  results stand out, and the throughput in operations or megabytes a second.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+size_t allocations() noexcept;
+
+void setFilter(const std::string& filter);
+void setRepetitions(unsigned int repetitions);
+unsigned int repetitions() noexcept;
+bool selected(const std::string& name);
+
+void report(const std::string& name,
+            std::vector<double> nsPerOp,
+            double allocationsPerOp,
+            size_t bytesPerOp);
+
+/*
+  The minimum time to spend warming up each benchmark before it is timed.
+*/
+constexpr std::chrono::milliseconds WARM_UP_TIME(50);
+
+/*
+  Bench::run(name, iterations, op, bytesPerOp)
+
+  Time an operation and count its allocations. The operation is run for at
+  least WARM_UP_TIME (at least once, and at most `iterations` times) to warm
+  up caches, the branch predictors and e.g. the intern table. It is then run
+  `iterations` times per repetition, and one line is printed with the median
+  time and the allocations per operation. Benchmarks whose name does not
+  match the filter given on the command line are skipped.
+
+  This is a template so that the operation is called directly, rather than
+  through a std::function, which would add to the time of small operations.
+
+  @param name
+    The name to report the benchmark under
+
+  @param iterations
+    The number of times to run the operation in each repetition
+
+  @param op
+    The operation to benchmark
+
+  @param bytesPerOp
+    The number of bytes each operation reads or writes, to report
+    throughput in MB/s, or 0 to report operations a second
+
+  @example
+    Bench::run("Measure::setValue", 1000000, [&]() {
+      measure.setValue(2000, 1);
+    });
+*/
+template <typename Op>
+void run(const std::string& name,
+         size_t iterations,
+         Op&& op,
+         size_t bytesPerOp = 0) {
+	if (!selected(name)){
+		return;
+	}
+
+	auto warmUpEnd = std::chrono::steady_clock::now() + WARM_UP_TIME;
+	size_t warmUps = 0;
+	do {
+		op();
+		warmUps++;
+	} while (warmUps < iterations && std::chrono::steady_clock::now() < warmUpEnd);
+
+	std::vector<double> nsPerOp;
+	size_t allocationsBefore = allocations();
+	for (unsigned int rep = 0; rep < repetitions(); rep++){
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < iterations; i++){
+			op();
+		}
+		auto end = std::chrono::steady_clock::now();
+		nsPerOp.push_back(std::chrono::duration<double, std::nano>(end - start).count()
+				/ iterations);
+	}
+	size_t allocationsAfter = allocations();
+
+	report(name, nsPerOp,
+			(double) (allocationsAfter - allocationsBefore) / (iterations * repetitions()),
+			bytesPerOp);
+}
+
+void measure();
+void area();
+void areas();
+void parse();
+void output();
+
+} // namespace Bench
+
+#endif // BENCH_H_
@@ -0,0 +1,46 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the entry point for the benchmarks. Run it from the
+  repository root:
+
+    ./build.sh bench
+    ./bin/bethyw-bench [filter] [--repetitions N]
+
+  With a filter, only the benchmarks whose names contain it are run, e.g.
+  ./bin/bethyw-bench populate
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "bench.h"
+
+int main(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--repetitions" && i + 1 < argc) {
+      Bench::setRepetitions(std::atoi(argv[++i]));
+    } else if (arg.rfind("--", 0) == 0) {
+      std::fprintf(stderr, "Usage: %s [filter] [--repetitions N]\n", argv[0]);
+      return 1;
+    } else {
+      Bench::setFilter(arg);
+    }
+  }
+
+  Bench::measure();
+  Bench::area();
+  Bench::areas();
+  Bench::parse();
+  Bench::output();
+  return 0;
+}
@@ -0,0 +1,173 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains benchmarks for building and merging Measure, Area and
+  Areas objects, i.e. what every parser does for every value it keeps.
+*/
+
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "../analytics.h"
+#include "../area.h"
+#include "../areas.h"
+#include "../intern.h"
+#include "../measure.h"
+
+namespace {
+
+//The years in the datasets, which all fall within these
+const int FIRST_YEAR = 1991;
+const int LAST_YEAR = 2020;
+const int YEARS = LAST_YEAR - FIRST_YEAR + 1;
+
+//A Measure with a reading for every year
+Measure fullMeasure(const std::string& codename) {
+	Measure measure(codename, "Label for " + codename);
+	for (int year = FIRST_YEAR; year <= LAST_YEAR; year++){
+		measure.setValue(year, year * 1.5);
+	}
+	return measure;
+}
+
+//An Area with a few full measures, as after importing every dataset
+Area fullArea(const std::string& code) {
+	Area area(code);
+	area.setName("eng", "English name");
+	area.setName("cym", "Welsh name");
+	for (const char* codename : {"pop", "area", "dens", "rail"}){
+		area.setMeasure(codename, fullMeasure(codename));
+	}
+	return area;
+}
+
+//The local authority codes of the 22 Welsh areas
+std::vector<std::string> areaCodes() {
+	std::vector<std::string> codes;
+	for (int i = 1; i <= 22; i++){
+		std::string number = std::to_string(i);
+		codes.push_back("W060000" + std::string(2 - number.size(), '0') + number);
+	}
+	return codes;
+}
+
+} // namespace
+
+/*
+  Bench::measure()
+
+  Benchmark setting readings on a Measure: overwriting existing years, and
+  building a Measure up year by year in either direction (growing the dense
+  storage at the end or at the front).
+*/
+void Bench::measure() {
+	Measure measure = fullMeasure("pop");
+	int year = FIRST_YEAR;
+
+	run("Measure::setValue (existing year)", 1000000, [&]() {
+		measure.setValue(year, 1.0);
+		year = year < LAST_YEAR ? year + 1 : FIRST_YEAR;
+	});
+	run("Measure::setValue x30 (ascending, new)", 100000, [&]() {
+		Measure built("pop", "Population");
+		for (int y = FIRST_YEAR; y <= LAST_YEAR; y++){
+			built.setValue(y, 1.0);
+		}
+		volatile int size = built.size();
+		(void) size;
+	});
+	run("Measure::setValue x30 (descending, new)", 100000, [&]() {
+		Measure built("pop", "Population");
+		for (int y = LAST_YEAR; y >= FIRST_YEAR; y--){
+			built.setValue(y, 1.0);
+		}
+		volatile int size = built.size();
+		(void) size;
+	});
+	run("Measure::getAverage", 1000000, [&]() {
+		volatile double average = measure.getAverage();
+		(void) average;
+	});
+}
+
+/*
+  Bench::area()
+
+  Benchmark Area::setMeasure() adding a new Measure, and merging a Measure
+  into one with the same codename (year by year, as Areas::setArea() does).
+*/
+void Bench::area() {
+	const Measure measure = fullMeasure("pop");
+	const InternId pop = InternTable::global().intern("pop");
+
+	run("Area::setMeasure (new)", 200000, [&]() {
+		Area area(std::string("W06000011"));
+		area.setMeasure(pop, measure);
+		volatile int size = area.size();
+		(void) size;
+	});
+
+	Area area = fullArea("W06000011");
+	run("Area::setMeasure (merge " + std::to_string(YEARS) + " years)", 200000, [&]() {
+		area.setMeasure(pop, measure);
+	});
+}
+
+/*
+  Bench::areas()
+
+  Benchmark Areas::setArea() adding every Welsh area to an empty Areas, and
+  merging them all into an Areas that already has them. Then benchmark the
+  statistics of every measure of every area, from each Measure in turn and
+  from a SeriesBatch.
+*/
+void Bench::areas() {
+	std::vector<Area> full;
+	for (const std::string& code : areaCodes()){
+		full.push_back(fullArea(code));
+	}
+
+	run("Areas::setArea x22 (new)", 2000, [&]() {
+		Areas areas = Areas();
+		for (const Area& area : full){
+			areas.setArea(area.getLocalAuthorityCodeId(), area);
+		}
+		volatile int size = areas.size();
+		(void) size;
+	});
+
+	Areas areas = Areas();
+	for (const Area& area : full){
+		areas.setArea(area.getLocalAuthorityCodeId(), area);
+	}
+	run("Areas::setArea x22 (merge)", 2000, [&]() {
+		for (const Area& area : full){
+			areas.setArea(area.getLocalAuthorityCodeId(), area);
+		}
+	});
+
+	//the same statistics one Measure at a time, and for every series at once
+	run("Measure::getAverage/getDifference x88", 20000, [&]() {
+		double total = 0;
+		for (const auto& area : areas.getAreas()){
+			for (const auto& measure : area.second.getMeasuresById()){
+				total += measure.second.getAverage() + measure.second.getDifference();
+			}
+		}
+		volatile double result = total;
+		(void) result;
+	});
+	const SeriesBatch batch = areas.toSeriesBatch();
+	run("SeriesBatch::summarise (88 series)", 20000, [&]() {
+		volatile size_t size = batch.summarise().size();
+		(void) size;
+	});
+}
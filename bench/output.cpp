@@ -0,0 +1,114 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains benchmarks for the output and comparison operators of
+  Areas, Area and Measure, which walk the whole data structure.
+*/
+
+#include <ostream>
+#include <streambuf>
+
+#include "bench.h"
+#include "../areas.h"
+#include "../datasets.h"
+#include "../input.h"
+
+namespace {
+
+/*
+  A stream buffer that throws away everything written to it, so that the
+  benchmarks measure formatting rather than the terminal. It counts what it
+  is given, so that throughput can be reported.
+*/
+class NullBuffer : public std::streambuf {
+private:
+	size_t count = 0;
+protected:
+	int overflow(int c) override {
+		count++;
+		return c;
+	}
+	std::streamsize xsputn(const char*, std::streamsize n) override {
+		count += n;
+		return n;
+	}
+public:
+	size_t bytes() const noexcept {
+		return count;
+	}
+};
+
+//Returns how many bytes print writes to a stream
+template <typename Print>
+size_t outputSize(Print print) {
+	NullBuffer buffer;
+	std::ostream out(&buffer);
+	print(out);
+	return buffer.bytes();
+}
+
+//Loads the datasets that every area in areas.csv has data for
+Areas loadAreas() {
+	Areas areas = Areas();
+	const BethYw::InputFileSource sources[] = {
+		BethYw::InputFiles::AREAS,
+		BethYw::InputFiles::POPDEN,
+		BethYw::InputFiles::COMPLETE_POPDEN
+	};
+	for (const auto& source : sources){
+		InputMmapFile input("datasets/" + source.FILE);
+		areas.populate(input.open(), source.PARSER, source.COLS, nullptr, nullptr, nullptr);
+	}
+	return areas;
+}
+
+} // namespace
+
+/*
+  Bench::output()
+
+  Benchmark printing and comparing a fully loaded Areas instance.
+*/
+void Bench::output() {
+	Areas areas = loadAreas();
+	Area& area = areas.getArea("W06000011");
+	Measure& measure = area.getMeasure("pop");
+
+	NullBuffer buffer;
+	std::ostream out(&buffer);
+
+	const size_t tableSize = outputSize([&](std::ostream& os) { os << areas; });
+	const size_t jsonSize = outputSize([&](std::ostream& os) { areas.writeJSON(os); });
+
+	run("operator<<(Areas)", 200, [&]() {
+		out << areas;
+	}, tableSize);
+	run("Areas::writeJSON", 200, [&]() {
+		areas.writeJSON(out);
+	}, jsonSize);
+	run("Areas::toJSON", 200, [&]() {
+		volatile size_t length = areas.toJSON().size();
+		(void) length;
+	}, jsonSize);
+	run("operator<<(Area)", 2000, [&]() {
+		out << area;
+	}, outputSize([&](std::ostream& os) { os << area; }));
+	run("operator<<(Measure)", 20000, [&]() {
+		out << measure;
+	}, outputSize([&](std::ostream& os) { os << measure; }));
+	run("operator==(Area)", 20000, [&]() {
+		volatile bool equal = area == area;
+		(void) equal;
+	});
+	run("operator==(Measure)", 200000, [&]() {
+		volatile bool equal = measure == measure;
+		(void) equal;
+	});
+}
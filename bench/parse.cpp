@@ -0,0 +1,136 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains benchmarks for each of the parsers behind
+  Areas::populate(). Each dataset is also scaled up in memory, by copying
+  its rows with new local authority codes, so that the parsers can be
+  measured on files larger than the ones we have, and so that results do
+  not just reflect the fixed cost of a parse.
+*/
+
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "../lib_json.hpp"
+
+#include "bench.h"
+#include "../areas.h"
+#include "../datasets.h"
+#include "../input.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+//How many copies of each file the scaled input is made of
+const int SCALE = 8;
+
+//Reads a whole dataset into memory
+std::string readDataset(const BethYw::InputFileSource& source) {
+	InputMmapFile input("datasets/" + source.FILE);
+	return std::string(input.open());
+}
+
+//The local authority code for the copy of an area in a scaled-up file
+std::string scaledCode(const std::string& code, int copy) {
+	return copy == 0 ? code : code + "-" + std::to_string(copy);
+}
+
+/*
+  Scales a CSV file whose first column is the local authority code, e.g.
+  areas.csv or complete-popu1009-pop.csv, by repeating every row after the
+  header with a new code.
+*/
+std::string scaleCSV(const std::string& contents, int copies) {
+	size_t headerEnd = contents.find('\n') + 1;
+	std::string scaled = contents.substr(0, headerEnd);
+	for (int copy = 0; copy < copies; copy++){
+		size_t start = headerEnd;
+		while (start < contents.size()){
+			size_t end = contents.find('\n', start);
+			end = end == std::string::npos ? contents.size() : end + 1;
+			std::string_view row(contents.data() + start, end - start);
+			size_t comma = row.find(',');
+			scaled += scaledCode(std::string(row.substr(0, comma)), copy);
+			scaled += row.substr(comma);
+			if (scaled.back() != '\n'){
+				scaled += '\n';
+			}
+			start = end;
+		}
+	}
+	return scaled;
+}
+
+//Scales a StatsWales JSON export by repeating its "value" array with new codes
+std::string scaleJSON(const std::string& contents, const BethYw::InputFileSource& source,
+		int copies) {
+	json document = json::parse(contents);
+	const std::string codeKey = source.COLS.at(BethYw::AUTH_CODE);
+	json rows = json::array();
+	for (int copy = 0; copy < copies; copy++){
+		for (json row : document["value"]){
+			row[codeKey] = scaledCode(row[codeKey].get<std::string>(), copy);
+			rows.push_back(row);
+		}
+	}
+	document["value"] = rows;
+	return document.dump();
+}
+
+//Benchmarks populating a new Areas from contents, with optional filters
+void runPopulate(const std::string& name,
+		const std::string& contents,
+		const BethYw::InputFileSource& source,
+		const StringFilterSet* areasFilter = nullptr,
+		unsigned int threads = 1) {
+	Bench::run(name + " (" + std::to_string(contents.size() / 1024) + " KiB)", 5, [&]() {
+		Areas areas = Areas();
+		areas.populate(contents, source.PARSER, source.COLS, areasFilter,
+				nullptr, nullptr, threads);
+		volatile int size = areas.size();
+		(void) size;
+	}, contents.size());
+}
+
+} // namespace
+
+/*
+  Bench::parse()
+
+  Benchmark each parser on a dataset as it is and scaled up SCALE times,
+  and the StatsWales JSON parser with an area filter and on several threads.
+*/
+void Bench::parse() {
+	const BethYw::InputFileSource& areasSource = BethYw::InputFiles::AREAS;
+	const std::string areasCSV = readDataset(areasSource);
+	runPopulate("populateFromAuthorityCodeCSV x1", areasCSV, areasSource);
+	runPopulate("populateFromAuthorityCodeCSV x" + std::to_string(SCALE),
+			scaleCSV(areasCSV, SCALE), areasSource);
+
+	const BethYw::InputFileSource& byYearSource = BethYw::InputFiles::COMPLETE_POP;
+	const std::string byYearCSV = readDataset(byYearSource);
+	runPopulate("populateFromAuthorityByYearCSV x1", byYearCSV, byYearSource);
+	runPopulate("populateFromAuthorityByYearCSV x" + std::to_string(SCALE),
+			scaleCSV(byYearCSV, SCALE), byYearSource);
+
+	const BethYw::InputFileSource& jsonSource = BethYw::InputFiles::POPDEN;
+	const std::string statsJSON = readDataset(jsonSource);
+	const std::string scaledJSON = scaleJSON(statsJSON, jsonSource, SCALE);
+	const StringFilterSet oneArea = {"W06000011"};
+	runPopulate("populateFromWelshStatsJSON x1", statsJSON, jsonSource);
+	runPopulate("populateFromWelshStatsJSON x" + std::to_string(SCALE),
+			scaledJSON, jsonSource);
+	runPopulate("populateFromWelshStatsJSON x" + std::to_string(SCALE) + " one area",
+			scaledJSON, jsonSource, &oneArea);
+	runPopulate("populateFromWelshStatsJSON x" + std::to_string(SCALE) + " 4 threads",
+			scaledJSON, jsonSource, nullptr, 4);
+}
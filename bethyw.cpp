@@ -15,8 +15,14 @@
   calling a series of helper functions.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <exception>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
@@ -26,7 +32,81 @@
 #include "areas.h"
 #include "datasets.h"
 #include "bethyw.h"
+#include "index.h"
 #include "input.h"
+#include "scheduler.h"
+#include "serve.h"
+#include "snapshot.h"
+#include "stats.h"
+#include "summary.h"
+
+namespace {
+
+//Set by SIGINT/SIGTERM to stop --serve
+std::atomic<bool> stopServing(false);
+
+void requestStop(int) {
+	stopServing = true;
+}
+
+//Prints the imported data to os as JSON or as tables, formatting large
+//outputs on up to threads tasks
+void writeOutput(std::ostream& os, const Areas& data, bool json, unsigned int threads) {
+	if (json){
+		// The output as JSON, streamed rather than built as a string
+		data.writeJSON(os, threads);
+		os << std::endl;
+	} else {
+		// The output as tables
+		data.writeTables(os, threads);
+		os << std::endl;
+	}
+}
+
+/*
+  True if useIndex is set and the summary next to a dataset file shows that
+  none of its records can pass the filters, so it need not even be opened.
+*/
+bool skipFile(const std::string& path,
+		const BethYw::InputFileSource& source,
+		const StringFilterSet& areasFilter,
+		const StringFilterSet& measuresFilter,
+		const YearFilterTuple& yearsFilter,
+		bool useIndex) {
+	if (!useIndex){
+		return false;
+	}
+	auto summary = BethYw::loadDatasetSummary(path, source);
+	return summary && !summary->mayMatch(&areasFilter, &measuresFilter, &yearsFilter);
+}
+
+/*
+  Imports a file that is already open, through its sidecar index if useIndex
+  is set and an index could be loaded or built, or else by reading it all.
+*/
+void populateFile(Areas& areas,
+		const std::string& path,
+		std::string_view contents,
+		const BethYw::InputFileSource& source,
+		const StringFilterSet* areasFilter,
+		const StringFilterSet* measuresFilter,
+		const YearFilterTuple* yearsFilter,
+		unsigned int threads,
+		BethYw::ImportStats* stats,
+		bool useIndex) {
+	if (useIndex){
+		auto index = BethYw::loadDatasetIndex(path, contents, source);
+		if (index){
+			areas.populateFromIndex(contents, *index, source.PARSER, source.COLS,
+					areasFilter, measuresFilter, yearsFilter, threads, stats);
+			return;
+		}
+	}
+	areas.populate(contents, source.PARSER, source.COLS,
+			areasFilter, measuresFilter, yearsFilter, threads, stats);
+}
+
+} // namespace
 
 /*
   Run Beth Yw?, parsing the command line arguments, importing the data,
@@ -63,24 +143,82 @@ int BethYw::run(int argc, char *argv[]) {
   auto areasFilter      = BethYw::parseAreasArg(args);
   auto measuresFilter   = BethYw::parseMeasuresArg(args);
   auto yearsFilter      = BethYw::parseYearsArg(args);
+  auto threads          = BethYw::parseThreadsArg(args);
+  auto statsFormat      = BethYw::parseStatsArg(args);
+
+  // One pool of worker threads for all the work below (see scheduler.h)
+  BethYw::TaskScheduler scheduler(threads);
+  BethYw::TaskScheduler::Scope schedulerScope(scheduler);
+
+  if (args.count("serve")) {
+    // Import once, then answer queries until interrupted
+    BethYw::QueryServer server(dir,
+                               datasetsToImport,
+                               areasFilter,
+                               measuresFilter,
+                               yearsFilter,
+                               threads);
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    const std::string socketPath = args["serve"].as<std::string>();
+    std::cerr << "Serving queries on " << socketPath << std::endl;
+    server.serve(socketPath, threads, stopServing);
+    return 0;
+  }
+
+  // Only filled in, and only passed on, if --stats was given
+  BethYw::RunStats runStats;
+  BethYw::RunStats* stats = statsFormat.empty() ? nullptr : &runStats;
+  BethYw::Stopwatch runTimer;
 
   Areas data = Areas();
 
-   BethYw::loadAreas(data, dir, areasFilter);
+  if (args.count("snapshot-read")) {
+    // A snapshot replaces the text datasets, so --dir and -d are not used
+    BethYw::loadSnapshot(data,
+                         args["snapshot-read"].as<std::string>(),
+                         areasFilter,
+                         measuresFilter,
+                         yearsFilter,
+                         stats);
+  } else {
+   bool useIndexes = args.count("index") > 0;
+
+   BethYw::loadAreas(data, dir, areasFilter, stats, useIndexes);
 
    BethYw::loadDatasets(data,
                         dir,
                         datasetsToImport,
                         areasFilter,
                         measuresFilter,
-                        yearsFilter);
+                        yearsFilter,
+                        threads,
+                        stats,
+                        useIndexes);
+  }
+
+  if (args.count("snapshot-write")) {
+    BethYw::saveSnapshot(data, args["snapshot-write"].as<std::string>());
+  }
+
+  if (stats == nullptr) {
+    writeOutput(std::cout, data, args.count("json"), threads);
+    return 0;
+  }
 
-  if (args.count("json")) {
-    // The output as JSON
-    //std::cout << data.toJSON() << std::endl;
+  // Count the output on its way to stdout, then report to stderr
+  BethYw::CountingStreamBuf counter(std::cout.rdbuf());
+  std::ostream counted(&counter);
+  BethYw::Stopwatch formatTimer;
+  writeOutput(counted, data, args.count("json"), threads);
+  stats->formatMs = formatTimer.elapsedMs();
+  stats->outputBytes = counter.bytes();
+  stats->runMs = runTimer.elapsedMs();
+
+  if (statsFormat == "json") {
+    stats->writeJSON(std::cerr);
   } else {
-    // The output as tables
-     std::cout << data << std::endl;
+    stats->writeTable(std::cerr);
   }
 
   return 0;
@@ -116,12 +254,14 @@ cxxopts::Options BethYw::cxxoptsSetup() {
 
       "a,areas",
       "The areas(s) to import and analyse as a comma-separated list of "
-      "authority codes (omit or set to 'all' to import and analyse all areas)",
+      "authority codes or patterns of them, e.g. W06* (omit or set to 'all' "
+      "to import and analyse all areas)",
       cxxopts::value<std::vector<std::string>>())(
 
       "m,measures",
-      "Select a subset of measures from the dataset(s) "
-      "(omit or set to 'all' to import and analyse all measures)",
+      "Select a subset of measures from the dataset(s), as codenames or "
+      "patterns of them, e.g. pm* (omit or set to 'all' to import and "
+      "analyse all measures)",
       cxxopts::value<std::vector<std::string>>())(
 
       "y,years",
@@ -132,6 +272,37 @@ cxxopts::Options BethYw::cxxoptsSetup() {
       "j,json",
       "Print the output as JSON instead of tables.")(
 
+      "threads",
+      "Number of worker threads used to load, query and print datasets "
+      "(omit or set to 0 to use one per CPU core)",
+      cxxopts::value<std::string>()->default_value("0"))(
+
+      "snapshot-write",
+      "Save the imported data to a binary snapshot file",
+      cxxopts::value<std::string>())(
+
+      "snapshot-read",
+      "Load the data from a binary snapshot file instead of the datasets "
+      "(the areas, measures and years filters still apply)",
+      cxxopts::value<std::string>())(
+
+      "index",
+      "Keep an index of where each area and measure is next to each dataset "
+      "file (e.g. popu1009.json.idx), and use it to read only the matching "
+      "records when -a or -m selects a few of them, and to skip files with "
+      "none")(
+
+      "serve",
+      "Import the datasets once, then answer queries written like the "
+      "-d/-a/-m/-y/-j arguments, one per line, on this UNIX domain socket",
+      cxxopts::value<std::string>())(
+
+      "stats",
+      "Print the time spent opening, parsing and merging each file and "
+      "formatting the output, and the bytes and records handled, to stderr "
+      "(--stats=json for JSON instead of a table)",
+      cxxopts::value<std::string>()->implicit_value("table"))(
+
       "h,help",
       "Print usage.");
 
@@ -238,7 +409,8 @@ std::vector<BethYw::InputFileSource> BethYw::parseDatasetsArg(
   Unlike datasets we can't check the validity of the values as it depends
   on each individual file imported (which hasn't happened until runtime).
   Therefore, we simply fetch the list of areas and later pass it to the
-  Areas::populate() function.
+  Areas::populate() function. A value may also be a pattern, e.g. W06*,
+  which RecordFilter (see filter.h) matches against each area's code.
 
   The filtering of inputs should be case insensitive.
 
@@ -289,7 +461,8 @@ std::unordered_set<std::string> BethYw::parseAreasArg(
   Unlike datasets we can't check the validity of the values as it depends
   on each individual file imported (which hasn't happened until runtime).
   Therefore, we simply fetch the list of areas and later pass it to the
-  Areas::populate() function.
+  Areas::populate() function. A value may also be a pattern, e.g. pm*,
+  which RecordFilter (see filter.h) matches against each measure's codename.
 
   The filtering of inputs should be case insensitive.
 
@@ -387,6 +560,72 @@ std::tuple<unsigned int, unsigned int>  BethYw::parseYearsArg(
 
 	return years;
 }
+
+/*
+  BethYw::parseThreadsArg(args)
+
+  Parse the threads command line argument, which is optional. It gives the
+  number of worker threads in the BethYw::TaskScheduler that loads, queries
+  and prints the data. If it is omitted or is 0, one thread per CPU core is
+  used.
+
+  @param args
+    Parsed program arguments
+
+  @return
+    The number of threads to use, which is at least 1
+
+  @throws
+    std::invalid_argument if the argument is not a non-negative number, with
+    the message: Invalid input for threads argument
+*/
+unsigned int BethYw::parseThreadsArg(cxxopts::ParseResult& args) {
+	std::string inputThreads = args["threads"].as<std::string>();
+
+	if (inputThreads.empty() || inputThreads.size() > 4){
+		throw std::invalid_argument("Invalid input for threads argument");
+	}
+	for (std::size_t i = 0; i<inputThreads.size(); i++){
+		if (!isdigit(inputThreads[i])){
+			throw std::invalid_argument("Invalid input for threads argument");
+		}
+	}
+
+	unsigned int threads = std::stoi(inputThreads);
+	if (threads == 0){
+		threads = std::thread::hardware_concurrency();
+	}
+	return threads > 0 ? threads : 1;
+}
+
+/*
+  BethYw::parseStatsArg(args)
+
+  Parse the stats command line argument, which is optional. Given on its
+  own (--stats) it asks for the report as a table; --stats=json asks for it
+  as JSON.
+
+  @param args
+    Parsed program arguments
+
+  @return
+    "table" or "json", or an empty string if no report was asked for
+
+  @throws
+    std::invalid_argument if the argument is anything else, with the
+    message: Invalid input for stats argument
+*/
+std::string BethYw::parseStatsArg(cxxopts::ParseResult& args) {
+	if (!args.count("stats")){
+		return "";
+	}
+	std::string format = args["stats"].as<std::string>();
+	if (format != "table" && format != "json"){
+		throw std::invalid_argument("Invalid input for stats argument");
+	}
+	return format;
+}
+
 /*
   TODO: BethYw::loadAreas(areas, dir, areasFilter)
 
@@ -401,6 +640,10 @@ std::tuple<unsigned int, unsigned int>  BethYw::parseYearsArg(
   object with the filename of the areas file, open it, and then pass reference 
   to the stream to the Areas::populate() function.
 
+  The file is opened with InputMmapFile, so the parser reads the mapped file
+  directly rather than through a stream. Areas not in areasFilter are skipped
+  before they are created.
+
   Hint 2: you can retrieve the specific filename for a dataset, e.g. for the 
   areas.csv file, from the InputFileSource's FILE member variable
 
@@ -414,6 +657,13 @@ std::tuple<unsigned int, unsigned int>  BethYw::parseYearsArg(
   @param areasFilter
     An unordered set of areas to filter, or empty to import all areas
 
+  @param stats
+    If not nullptr, the figures for the file are added to its imports
+
+  @param useIndex
+    If true, the sidecar index of the file is used, and built if needed
+    (see index.h)
+
   @return
     void
 
@@ -423,12 +673,27 @@ std::tuple<unsigned int, unsigned int>  BethYw::parseYearsArg(
     BethYw::loadAreas(areas, "data", BethYw::parseAreasArg(args));
 */
 
-void BethYw::loadAreas(Areas& areas, std::string dir,  StringFilterSet areasFilter){
+void BethYw::loadAreas(Areas& areas, std::string dir,  StringFilterSet areasFilter,
+		RunStats* stats, bool useIndex){
 	std::string filename = InputFiles::AREAS.FILE;
-	InputFile input(dir + filename);
-	std::istream &stream = input.open();
-	auto cols = InputFiles::AREAS.COLS;
-	areas.populate(stream,BethYw::SourceDataType::AuthorityCodeCSV,cols); // @suppress("Ambiguous problem")
+	ImportStats import;
+	Stopwatch timer;
+	InputMmapFile input(dir + filename);
+	std::string_view contents = input.open();
+	import.openMs = timer.elapsedMs();
+
+	import.bytesRead = contents.size();
+
+	timer.restart();
+	populateFile(areas, dir + filename, contents, InputFiles::AREAS,
+			&areasFilter, nullptr, nullptr, 1,
+			stats != nullptr ? &import : nullptr, useIndex);
+
+	if (stats != nullptr){
+		import.parseMs = timer.elapsedMs();
+		import.name = InputFiles::AREAS.CODE;
+		stats->imports.push_back(import);
+	}
 }
 /*
   TODO: BethYw::loadDatasets(areas,
@@ -444,10 +709,10 @@ void BethYw::loadAreas(Areas& areas, std::string dir,  StringFilterSet areasFilt
   The actual filtering will be done by the Areas::populate() function, thus 
   you need to merely pass pointers on to these flters.
 
-  This function should promise not to throw an exception. If there is an
-  error/exception thrown in any function called by thus function, catch it and
-  output 'Error importing dataset:', followed by a new line and then the output
-  of the what() function on the exception.
+  Errors are not caught here: if a dataset cannot be opened or parsed, the
+  exception (e.g. std::runtime_error from InputMmapFile::open()) is rethrown
+  to the caller. See @param threads for which datasets have been loaded
+  into `areas` by then.
 
   @param areas
     An Areas instance that should be modified (i.e. datasets loaded into it)
@@ -470,9 +735,35 @@ void BethYw::loadAreas(Areas& areas, std::string dir,  StringFilterSet areasFilt
     An two-pair tuple of unsigned ints corresponding to the range of years 
     to import, which should both be 0 to import all years.
 
+  @param threads
+    The most datasets, and ranges of large files, to parse at once. With
+    more than one, each dataset is parsed into its own Areas shard by a task
+    on BethYw::TaskScheduler::global(), and the shards are then merged
+    into `areas` in the order of `datasetsToImport`, so the result is the
+    same as loading them one after another. If a dataset fails to load, the
+    first error raised is rethrown once every task has finished, and no
+    shard is merged, so `areas` is left unchanged. On one thread the
+    datasets before the failing one have already been loaded.
+
+  @param stats
+    If not nullptr, the figures for each dataset are added to its imports.
+    Each dataset is then parsed into a shard of its own, even on one
+    thread, so that the parse and merge phases can be timed separately.
+
+  @param useIndexes
+    If true, the sidecar index of each file is used, and built if needed,
+    so that narrow filters only read the matching records (see index.h).
+    Files whose summary shows they have no records that pass the filters
+    are skipped without being opened (see summary.h); they are still listed
+    in stats, with nothing read.
+
   @return
     void
 
+  @throws
+    The first exception raised while opening or parsing a dataset, e.g.
+    std::runtime_error if a file cannot be opened
+
   @example
     Areas areas();
 
@@ -488,18 +779,196 @@ void BethYw::loadDatasets(Areas& areas, std::string dir,
 		std::vector<BethYw::InputFileSource> datasetsToImport,
 		StringFilterSet areasFilter,
 		StringFilterSet  measuresFilter,
-		YearFilterTuple yearsFilter){
-	std::cout << "BethYw::loadDatasets entered \n";
-	for (auto it = datasetsToImport.begin(); it != datasetsToImport.end();it++){
-		std::string filename = it->FILE;
-		SourceDataType type = it->PARSER;
-		auto cols = it->COLS;
-		std::cout << dir << filename << ": Attempting open\n";
-		InputFile input(dir + filename);
-		std::istream &stream = input.open();
-		std::cout << dir << filename << ": Opened! \n";
-		areas.populate(stream,type,cols,&areasFilter,&measuresFilter,&yearsFilter);
+		YearFilterTuple yearsFilter,
+		unsigned int threads,
+		RunStats* stats,
+		bool useIndexes){
+	const size_t numDatasets = datasetsToImport.size();
+
+	if (threads <= 1 || numDatasets <= 1){
+		for (auto it = datasetsToImport.begin(); it != datasetsToImport.end();it++){
+			if (stats == nullptr){
+				if (skipFile(dir + it->FILE, *it, areasFilter, measuresFilter, yearsFilter, useIndexes)){
+					continue;
+				}
+				InputMmapFile input(dir + it->FILE);
+				std::string_view contents = input.open();
+				populateFile(areas, dir + it->FILE, contents, *it,
+						&areasFilter, &measuresFilter, &yearsFilter, threads, nullptr, useIndexes);
+				continue;
+			}
+
+			ImportStats import;
+			import.name = it->CODE;
+			Stopwatch timer;
+			if (skipFile(dir + it->FILE, *it, areasFilter, measuresFilter, yearsFilter, useIndexes)){
+				import.openMs = timer.elapsedMs();
+				stats->imports.push_back(import);
+				continue;
+			}
+			InputMmapFile input(dir + it->FILE);
+			std::string_view contents = input.open();
+			import.openMs = timer.elapsedMs();
+			import.bytesRead = contents.size();
+
+			timer.restart();
+			Areas shard = Areas();
+			populateFile(shard, dir + it->FILE, contents, *it,
+					&areasFilter, &measuresFilter, &yearsFilter, threads, &import, useIndexes);
+			import.parseMs = timer.elapsedMs();
+
+			timer.restart();
+			areas.merge(std::move(shard));
+			import.mergeMs = timer.elapsedMs();
+			stats->imports.push_back(import);
+		}
+		return;
+	}
+
+	//each dataset is parsed into its own shard by a task of its own, and the
+	//threads left over are shared out for splitting large files
+	unsigned int threadsPerDataset = std::max<unsigned int>(1,
+			threads / std::min<size_t>(threads, numDatasets));
+	std::vector<Areas> shards(numDatasets);
+	std::vector<ImportStats> imports(numDatasets);
+
+	//the first error cancels the datasets not yet started, and is rethrown
+	TaskGroup group;
+	for (size_t i = 0; i < numDatasets; i++){
+		group.run([&, i]() {
+			const InputFileSource& dataset = datasetsToImport[i];
+			ImportStats& import = imports[i];
+			Stopwatch timer;
+			if (skipFile(dir + dataset.FILE, dataset, areasFilter, measuresFilter,
+					yearsFilter, useIndexes)){
+				import.openMs = timer.elapsedMs();
+				return;
+			}
+			InputMmapFile input(dir + dataset.FILE);
+			std::string_view contents = input.open();
+			import.openMs = timer.elapsedMs();
+			import.bytesRead = contents.size();
+
+			timer.restart();
+			populateFile(shards[i], dir + dataset.FILE, contents, dataset,
+					&areasFilter, &measuresFilter, &yearsFilter, threadsPerDataset,
+					stats != nullptr ? &import : nullptr, useIndexes);
+			import.parseMs = timer.elapsedMs();
+		});
+	}
+	group.wait();
+
+	//merged in the order given, so later datasets take precedence as before
+	for (size_t i = 0; i < numDatasets; i++){
+		Stopwatch timer;
+		areas.merge(std::move(shards[i]));
+		imports[i].mergeMs = timer.elapsedMs();
+	}
+
+	if (stats != nullptr){
+		for (size_t i = 0; i < numDatasets; i++){
+			imports[i].name = datasetsToImport[i].CODE;
+			stats->imports.push_back(imports[i]);
+		}
+	}
+}
+
+/*
+  BethYw::loadSnapshot(areas, path, areasFilter, measuresFilter, yearsFilter)
+
+  Load a snapshot previously written with BethYw::saveSnapshot() into areas,
+  instead of importing areas.csv and the datasets. The file is mapped with
+  InputMmapFile, and the filters are applied as it is read, so the result is
+  the same as importing the datasets the snapshot was made from with the
+  same filters.
+
+  @param areas
+    An Areas instance that should be modified (i.e. the snapshot loaded into it)
+
+  @param path
+    The path of the snapshot file
+
+  @param areasFilter
+    An unordered set of areas to filter, or empty to import all areas
+
+  @param measuresFilter
+    An unordered set of measures to filter, or empty to import all measures
+
+  @param yearsFilter
+    An two-pair tuple of unsigned ints corresponding to the range of years
+    to import, which should both be 0 to import all years.
+
+  @param stats
+    If not nullptr, the time taken to open and read the snapshot and its
+    size are added to its imports; the records are not counted
+
+  @return
+    void
+
+  @throws
+    std::runtime_error if the file cannot be opened or is not a valid
+    snapshot, see BethYw::readSnapshot()
+
+  @example
+    Areas areas();
+
+    BethYw::loadSnapshot(areas, "all.snapshot", BethYw::parseAreasArg(args),
+        BethYw::parseMeasuresArg(args), BethYw::parseYearsArg(args));
+*/
+void BethYw::loadSnapshot(Areas& areas, const std::string& path,
+		StringFilterSet areasFilter,
+		StringFilterSet measuresFilter,
+		YearFilterTuple yearsFilter,
+		RunStats* stats){
+	ImportStats import;
+	Stopwatch timer;
+	InputMmapFile input(path);
+	std::string_view contents = input.open();
+	import.openMs = timer.elapsedMs();
+
+	timer.restart();
+	RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+	BethYw::readSnapshot(contents, areas, &filter);
+
+	if (stats != nullptr){
+		import.parseMs = timer.elapsedMs();
+		import.name = "snapshot";
+		import.bytesRead = contents.size();
+		stats->imports.push_back(import);
 	}
 }
 
+/*
+  BethYw::saveSnapshot(areas, path)
+
+  Write everything in areas to a binary snapshot file, which can be loaded
+  much faster than the datasets with BethYw::loadSnapshot(). An existing file
+  is replaced.
+
+  @param areas
+    The Areas instance to save
+
+  @param path
+    The path of the snapshot file
+
+  @return
+    void
+
+  @throws
+    std::runtime_error if the file cannot be written, with the message:
+    BethYw::saveSnapshot: Failed to write file <path>
 
+  @example
+    BethYw::saveSnapshot(areas, "all.snapshot");
+*/
+void BethYw::saveSnapshot(const Areas& areas, const std::string& path){
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()){
+		throw std::runtime_error("BethYw::saveSnapshot: Failed to write file " + path);
+	}
+	BethYw::writeSnapshot(file, areas);
+	file.close();
+	if (!file){
+		throw std::runtime_error("BethYw::saveSnapshot: Failed to write file " + path);
+	}
+}
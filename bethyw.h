@@ -23,6 +23,7 @@
 
 #include "datasets.h"
 #include "areas.h"
+#include "stats.h"
 const char DIR_SEP =
 #ifdef _WIN32
     '\\';
@@ -61,12 +62,25 @@ std::vector<BethYw::InputFileSource> parseDatasetsArg(
 std::unordered_set<std::string> parseAreasArg(cxxopts::ParseResult& args);
 std::unordered_set<std::string> parseMeasuresArg(cxxopts::ParseResult& args);
 std::tuple<unsigned int, unsigned int> parseYearsArg(cxxopts::ParseResult& args);
-void loadAreas(Areas& ars, std::string, StringFilterSet areasFilter);
+unsigned int parseThreadsArg(cxxopts::ParseResult& args);
+std::string parseStatsArg(cxxopts::ParseResult& args);
+void loadAreas(Areas& ars, std::string, StringFilterSet areasFilter,
+		RunStats* stats = nullptr,
+		bool useIndex = false);
 void loadDatasets(Areas& areas, std::string dir,
 		std::vector<BethYw::InputFileSource> datasetsToImport,
 		StringFilterSet areasFilter,
 		StringFilterSet measuresFilter,
-		YearFilterTuple yearsFilter);
+		YearFilterTuple yearsFilter,
+		unsigned int threads = 1,
+		RunStats* stats = nullptr,
+		bool useIndexes = false);
+void loadSnapshot(Areas& areas, const std::string& path,
+		StringFilterSet areasFilter,
+		StringFilterSet measuresFilter,
+		YearFilterTuple yearsFilter,
+		RunStats* stats = nullptr);
+void saveSnapshot(const Areas& areas, const std::string& path);
 } // namespace BethYw
 
 #endif // BETHYW_H_
@@ -2,14 +2,30 @@
 
 SET bin_dir=bin
 SET tests_dir=tests
-SET source_files=bethyw.cpp input.cpp areas.cpp area.cpp measure.cpp
+SET source_files=bethyw.cpp input.cpp areas.cpp areaparts.cpp area.cpp measure.cpp analytics.cpp statswales.cpp csv.cpp intern.cpp facts.cpp filter.cpp snapshot.cpp index.cpp summary.cpp jsonwriter.cpp tablewriter.cpp pipeline.cpp scheduler.cpp serve.cpp stats.cpp generate.cpp
 SET main_file=main.cpp
 SET executable=%bin_dir%\bethyw.exe
+SET optimise=
 
 COPY bin\bethyw2.exe bin\bethyw.exe
 
 IF "%1"=="" GOTO compile
 
+IF "%1"=="bench" (
+  SET source_files=%source_files% bench\bench.cpp bench\main.cpp bench\model.cpp bench\output.cpp bench\parse.cpp
+  SET main_file=
+  SET executable=%bin_dir%\bethyw-bench.exe
+  SET optimise=-O2
+  GOTO compile
+)
+
+IF "%1"=="gen" (
+  SET main_file=gen\main.cpp
+  SET executable=%bin_dir%\bethyw-gen.exe
+  SET optimise=-O2
+  GOTO compile
+)
+
 SET testStr=%1%
 SET testStr=%testStr:~0,4%
 IF %testStr%==test (
@@ -25,6 +41,6 @@ IF %testStr%==test (
 :compile
 IF NOT EXIST %bin_dir% MKDIR %bin_dir%
 IF EXIST %executable% DEL %executable%
-g++ --std=c++14 -Wall %source_files% %main_file% -o %executable%
+g++ --std=c++17 -Wall %optimise% %source_files% %main_file% -pthread -o %executable%
 
 :end
@@ -2,18 +2,30 @@
 
 BIN_DIR="bin"
 TESTS_DIR="tests"
-SOURCE_FILES="bethyw.cpp input.cpp areas.cpp area.cpp measure.cpp"
+BENCH_DIR="bench"
+GEN_DIR="gen"
+SOURCE_FILES="bethyw.cpp input.cpp areas.cpp areaparts.cpp area.cpp measure.cpp analytics.cpp statswales.cpp csv.cpp intern.cpp facts.cpp filter.cpp snapshot.cpp index.cpp summary.cpp jsonwriter.cpp tablewriter.cpp pipeline.cpp scheduler.cpp serve.cpp stats.cpp generate.cpp"
 MAIN_FILE="main.cpp"
+OPTIMISE=""
 EXECUTABLE="./${BIN_DIR}/bethyw"
 
 set -x
 cd "${0%/*}"
 
 if [ $# -gt 1 ]; then
-  echo "Unknown arguments!" "Only one argument accepted, and must begin with test"
+  echo "Unknown arguments!" "Only one argument accepted, and must begin with test or be bench or gen"
   exit
 elif [ $# -eq 1 ]; then
-  if [[ $1 == test* ]]; then
+  if [[ $1 == bench ]]; then
+    SOURCE_FILES="${SOURCE_FILES} $(ls ./${BENCH_DIR}/*.cpp)"
+    MAIN_FILE=""
+    EXECUTABLE="./${BIN_DIR}/bethyw-bench"
+    OPTIMISE="-O2"
+  elif [[ $1 == gen ]]; then
+    MAIN_FILE="./${GEN_DIR}/main.cpp"
+    EXECUTABLE="./${BIN_DIR}/bethyw-gen"
+    OPTIMISE="-O2"
+  elif [[ $1 == test* ]]; then
     SOURCE_FILES="${SOURCE_FILES} ./${TESTS_DIR}/$1.cpp"
     MAIN_FILE="./${BIN_DIR}/catch.o"
     EXECUTABLE="./${BIN_DIR}/bethyw-test"
@@ -27,4 +39,4 @@ fi
 
 mkdir -p ${BIN_DIR}
 rm ${EXECUTABLE} 2> /dev/null
-g++ --std=c++14 -pedantic -Wall ${SOURCE_FILES} ${MAIN_FILE} -o ${EXECUTABLE}
\ No newline at end of file
+g++ --std=c++17 -pedantic -Wall ${OPTIMISE} ${SOURCE_FILES} ${MAIN_FILE} -pthread -o ${EXECUTABLE}
\ No newline at end of file
@@ -0,0 +1,199 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the CSVReader class. Delimiters and
+  line endings are found with memchr(), which the C library implements with
+  vector instructions, so the common case of an unquoted cell costs a couple of
+  memchr() calls and no copying. See csv.h for details.
+*/
+
+#include <charconv>
+#include <cstring>
+
+#include "csv.h"
+
+/*
+  CSVReader::CSVReader(buffer, delimiter)
+
+  Construct a reader over a buffer of CSV data.
+
+  @param buffer
+    The CSV data, e.g. from InputMmapFile::open()
+
+  @param delimiter
+    The character between cells
+
+  @example
+    InputMmapFile input("data/areas.csv");
+    CSVReader reader(input.open());
+*/
+CSVReader::CSVReader(std::string_view _buffer, char _delimiter)
+    : buffer(_buffer), pos(0), delimiter(_delimiter) {
+}
+
+/*
+  CSVReader::done()
+
+  @return
+    true if there are no more rows to read
+*/
+bool CSVReader::done() const noexcept {
+	return pos >= buffer.size();
+}
+
+/*
+  CSVReader::position()
+
+  @return
+    The offset in the buffer of the next row, or the size of the buffer if
+    there are no more rows
+*/
+size_t CSVReader::position() const noexcept {
+	return pos < buffer.size() ? pos : buffer.size();
+}
+
+/*
+  CSVReader::nextRow(cells)
+
+  Read the next row, replacing the contents of cells with a view for each cell
+  in the row. Reusing the same vector for every row means it is only allocated
+  once. An empty line gives a single empty cell.
+
+  @param cells
+    Container to fill with the cells of the row
+
+  @return
+    false if there were no more rows, in which case cells is empty
+
+  @example
+    CSVReader reader(input.open());
+    std::vector<std::string_view> cells;
+    while (reader.nextRow(cells)) {
+      ...
+    }
+*/
+bool CSVReader::nextRow(std::vector<std::string_view>& cells) {
+	cells.clear();
+	if (done()){
+		return false;
+	}
+
+	const char* data = buffer.data();
+	const size_t size = buffer.size();
+
+	const void* newline = std::memchr(data + pos, '\n', size - pos);
+	size_t lineEnd = newline != nullptr
+			? static_cast<const char*>(newline) - data
+			: size;
+
+	while (true){
+		if (pos < size && data[pos] == '"'){
+			pos = readQuotedCell(cells);
+			//the quoted cell may have run over the line break we found
+			if (pos > lineEnd){
+				newline = std::memchr(data + pos, '\n', size - pos);
+				lineEnd = newline != nullptr
+						? static_cast<const char*>(newline) - data
+						: size;
+			}
+			if (pos < lineEnd && data[pos] == delimiter){
+				pos++;
+				continue;
+			}
+			//anything between the closing quote and the delimiter is dropped
+			const void* next = std::memchr(data + pos, delimiter, lineEnd - pos);
+			if (next != nullptr){
+				pos = static_cast<const char*>(next) - data + 1;
+				continue;
+			}
+			break;
+		}
+
+		const void* next = std::memchr(data + pos, delimiter, lineEnd - pos);
+		if (next == nullptr){
+			size_t cellEnd = lineEnd;
+			if (cellEnd > pos && data[cellEnd - 1] == '\r'){
+				cellEnd--;
+			}
+			cells.emplace_back(data + pos, cellEnd - pos);
+			break;
+		}
+		size_t cellEnd = static_cast<const char*>(next) - data;
+		cells.emplace_back(data + pos, cellEnd - pos);
+		pos = cellEnd + 1;
+	}
+
+	pos = lineEnd + 1;
+	return true;
+}
+
+//Adds the quoted cell starting at pos to cells, returning the position after it
+size_t CSVReader::readQuotedCell(std::vector<std::string_view>& cells) {
+	const char* data = buffer.data();
+	const size_t size = buffer.size();
+	size_t start = pos + 1;
+	size_t end = start;
+
+	while (true){
+		const void* quote = std::memchr(data + end, '"', size - end);
+		if (quote == nullptr){
+			//unterminated, so the cell runs to the end of the buffer
+			cells.emplace_back(data + start, size - start);
+			return size;
+		}
+		end = static_cast<const char*>(quote) - data;
+		if (end + 1 < size && data[end + 1] == '"'){
+			end += 2;
+			continue;
+		}
+		cells.emplace_back(data + start, end - start);
+		return end + 1;
+	}
+}
+
+/*
+  CSVReader::toInt(cell, value)
+
+  Convert a whole cell to an integer without creating a string.
+
+  @param cell
+    The cell to convert
+
+  @param value
+    Set to the converted value on success
+
+  @return
+    true if the whole cell was a valid integer
+*/
+bool CSVReader::toInt(std::string_view cell, int& value) noexcept {
+	const char* end = cell.data() + cell.size();
+	auto result = std::from_chars(cell.data(), end, value);
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+/*
+  CSVReader::toDouble(cell, value)
+
+  Convert a whole cell to a double without creating a string.
+
+  @param cell
+    The cell to convert
+
+  @param value
+    Set to the converted value on success
+
+  @return
+    true if the whole cell was a valid number
+*/
+bool CSVReader::toDouble(std::string_view cell, double& value) noexcept {
+	const char* end = cell.data() + cell.size();
+	auto result = std::from_chars(cell.data(), end, value);
+	return result.ec == std::errc() && result.ptr == end;
+}
@@ -0,0 +1,47 @@
+#ifndef CSV_H_
+#define CSV_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the CSVReader class, a tokenizer for
+  the comma-separated files we import (areas.csv and the complete-popu1009-*
+  files). It walks a buffer that is already in memory and hands back each row
+  as views into that buffer, so no strings are created for the cells. Numbers
+  are converted straight from the views with std::from_chars.
+ */
+
+#include <string_view>
+#include <vector>
+
+/*
+  Reads rows from a buffer of CSV data. Rows end with \n or \r\n. A cell that
+  starts with a double quote runs until the closing quote and may contain
+  delimiters and line breaks; the view for such a cell excludes the outer
+  quotes (doubled quotes inside it are left as they are).
+
+  The views returned by nextRow() point into the buffer passed to the
+  constructor, so they are only valid while that buffer is.
+*/
+class CSVReader {
+private:
+	std::string_view buffer;
+	size_t pos;
+	char delimiter;
+
+	size_t readQuotedCell(std::vector<std::string_view>& cells);
+public:
+  CSVReader(std::string_view buffer, char delimiter = ',');
+  bool nextRow(std::vector<std::string_view>& cells);
+  bool done() const noexcept;
+  size_t position() const noexcept;
+
+  static bool toInt(std::string_view cell, int& value) noexcept;
+  static bool toDouble(std::string_view cell, double& value) noexcept;
+};
+
+#endif // CSV_H_
@@ -0,0 +1,273 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the FactTable class. The table is
+  built in one pass over the Areas tree, then each partition is sorted by
+  year and area. Aggregates over a year find that year's slice of a partition
+  with a binary search and then run a plain loop over the slice.
+*/
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+#include "facts.h"
+
+//Returns the number of facts in the partition
+size_t FactTable::Partition::size() const noexcept {
+	return values.size();
+}
+
+/*
+  FactTable::Partition::yearRange(year)
+
+  Find the facts for a given year in the partition.
+
+  @param year
+    The year to find
+
+  @return
+    The index of the first fact for the year and one past the last, which
+    are equal if there are no facts for the year
+
+  @example
+    auto& pop = table.getPartition("pop");
+    auto range = pop.yearRange(2015);
+    for (size_t i = range.first; i < range.second; i++) {
+      ... pop.areas[i], pop.values[i] ...
+    }
+*/
+std::pair<size_t, size_t> FactTable::Partition::yearRange(int year) const noexcept {
+	auto range = std::equal_range(years.begin(), years.end(), year);
+	return {range.first - years.begin(), range.second - years.begin()};
+}
+
+/*
+  FactTable::FactTable()
+
+  Construct an empty FactTable.
+*/
+FactTable::FactTable() : facts(0) {
+}
+
+/*
+  FactTable::FactTable(areas)
+
+  Construct a FactTable holding every value in a container of Area objects.
+
+  @param areas
+    The Area objects to copy the values of
+
+  @example
+    Areas data = Areas();
+    data.populate(...);
+    FactTable table = data.toFactTable();
+*/
+FactTable::FactTable(const AreasContainer& areas) : facts(0) {
+	//gather each measure's facts in the order we find them
+	std::map<InternId, Partition> unsorted;
+	for (auto ar = areas.begin(); ar != areas.end(); ar++){
+		const std::map<InternId, Measure>& measures = ar->second.getMeasuresById();
+		for (auto it = measures.begin(); it != measures.end(); it++){
+			const Measure& measure = it->second;
+			Partition& partition = unsorted[it->first];
+			if (partition.values.empty()){
+				partition.measure = it->first;
+				partition.label = measure.getLabelId();
+			}
+
+			for (auto yearValue : measure){
+				partition.years.push_back(yearValue.first);
+				partition.areas.push_back(ar->first);
+				partition.values.push_back(yearValue.second);
+			}
+		}
+	}
+
+	//sort each partition by year, then area
+	partitions.reserve(unsorted.size());
+	for (auto it = unsorted.begin(); it != unsorted.end(); it++){
+		Partition& from = it->second;
+		std::vector<size_t> order(from.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			if (from.years[a] != from.years[b]){
+				return from.years[a] < from.years[b];
+			}
+			return from.areas[a] < from.areas[b];
+		});
+
+		Partition to;
+		to.measure = from.measure;
+		to.label = from.label;
+		to.years.reserve(order.size());
+		to.areas.reserve(order.size());
+		to.values.reserve(order.size());
+		for (size_t i : order){
+			to.years.push_back(from.years[i]);
+			to.areas.push_back(from.areas[i]);
+			to.values.push_back(from.values[i]);
+		}
+		facts += to.size();
+		partitions.push_back(std::move(to));
+	}
+}
+
+//Returns the total number of facts in the table
+size_t FactTable::size() const noexcept {
+	return facts;
+}
+
+//Returns all the partitions, ordered by the ID of their measure
+const std::vector<FactTable::Partition>& FactTable::getPartitions() const noexcept {
+	return partitions;
+}
+
+/*
+  FactTable::findPartition(measure)
+
+  Find the partition for a measure.
+
+  @param measure
+    The ID of the lowercase measure codename
+
+  @return
+    Pointer to the partition, or nullptr if there are no facts for the
+    measure
+*/
+const FactTable::Partition* FactTable::findPartition(InternId measure) const noexcept {
+	auto it = std::lower_bound(partitions.begin(), partitions.end(), measure,
+			[](const Partition& partition, InternId id) {
+		return partition.measure < id;
+	});
+	if (it == partitions.end() || it->measure != measure){
+		return nullptr;
+	}
+	return &*it;
+}
+
+/*
+  FactTable::getPartition(measure)
+
+  Retrieve the partition for a measure. The codename is case insensitive.
+
+  @param measure
+    The measure codename
+
+  @return
+    The partition
+
+  @throws
+    std::out_of_range if there are no facts for the measure, with the message
+    No measure found matching <codename>
+
+  @example
+    FactTable table = areas.toFactTable();
+    auto& pop = table.getPartition("pop");
+*/
+const FactTable::Partition& FactTable::getPartition(const std::string& measure) const {
+	InternId id;
+	const Partition* partition = nullptr;
+	std::string lower = measure;
+	for (size_t i = 0; i < lower.length(); i++){
+		lower[i] = InternTable::toLower(lower[i]);
+	}
+	if (InternTable::global().find(lower, id)){
+		partition = findPartition(id);
+	}
+	if (partition == nullptr){
+		throw std::out_of_range("No measure found matching " + lower);
+	}
+	return *partition;
+}
+
+/*
+  FactTable::count(measure, year)
+
+  Count the areas that have a value for a measure in a year.
+
+  @param measure
+    The measure codename
+
+  @param year
+    The year
+
+  @return
+    The number of values
+
+  @throws
+    std::out_of_range if there are no facts for the measure
+*/
+size_t FactTable::count(const std::string& measure, int year) const {
+	auto range = getPartition(measure).yearRange(year);
+	return range.second - range.first;
+}
+
+/*
+  FactTable::sum(measure, year)
+
+  Add up the values for a measure in a year across all areas.
+
+  @param measure
+    The measure codename
+
+  @param year
+    The year
+
+  @return
+    The total, or 0 if there are no values for the year
+
+  @throws
+    std::out_of_range if there are no facts for the measure
+
+  @example
+    FactTable table = areas.toFactTable();
+    double population = table.sum("pop", 2015);
+*/
+double FactTable::sum(const std::string& measure, int year) const {
+	const Partition& partition = getPartition(measure);
+	auto range = partition.yearRange(year);
+	const double* values = partition.values.data();
+	double total = 0;
+	for (size_t i = range.first; i < range.second; i++){
+		total += values[i];
+	}
+	return total;
+}
+
+/*
+  FactTable::average(measure, year)
+
+  Calculate the mean value for a measure in a year across all areas.
+
+  @param measure
+    The measure codename
+
+  @param year
+    The year
+
+  @return
+    The mean, or 0 if there are no values for the year
+
+  @throws
+    std::out_of_range if there are no facts for the measure
+
+  @example
+    FactTable table = areas.toFactTable();
+    double population = table.average("pop", 2015);
+*/
+double FactTable::average(const std::string& measure, int year) const {
+	size_t values = count(measure, year);
+	if (values == 0){
+		return 0;
+	}
+	return sum(measure, year) / values;
+}
@@ -0,0 +1,70 @@
+#ifndef FACTS_H_
+#define FACTS_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the FactTable class, a columnar copy
+  of the values in an Areas instance. Areas stores values as a tree (Areas ->
+  Area -> Measure), which suits looking up one area at a time. Questions that
+  cut across areas, such as the average population of all areas in 2015,
+  would have to walk the whole tree; a FactTable answers them by scanning a
+  few contiguous arrays instead.
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "areas.h"
+#include "intern.h"
+
+/*
+  Every value (fact) in an Areas instance, as parallel arrays of area ID,
+  year and value. Facts are partitioned by measure, and sorted by year and
+  then area within each partition, so all the values for a measure, or for
+  one year of a measure, are next to each other in memory.
+
+  A FactTable is a snapshot: it does not change if the Areas instance it was
+  built from is modified afterwards.
+*/
+class FactTable {
+public:
+  /*
+    The facts for a single measure. Element i of each array belongs to the
+    same fact.
+  */
+  struct Partition {
+    InternId measure;
+    InternId label;
+    std::vector<int> years;
+    std::vector<InternId> areas;
+    std::vector<double> values;
+
+    size_t size() const noexcept;
+    std::pair<size_t, size_t> yearRange(int year) const noexcept;
+  };
+
+private:
+  std::vector<Partition> partitions;
+  size_t facts;
+
+public:
+  FactTable();
+  explicit FactTable(const AreasContainer& areas);
+
+  size_t size() const noexcept;
+  const std::vector<Partition>& getPartitions() const noexcept;
+  const Partition* findPartition(InternId measure) const noexcept;
+  const Partition& getPartition(const std::string& measure) const;
+
+  size_t count(const std::string& measure, int year) const;
+  double sum(const std::string& measure, int year) const;
+  double average(const std::string& measure, int year) const;
+};
+
+#endif // FACTS_H_
@@ -0,0 +1,369 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the RecordFilter class.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "filter.h"
+
+namespace {
+
+//Sets the bit for id in bits, growing bits as needed
+void setBit(std::vector<uint64_t>& bits, InternId id) {
+	if (id / 64 >= bits.size()){
+		bits.resize(id / 64 + 1, 0);
+	}
+	bits[id / 64] |= uint64_t(1) << (id % 64);
+}
+
+//True if the bit for id is set in bits
+inline bool testBit(const std::vector<uint64_t>& bits, InternId id) noexcept {
+	return id / 64 < bits.size() && ((bits[id / 64] >> (id % 64)) & 1);
+}
+
+//True if id is in InternTable::global() and its string matches matcher
+bool matchesId(const PatternMatcher& matcher, InternId id) {
+	InternTable& strings = InternTable::global();
+	return id < strings.size() && matcher.matches(strings.lookup(id));
+}
+
+} // namespace
+
+/*
+  PatternMatcher::PatternMatcher(foldCase)
+
+  Construct a matcher with no codes or patterns, which matches nothing.
+
+  @param foldCase
+    True if codes should be matched case-insensitively
+
+  @example
+    PatternMatcher measures(true);
+    measures.insert("pm*");
+    measures.matches("PM10"); // true
+*/
+PatternMatcher::PatternMatcher(bool _foldCase)
+    : nodes(1, Node{{}, false, false, {}}), foldCase(_foldCase), patterns(false) {
+}
+
+//Returns c in lowercase if the matcher ignores case
+inline char PatternMatcher::fold(char c) const noexcept {
+	return foldCase ? InternTable::toLower(c) : c;
+}
+
+/*
+  PatternMatcher::insert(pattern)
+
+  Add a code, or a pattern in which * matches any run of characters and ?
+  matches any one character.
+
+  @param pattern
+    The code or pattern, e.g. "W06000011", "W06*" or "W0?000011"
+*/
+void PatternMatcher::insert(std::string_view pattern) {
+	const size_t wildcard = std::min(pattern.find_first_of("*?"), pattern.size());
+
+	uint32_t node = 0;
+	for (size_t i = 0; i < wildcard; i++){
+		const char c = fold(pattern[i]);
+		auto& children = nodes[node].children;
+		auto it = std::lower_bound(children.begin(), children.end(), c,
+				[](const std::pair<char, uint32_t>& child, char value) {
+					return child.first < value;
+				});
+		if (it != children.end() && it->first == c){
+			node = it->second;
+		} else {
+			const uint32_t child = static_cast<uint32_t>(nodes.size());
+			children.insert(it, std::make_pair(c, child));
+			//children may have moved, so it is not used after this
+			nodes.push_back(Node{{}, false, false, {}});
+			node = child;
+		}
+	}
+
+	if (wildcard == pattern.size()){
+		nodes[node].code = true;
+		return;
+	}
+
+	patterns = true;
+	if (pattern.find_first_not_of('*', wildcard) == std::string_view::npos){
+		nodes[node].prefix = true;
+		return;
+	}
+	std::string tail(pattern.substr(wildcard));
+	for (size_t i = 0; i < tail.length(); i++){
+		tail[i] = fold(tail[i]);
+	}
+	nodes[node].tails.push_back(static_cast<uint32_t>(tails.size()));
+	tails.push_back(std::move(tail));
+}
+
+/*
+  PatternMatcher::matches(code)
+
+  @param code
+    A code, e.g. a view of a cell in a CSV file
+
+  @return
+    True if the code is one of the codes or matches one of the patterns
+*/
+bool PatternMatcher::matches(std::string_view code) const noexcept {
+	uint32_t node = 0;
+	for (size_t i = 0; ; i++){
+		const Node& current = nodes[node];
+		if (current.prefix){
+			return true;
+		}
+		for (uint32_t tail : current.tails){
+			if (matchTail(tails[tail], code.substr(i))){
+				return true;
+			}
+		}
+		if (i == code.size()){
+			return current.code;
+		}
+
+		const char c = fold(code[i]);
+		auto it = current.children.begin();
+		while (it != current.children.end() && it->first < c){
+			it++;
+		}
+		if (it == current.children.end() || it->first != c){
+			return false;
+		}
+		node = it->second;
+	}
+}
+
+/*
+  Match the rest of a code against the rest of a pattern, from its first
+  wildcard. On a mismatch after a *, the * is made to match one more
+  character and matching carries on from there.
+*/
+bool PatternMatcher::matchTail(std::string_view tail, std::string_view code) const noexcept {
+	size_t t = 0, c = 0;
+	size_t star = std::string_view::npos, starCode = 0;
+	while (c < code.size()){
+		if (t < tail.size() && (tail[t] == '?' || tail[t] == fold(code[c]))){
+			t++;
+			c++;
+		} else if (t < tail.size() && tail[t] == '*'){
+			star = t++;
+			starCode = c;
+		} else if (star != std::string_view::npos){
+			t = star + 1;
+			c = ++starCode;
+		} else {
+			return false;
+		}
+	}
+	while (t < tail.size() && tail[t] == '*'){
+		t++;
+	}
+	return t == tail.size();
+}
+
+//Returns true if nothing has been inserted
+bool PatternMatcher::empty() const noexcept {
+	const Node& root = nodes[0];
+	return root.children.empty() && !root.code && !root.prefix && root.tails.empty();
+}
+
+//Returns true if a pattern matches every code, e.g. "*"
+bool PatternMatcher::matchesAll() const noexcept {
+	return nodes[0].prefix;
+}
+
+//Returns true if anything other than an exact code has been inserted
+bool PatternMatcher::hasPatterns() const noexcept {
+	return patterns;
+}
+
+/*
+  PatternMatcher::isPattern(pattern)
+
+  @param pattern
+    A value from an area or measure filter
+
+  @return
+    True if the value has a wildcard in it, rather than being a code
+*/
+bool PatternMatcher::isPattern(std::string_view pattern) noexcept {
+	return pattern.find_first_of("*?") != std::string_view::npos;
+}
+
+/*
+  RecordFilter::RecordFilter(areasFilter, measuresFilter, yearsFilter)
+
+  Prepare the filters for an import.
+
+  @param areasFilter
+    An umodifiable pointer to set of umodifiable strings of areas (or
+    patterns of them) to import, or an empty set/nullptr if all areas
+    should be imported
+
+  @param measuresFilter
+    An umodifiable pointer to set of umodifiable strings of measures (or
+    patterns of them) to import, or an empty set/nullptr if all measures
+    should be imported
+
+  @param yearsFilter
+    An umodifiable pointer to an umodifiable tuple of two unsigned integers,
+    or nullptr if all years should be imported
+
+  @example
+    StringFilterSet areasFilter = {"W06000024", "W07*"};
+    StringFilterSet measuresFilter = {"Pop", "pm*"};
+    YearFilterTuple yearsFilter = {2015, 2015};
+    RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+*/
+RecordFilter::RecordFilter(const StringFilterSet * const areasFilter,
+                           const StringFilterSet * const measuresFilter,
+                           const YearFilterTuple * const yearsFilter)
+    : areas(false),
+      measures(true),
+      allAreas(true),
+      allMeasures(true),
+      knownIds(0),
+      firstYear(0),
+      yearCount(uint64_t(std::numeric_limits<unsigned int>::max()) + 1) {
+	//codes are only looked up, never added, so a filter (e.g. one per --serve
+	//query) cannot grow the table; a code that is added later gets an ID from
+	//knownIds on, and is matched by its string instead
+	InternTable& strings = InternTable::global();
+	knownIds = static_cast<InternId>(strings.size());
+	InternId id;
+
+	if (areasFilter != nullptr){
+		for (auto it = areasFilter->begin(); it != areasFilter->end(); it++){
+			areas.insert(*it);
+			if (!PatternMatcher::isPattern(*it) && strings.find(*it, id)){
+				setBit(areaIds, id);
+			}
+		}
+		allAreas = areas.empty() || areas.matchesAll();
+	}
+
+	if (measuresFilter != nullptr){
+		for (auto it = measuresFilter->begin(); it != measuresFilter->end(); it++){
+			measures.insert(*it);
+			std::string lower = *it;
+			for (size_t i = 0; i < lower.length(); i++){
+				lower[i] = InternTable::toLower(lower[i]);
+			}
+			if (!PatternMatcher::isPattern(lower) && strings.find(lower, id)){
+				setBit(measureIds, id);
+			}
+		}
+		allMeasures = measures.empty() || measures.matchesAll();
+	}
+
+	//the IDs that match a pattern are found once, here, so that testing one
+	//from before the filter was built is a bit lookup like any other
+	const bool areaPatterns = !allAreas && areas.hasPatterns();
+	const bool measurePatterns = !allMeasures && measures.hasPatterns();
+	if (areaPatterns || measurePatterns){
+		strings.forEach(knownIds, [&](InternId id, const std::string& str) {
+			if (areaPatterns && areas.matches(str)){
+				setBit(areaIds, id);
+			}
+			if (measurePatterns && measures.matches(str)){
+				setBit(measureIds, id);
+			}
+		});
+	}
+
+	if (yearsFilter != nullptr
+			&& std::get<0>(*yearsFilter) != 0 && std::get<1>(*yearsFilter) != 0){
+		firstYear = std::get<0>(*yearsFilter);
+		//a range the wrong way round keeps nothing
+		yearCount = std::get<1>(*yearsFilter) < firstYear
+				? 0 : uint64_t(std::get<1>(*yearsFilter)) - firstYear + 1;
+	}
+}
+
+/*
+  RecordFilter::keepArea(code)
+
+  @param code
+    A local authority code, e.g. a view of a cell in a CSV file
+
+  @return
+    true if records for the area should be imported
+*/
+bool RecordFilter::keepArea(std::string_view code) const {
+	return allAreas || areas.matches(code);
+}
+
+/*
+  RecordFilter::keepArea(code)
+
+  As above, but for the ID of a local authority code in
+  InternTable::global(), e.g. the key of an Area in an Areas instance.
+
+  @param code
+    The ID of a local authority code
+
+  @return
+    true if records for the area should be imported
+*/
+bool RecordFilter::keepArea(InternId code) const {
+	return (allAreas | testBit(areaIds, code))
+			|| (code >= knownIds && matchesId(areas, code));
+}
+
+/*
+  RecordFilter::keepMeasure(code)
+
+  @param code
+    A measure codename in any case
+
+  @return
+    true if records for the measure should be imported
+*/
+bool RecordFilter::keepMeasure(std::string_view code) const {
+	return allMeasures || measures.matches(code);
+}
+
+/*
+  RecordFilter::keepMeasure(code)
+
+  As above, but for the ID of a lowercase measure codename in
+  InternTable::global(), e.g. the key of a Measure in an Area.
+
+  @param code
+    The ID of a lowercase measure codename
+
+  @return
+    true if records for the measure should be imported
+*/
+bool RecordFilter::keepMeasure(InternId code) const {
+	return (allMeasures | testBit(measureIds, code))
+			|| (code >= knownIds && matchesId(measures, code));
+}
+
+/*
+  RecordFilter::keepYear(year)
+
+  @param year
+    A year
+
+  @return
+    true if records for the year should be imported
+*/
+bool RecordFilter::keepYear(int year) const noexcept {
+	//years before firstYear wrap round to more than yearCount
+	return static_cast<unsigned int>(year) - firstYear < yearCount;
+}
@@ -0,0 +1,132 @@
+#ifndef FILTER_H_
+#define FILTER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the filter types passed to Areas::populate() and the
+  RecordFilter class, which the parsers use to test the raw text of a record
+  against those filters. Checking the raw text means a record that is going
+  to be thrown away is never converted to numbers or copied into strings.
+
+  Besides exact codes, the area and measure filters may hold glob patterns,
+  where * matches any run of characters and ? any one character, e.g.
+  "W06*" for every unitary authority or "pm*" for every measure starting
+  with pm. The filters are compiled once, into a PatternMatcher, and every
+  parser tests codes against that.
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "intern.h"
+
+/*
+  An alias for filters based on strings such as categorisations e.g. area,
+  and measures.
+*/
+using StringFilterSet = std::unordered_set<std::string>;
+
+/*
+  An alias for a year filter.
+*/
+using YearFilterTuple = std::tuple<unsigned int, unsigned int>;
+
+/*
+  A set of codes and glob patterns compiled into a trie, so that testing a
+  code walks it once whatever the number of patterns. Each node of the trie
+  records whether a code may end there and whether a prefix pattern ("W06*")
+  ends there, in which case any code that reaches it matches. The literal
+  start of any other pattern is walked in the same way and the rest of it
+  (from its first wildcard) is matched against the rest of the code.
+
+  If foldCase is set, patterns and codes are compared case-insensitively.
+  All functions are const and may be called from several threads at once.
+*/
+class PatternMatcher {
+private:
+	struct Node {
+		//sorted by character
+		std::vector<std::pair<char, uint32_t>> children;
+		bool code;
+		bool prefix;
+		//indexes into tails, of patterns whose literal start ends here
+		std::vector<uint32_t> tails;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<std::string> tails;
+	bool foldCase;
+	bool patterns;
+
+	char fold(char c) const noexcept;
+	bool matchTail(std::string_view tail, std::string_view code) const noexcept;
+public:
+  explicit PatternMatcher(bool foldCase = false);
+
+  void insert(std::string_view pattern);
+  bool matches(std::string_view code) const noexcept;
+  bool empty() const noexcept;
+  bool matchesAll() const noexcept;
+  bool hasPatterns() const noexcept;
+
+  static bool isPattern(std::string_view pattern) noexcept;
+};
+
+/*
+  The area, measure and year filters for an import, prepared so that they can
+  be tested against views into the input without creating any strings. An
+  empty or null filter keeps everything, as does a year filter with a 0 in
+  it. Measures are matched case-insensitively; areas are matched exactly.
+
+  The parsers test the raw text, before anything is interned, so a record
+  that is thrown away never adds to InternTable::global(). Data already
+  imported (when a query copies from the datasets loaded by --serve, or a
+  snapshot is read) refers to its codes by their ID in that table, so for
+  those the filters are also compiled into bitsets over the IDs, where
+  testing a code is a single bit lookup. The bits for patterns are filled
+  in by matching every string in the table once, when the filter is built.
+  Building a filter never adds to the table: a code added after it was
+  built is tested by looking up the string for its ID and matching that
+  instead. The year filter is held as the first year and the number of
+  years from it, so a year is tested with one subtraction and one
+  comparison.
+
+  All functions are const and may be called from several threads at once.
+*/
+class RecordFilter {
+private:
+	PatternMatcher areas;
+	PatternMatcher measures;
+	bool allAreas;
+	bool allMeasures;
+	std::vector<uint64_t> areaIds;
+	std::vector<uint64_t> measureIds;
+	//IDs from here on were added to the table after the filter was built
+	InternId knownIds;
+	unsigned int firstYear;
+	uint64_t yearCount;
+public:
+  RecordFilter(const StringFilterSet * const areasFilter,
+               const StringFilterSet * const measuresFilter,
+               const YearFilterTuple * const yearsFilter);
+  RecordFilter(const RecordFilter&) = delete;
+  RecordFilter& operator=(const RecordFilter&) = delete;
+
+  bool keepArea(std::string_view code) const;
+  bool keepArea(InternId code) const;
+  bool keepMeasure(std::string_view code) const;
+  bool keepMeasure(InternId code) const;
+  bool keepYear(int year) const noexcept;
+};
+
+#endif // FILTER_H_
@@ -0,0 +1,137 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains bethyw-gen, which writes synthetic datasets (see
+  generate.h) into a directory that Beth Yw? can then be pointed at with
+  --dir. Build and run it from the repository root:
+
+    ./build.sh gen
+    ./bin/bethyw-gen --out big -d popden,complete-pop --areas 100000
+    ./bin/bethyw --dir big -d popden,complete-pop --stats
+
+  areas.csv is always written too, so that every generated area has a name.
+*/
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../lib_cxxopts.hpp"
+
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../generate.h"
+
+namespace {
+
+//Writes one dataset into dir, returning the size of the file
+size_t generate(const std::string& dir,
+                const BethYw::InputFileSource& source,
+                const BethYw::GeneratorSettings& settings) {
+  const std::string path = dir + DIR_SEP + source.FILE;
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("bethyw-gen: Failed to write file " + path);
+  }
+  BethYw::DatasetGenerator(source, settings).write(file);
+  size_t size = static_cast<size_t>(file.tellp());
+  file.close();
+  if (!file) {
+    throw std::runtime_error("bethyw-gen: Failed to write file " + path);
+  }
+  return size;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  cxxopts::Options cxxopts(
+        "bethyw-gen",
+        "Writes synthetic datasets with the same columns as the real ones, for "
+        "benchmarks and load tests. The same arguments always give the same "
+        "files.\n");
+
+  cxxopts.add_options()(
+      "out",
+      "Directory to write the datasets to (created if it does not exist)",
+      cxxopts::value<std::string>()->default_value("generated"))(
+
+      "d,datasets",
+      "The dataset(s) to generate as a comma-separated list of codes "
+      "(omit or set to 'all' to generate all datasets)",
+      cxxopts::value<std::vector<std::string>>())(
+
+      "areas",
+      "Number of areas",
+      cxxopts::value<unsigned int>()->default_value("22"))(
+
+      "measures",
+      "Number of measures, for datasets with more than one",
+      cxxopts::value<unsigned int>()->default_value("3"))(
+
+      "y,years",
+      "Year (YYYY) or inclusive range of years (YYYY-ZZZZ) to generate "
+      "(omit for 1991-2019)",
+      cxxopts::value<std::string>()->default_value("0"))(
+
+      "duplicates",
+      "Chance (from 0 to less than 1) of each row being repeated with a "
+      "different value",
+      cxxopts::value<double>()->default_value("0"))(
+
+      "seed",
+      "Seed for the values",
+      cxxopts::value<uint64_t>()->default_value("1"))(
+
+      "h,help",
+      "Print usage.");
+
+  auto args = cxxopts.parse(argc, argv);
+  if (args.count("help")) {
+    std::cerr << cxxopts.help() << std::endl;
+    return 0;
+  }
+
+  BethYw::GeneratorSettings settings;
+  settings.areas      = args["areas"].as<unsigned int>();
+  settings.measures   = args["measures"].as<unsigned int>();
+  settings.duplicates = args["duplicates"].as<double>();
+  settings.seed       = args["seed"].as<uint64_t>();
+  auto years = BethYw::parseYearsArg(args);
+  if (years != std::make_tuple(0u, 0u)) {
+    std::tie(settings.firstYear, settings.lastYear) = years;
+    if (settings.firstYear == 0 || settings.lastYear == 0) {
+      throw std::invalid_argument("Invalid input for years argument");
+    }
+  }
+
+  const std::string dir = args["out"].as<std::string>();
+  std::error_code error;
+  std::filesystem::create_directories(dir, error);
+  if (error) {
+    throw std::runtime_error("bethyw-gen: Failed to create directory " + dir
+                             + ": " + error.message());
+  }
+  std::vector<BethYw::InputFileSource> sources = {BethYw::InputFiles::AREAS};
+  for (const auto& source : BethYw::parseDatasetsArg(args)) {
+    sources.push_back(source);
+  }
+
+  for (const auto& source : sources) {
+    size_t size = generate(dir, source, settings);
+    std::cerr << source.FILE << ": " << size << " bytes" << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,307 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the DatasetGenerator class. See
+  generate.h for details.
+*/
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#include "generate.h"
+#include "measure.h"
+
+namespace {
+
+//Bytes gathered before they are passed on to the stream
+const size_t BUFFER_SIZE = 1024 * 1024;
+
+/*
+  A small, fast pseudo-random number generator (SplitMix64), which gives the
+  same sequence for the same seed everywhere.
+*/
+class Random {
+private:
+	uint64_t state;
+public:
+	explicit Random(uint64_t seed) : state(seed) {}
+
+	uint64_t next() noexcept {
+		uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	//Returns a number in [0, 1)
+	double chance() noexcept {
+		return (next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+};
+
+//Mixes the dataset code into the seed, so each dataset gets its own values
+uint64_t seedFor(uint64_t seed, const std::string& code) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : code){
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+	}
+	return seed ^ hash;
+}
+
+//Looks up a column name, returning an empty string if the dataset lacks it
+std::string column(const BethYw::SourceColumnMapping& cols, BethYw::SourceColumn col) {
+	auto it = cols.find(col);
+	return it != cols.end() ? it->second : std::string();
+}
+
+//Passes the buffer on to the stream once it is full
+void flushIfFull(std::string& buffer, std::ostream& os) {
+	if (buffer.size() >= BUFFER_SIZE){
+		os.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+}
+
+void appendNumber(std::string& buffer, double value) {
+	char digits[32];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	buffer.append(digits, result.ptr - digits);
+}
+
+void appendNumber(std::string& buffer, uint64_t value) {
+	char digits[24];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	buffer.append(digits, result.ptr - digits);
+}
+
+//Appends "key": to a JSON object being written
+void appendKey(std::string& buffer, const std::string& key) {
+	buffer += '"';
+	buffer += key;
+	buffer += "\":";
+}
+
+//Appends "key":"value" to a JSON object being written
+void appendString(std::string& buffer, const std::string& key, const std::string& value) {
+	appendKey(buffer, key);
+	buffer += '"';
+	buffer += value;
+	buffer += '"';
+}
+
+/*
+  A value for an area and measure: each pair gets a base value between 1 and
+  100,000, and each year varies around it by up to 10%. Values have three
+  decimal places, like the real data.
+*/
+double nextValue(Random& random, double base) {
+	double value = base * (0.9 + 0.2 * random.chance());
+	return std::round(value * 1000) / 1000;
+}
+
+double nextBase(Random& random) {
+	return 1 + std::floor(random.chance() * 100000);
+}
+
+} // namespace
+
+/*
+  BethYw::DatasetGenerator::DatasetGenerator(source, settings)
+
+  Construct a generator for a dataset.
+
+  @param source
+    The dataset to imitate, e.g. BethYw::InputFiles::POPDEN; it must outlive
+    the generator
+
+  @param settings
+    The number of areas, measures and years, the chance of duplicate rows,
+    and the seed
+
+  @throws
+    std::invalid_argument if the settings cannot be used for the dataset,
+    with the message: BethYw::DatasetGenerator: <reason>
+
+  @example
+    BethYw::GeneratorSettings settings;
+    settings.areas = 10000;
+    BethYw::DatasetGenerator generator(BethYw::InputFiles::POPDEN, settings);
+*/
+BethYw::DatasetGenerator::DatasetGenerator(const InputFileSource& _source,
+		const GeneratorSettings& _settings)
+		: source(_source), settings(_settings) {
+	if (source.PARSER == None){
+		throw std::invalid_argument("BethYw::DatasetGenerator: Unsupported dataset type");
+	}
+	if (settings.areas == 0){
+		throw std::invalid_argument("BethYw::DatasetGenerator: There must be at least one area");
+	}
+	if (settings.measures == 0){
+		throw std::invalid_argument("BethYw::DatasetGenerator: There must be at least one measure");
+	}
+	//the years must be ones the parsers accept, and fit in one Measure
+	if (settings.firstYear > settings.lastYear
+			|| settings.firstYear < (unsigned int) Measure::MIN_YEAR
+			|| settings.lastYear > (unsigned int) Measure::MAX_YEAR
+			|| settings.lastYear - settings.firstYear >= (unsigned int) Measure::MAX_YEAR_SPAN){
+		throw std::invalid_argument("BethYw::DatasetGenerator: Invalid range of years");
+	}
+	if (!(settings.duplicates >= 0 && settings.duplicates < 1)){
+		throw std::invalid_argument("BethYw::DatasetGenerator: The duplicate ratio must be at least 0 and less than 1");
+	}
+}
+
+/*
+  BethYw::DatasetGenerator::areaCode(index)
+
+  @param index
+    The number of the area, from 0
+
+  @return
+    The local authority code generated for it, e.g. W06000001 for 0
+
+  @example
+    BethYw::DatasetGenerator::areaCode(10);  // "W06000011"
+*/
+std::string BethYw::DatasetGenerator::areaCode(unsigned int index) {
+	std::string number = std::to_string(6000001ULL + index);
+	if (number.size() < 8){
+		number.insert(0, 8 - number.size(), '0');
+	}
+	return "W" + number;
+}
+
+/*
+  BethYw::DatasetGenerator::write(os)
+
+  Write the whole dataset to a stream. The file is produced as it is
+  written, through a buffer, so files much larger than memory can be made.
+
+  @param os
+    The stream to write to, e.g. a std::ofstream opened in binary mode
+
+  @example
+    std::ofstream file("big/popu1009.json", std::ios::binary);
+    generator.write(file);
+*/
+void BethYw::DatasetGenerator::write(std::ostream& os) const {
+	std::string buffer;
+	buffer.reserve(BUFFER_SIZE + 4096);
+	if (source.PARSER == AuthorityCodeCSV){
+		writeAreasCSV(buffer, os);
+	} else if (source.PARSER == WelshStatsJSON){
+		writeWelshStatsJSON(buffer, os);
+	} else {
+		writeAuthorityByYearCSV(buffer, os);
+	}
+	os.write(buffer.data(), buffer.size());
+	os.flush();
+}
+
+//Writes an areas.csv with an English and Welsh name for every area
+void BethYw::DatasetGenerator::writeAreasCSV(std::string& buffer, std::ostream& os) const {
+	buffer += column(source.COLS, AUTH_CODE) + "," + column(source.COLS, AUTH_NAME_ENG)
+			+ "," + column(source.COLS, AUTH_NAME_CYM) + "\n";
+	for (unsigned int area = 0; area < settings.areas; area++){
+		std::string number = std::to_string(area + 1);
+		buffer += areaCode(area) + ",Area " + number + ",Ardal " + number + "\n";
+		flushIfFull(buffer, os);
+	}
+}
+
+/*
+  Writes a StatsWales export: a "value" array with a row for each area,
+  measure and year, in that order, like the real files. Each row also has a
+  RowKey, which the parser ignores, as real rows have several such columns.
+*/
+void BethYw::DatasetGenerator::writeWelshStatsJSON(std::string& buffer, std::ostream& os) const {
+	Random random(seedFor(settings.seed, source.CODE));
+	const std::string codeCol = column(source.COLS, AUTH_CODE);
+	const std::string nameCol = column(source.COLS, AUTH_NAME_ENG);
+	const std::string measureCodeCol = column(source.COLS, MEASURE_CODE);
+	const std::string measureNameCol = column(source.COLS, MEASURE_NAME);
+	const std::string yearCol = column(source.COLS, YEAR);
+	const std::string valueCol = column(source.COLS, VALUE);
+	const bool singleMeasure = source.COLS.count(SINGLE_MEASURE_CODE) > 0;
+	const unsigned int measures = singleMeasure ? 1 : settings.measures;
+
+	buffer += "{\"odata.metadata\":\"generated by bethyw-gen\",\"value\":[";
+	uint64_t rowKey = 0;
+	for (unsigned int area = 0; area < settings.areas; area++){
+		const std::string code = areaCode(area);
+		const std::string name = "Area " + std::to_string(area + 1);
+		for (unsigned int measure = 0; measure < measures; measure++){
+			const std::string number = std::to_string(measure + 1);
+			const double base = nextBase(random);
+			for (unsigned int year = settings.firstYear; year <= settings.lastYear; year++){
+				//a duplicate row repeats the area, measure and year with a new value
+				bool repeat = true;
+				while (repeat){
+					buffer += rowKey == 0 ? "\n{" : ",\n{";
+					appendKey(buffer, valueCol);
+					appendNumber(buffer, nextValue(random, base));
+					buffer += ',';
+					appendString(buffer, codeCol, code);
+					if (!nameCol.empty()){
+						buffer += ',';
+						appendString(buffer, nameCol, name);
+					}
+					if (!singleMeasure){
+						buffer += ',';
+						appendString(buffer, measureCodeCol, source.CODE + "-m" + number);
+						if (measureNameCol != measureCodeCol){
+							buffer += ',';
+							appendString(buffer, measureNameCol, source.NAME + " " + number);
+						}
+					}
+					buffer += ',';
+					appendString(buffer, yearCol, std::to_string(year));
+					buffer += ',';
+					appendKey(buffer, "RowKey");
+					buffer += '"';
+					appendNumber(buffer, rowKey++);
+					buffer += "\"}";
+					flushIfFull(buffer, os);
+					repeat = settings.duplicates > 0 && random.chance() < settings.duplicates;
+				}
+			}
+		}
+	}
+	buffer += "\n]}\n";
+}
+
+//Writes a CSV file with a row for each area and a column for each year
+void BethYw::DatasetGenerator::writeAuthorityByYearCSV(std::string& buffer, std::ostream& os) const {
+	Random random(seedFor(settings.seed, source.CODE));
+	buffer += column(source.COLS, AUTH_CODE);
+	for (unsigned int year = settings.firstYear; year <= settings.lastYear; year++){
+		buffer += ',';
+		buffer += std::to_string(year);
+	}
+	buffer += '\n';
+
+	for (unsigned int area = 0; area < settings.areas; area++){
+		const std::string code = areaCode(area);
+		const double base = nextBase(random);
+		//a duplicate row repeats the area with new values
+		bool repeat = true;
+		while (repeat){
+			buffer += code;
+			for (unsigned int year = settings.firstYear; year <= settings.lastYear; year++){
+				buffer += ',';
+				appendNumber(buffer, nextValue(random, base));
+			}
+			buffer += '\n';
+			flushIfFull(buffer, os);
+			repeat = settings.duplicates > 0 && random.chance() < settings.duplicates;
+		}
+	}
+}
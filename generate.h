@@ -0,0 +1,67 @@
+#ifndef GENERATE_H_
+#define GENERATE_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the DatasetGenerator class, which
+  writes synthetic datasets shaped like the ones in datasets.h, but as large
+  as we like, for benchmarks and load tests. See gen/main.cpp for the
+  bethyw-gen tool built on it.
+
+  A generated file uses the column names of an InputFileSource, so Beth Yw?
+  reads it exactly like the real file. The content is made up: areas are
+  numbered W06000001, W06000002, ..., measures are named after the dataset
+  (e.g. popden-m1, popden-m2, ...) so that datasets do not overwrite each
+  other, and the values are pseudo-random. The same settings always give the same bytes, on any
+  platform, as the random numbers come from our own generator rather than
+  from the Standard Library's distributions.
+ */
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "datasets.h"
+
+namespace BethYw {
+
+/*
+  What to generate. duplicates is the chance (at least 0, less than 1) that
+  a row is followed by a second row for the same area, measure and year with
+  another value, which the parsers must let replace the first, as in the
+  real files. measures is ignored for datasets with a single measure.
+*/
+struct GeneratorSettings {
+  unsigned int areas = 22;
+  unsigned int measures = 3;
+  unsigned int firstYear = 1991;
+  unsigned int lastYear = 2019;
+  double duplicates = 0;
+  uint64_t seed = 1;
+};
+
+class DatasetGenerator {
+private:
+	const InputFileSource& source;
+	GeneratorSettings settings;
+
+	void writeAreasCSV(std::string& buffer, std::ostream& os) const;
+	void writeWelshStatsJSON(std::string& buffer, std::ostream& os) const;
+	void writeAuthorityByYearCSV(std::string& buffer, std::ostream& os) const;
+public:
+  DatasetGenerator(const InputFileSource& source,
+                   const GeneratorSettings& settings);
+
+  void write(std::ostream& os) const;
+
+  static std::string areaCode(unsigned int index);
+};
+
+} // namespace BethYw
+
+#endif // GENERATE_H_
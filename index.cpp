@@ -0,0 +1,676 @@
+
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the code for building, writing and reading the sidecar
+  indexes of dataset files. See index.h for what an index holds and the
+  layout of the file.
+*/
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "csv.h"
+#include "index.h"
+#include "measure.h"
+#include "statswales.h"
+#include "summary.h"
+
+namespace {
+
+const char INDEX_MAGIC[8] = {'B', 'Y', 'W', 'I', 'N', 'D', 'E', 'X'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+/*
+  An index is only used if the runs it selects are at most this share of
+  the records in the file; for anything wider, reading the whole file in
+  order (perhaps on several threads) is as quick.
+*/
+const double MAX_SELECTED_SHARE = 0.5;
+
+struct IndexHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t type;
+	uint32_t stringCount;
+	uint64_t runCount;
+	uint64_t fileSize;
+	int64_t modified;
+	uint64_t headerSize;
+	uint64_t stringBytes;
+	int32_t firstYear;
+	int32_t lastYear;
+};
+
+//Gives each string in an index a number, in the order they are first seen
+class IndexStrings {
+private:
+	std::vector<std::string>& strings;
+	std::unordered_map<std::string, uint32_t> indexes;
+public:
+	IndexStrings(std::vector<std::string>& strings) : strings(strings) {}
+
+	uint32_t index(const std::string& value) {
+		auto it = indexes.try_emplace(value, (uint32_t) strings.size());
+		if (it.second){
+			strings.push_back(value);
+		}
+		return it.first->second;
+	}
+};
+
+//Copies columns out of an index file, checking each one is in bounds
+class IndexReader {
+private:
+	std::string_view buffer;
+	size_t pos;
+public:
+	IndexReader(std::string_view buffer) : buffer(buffer), pos(0) {}
+
+	template <typename T>
+	void column(std::vector<T>& values, uint64_t count) {
+		if (count > (buffer.size() - pos) / sizeof(T)){
+			throw std::runtime_error("BethYw::DatasetIndex::read: Truncated index");
+		}
+		values.resize(count);
+		std::memcpy(values.data(), buffer.data() + pos, count * sizeof(T));
+		pos += count * sizeof(T);
+	}
+
+	std::string_view bytes(uint64_t count) {
+		if (count > buffer.size() - pos){
+			throw std::runtime_error("BethYw::DatasetIndex::read: Truncated index");
+		}
+		std::string_view view = buffer.substr(pos, count);
+		pos += count;
+		return view;
+	}
+};
+
+template <typename T>
+void writeColumn(std::ostream& os, const std::vector<T>& values) {
+	os.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/*
+  Returns a name next to path for writing it under, which no other writer
+  (another thread, or another bethyw process such as a --serve daemon) will
+  pick, so that two writers never truncate or mix each other's files.
+*/
+std::string partialPathFor(const std::string& path) {
+	static std::atomic<uint64_t> counter(0);
+	static const uint64_t random = (uint64_t(std::random_device()()) << 32)
+			^ std::random_device()();
+	std::ostringstream name;
+	name << path << '.' << std::hex << random << '-' << counter++ << ".part";
+	return name.str();
+}
+
+/*
+  Writes an index or summary to path, under another name first and then
+  renamed, so that no import ever sees half a file. If it cannot be written
+  (e.g. the directory is read-only) nothing is, and it is built again next
+  time.
+*/
+template <typename T>
+void writeSidecar(const std::string& path, const T& sidecar) {
+	std::error_code error;
+	const std::string partialPath = partialPathFor(path);
+	std::ofstream file(partialPath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()){
+		return;
+	}
+	sidecar.write(file);
+	file.close();
+	if (file){
+		std::filesystem::rename(partialPath, path, error);
+	}
+	if (!file || error){
+		std::filesystem::remove(partialPath, error);
+	}
+}
+
+} // namespace
+
+BethYw::DatasetIndex::DatasetIndex()
+		: type(None), fileSize(0), modified(0), headerSize(0), firstYear(0), lastYear(0) {
+}
+
+/*
+  Add a record to the index, extending the last run if the record is for the
+  same area and measure.
+*/
+void BethYw::DatasetIndex::addRun(uint64_t start, uint64_t end, uint32_t area,
+		uint32_t measure) {
+	if (!starts.empty() && runAreas.back() == area && runMeasures.back() == measure){
+		ends.back() = end;
+		return;
+	}
+	starts.push_back(start);
+	ends.push_back(end);
+	runAreas.push_back(area);
+	runMeasures.push_back(measure);
+}
+
+//Widen the range of years to include year
+void BethYw::DatasetIndex::addYear(int year) noexcept {
+	if (firstYear == 0 || year < firstYear){
+		firstYear = year;
+	}
+	if (lastYear == 0 || year > lastYear){
+		lastYear = year;
+	}
+}
+
+//The distinct strings referred to by a column of runs, in order of first use
+std::vector<std::string_view> BethYw::DatasetIndex::codes(
+		const std::vector<uint32_t>& runCodes) const {
+	std::vector<char> seen(strings.size(), false);
+	std::vector<std::string_view> found;
+	for (uint32_t code : runCodes){
+		if (code != NO_MEASURE && !seen[code]){
+			seen[code] = true;
+			found.push_back(strings[code]);
+		}
+	}
+	return found;
+}
+
+/*
+  BethYw::DatasetIndex::build(contents, source, modified)
+
+  Build the index of a dataset file by reading every record in it once. For
+  a StatsWales export each row is parsed on its own, with the same column
+  mapping as an import, so the codes in the index are the ones the import
+  would see. Rows without a value are left in the run before them, as the
+  parser skips them anyway.
+
+  @param contents
+    The contents of the file
+
+  @param source
+    The dataset the file holds, e.g. BethYw::InputFiles::POPDEN
+
+  @param modified
+    The modification time of the file, to be checked by isFor()
+
+  @return
+    The index
+
+  @throws
+    std::runtime_error if the file is malformed
+    std::out_of_range if there are not enough columns in source.COLS
+    std::invalid_argument if the dataset type cannot be indexed
+
+  @example
+    InputMmapFile input("datasets/popu1009.json");
+    auto index = BethYw::DatasetIndex::build(input.open(),
+        BethYw::InputFiles::POPDEN, 0);
+*/
+BethYw::DatasetIndex BethYw::DatasetIndex::build(std::string_view contents,
+		const InputFileSource& source,
+		int64_t modified) {
+	DatasetIndex index;
+	index.type = source.PARSER;
+	index.fileSize = contents.size();
+	index.modified = modified;
+	IndexStrings strings(index.strings);
+	strings.index(source.CODE);
+
+	if (source.PARSER == WelshStatsJSON){
+		scanWelshStatsRows(contents, [&](size_t offset, std::string_view row) {
+			bool found = false;
+			uint32_t area = 0;
+			uint32_t measure = 0;
+			parseWelshStatsRecords(row, source.COLS,
+					[&](const WelshStatsRecord& record) {
+				area = strings.index(record.authCode);
+				measure = strings.index(record.measureCode);
+				index.addYear(record.year);
+				found = true;
+			});
+			if (found){
+				index.addRun(offset, offset + row.size(), area, measure);
+			} else if (!index.ends.empty()){
+				index.ends.back() = offset + row.size();
+			}
+		});
+		return index;
+	}
+
+	uint32_t measure = NO_MEASURE;
+	if (source.PARSER == AuthorityByYearCSV){
+		measure = strings.index(source.COLS.at(SINGLE_MEASURE_CODE));
+	} else if (source.PARSER != AuthorityCodeCSV){
+		throw std::invalid_argument("BethYw::DatasetIndex::build: Unsupported dataset type");
+	}
+
+	//both CSV parsers take the area from the first cell and skip rows without one
+	CSVReader reader(contents);
+	std::vector<std::string_view> cells;
+	reader.nextRow(cells);
+	index.headerSize = reader.position();
+	if (source.PARSER == AuthorityByYearCSV){
+		//the columns after the first are years, although not every cell has a value
+		for (size_t i = 1; i < cells.size(); i++){
+			int year;
+			if (CSVReader::toInt(cells[i], year) && Measure::isValidYear(year)){
+				index.addYear(year);
+			}
+		}
+	}
+	size_t start = reader.position();
+	while (reader.nextRow(cells)){
+		size_t end = reader.position();
+		if (!cells[0].empty()){
+			index.addRun(start, end, strings.index(std::string(cells[0])), measure);
+		}
+		start = end;
+	}
+	return index;
+}
+
+/*
+  BethYw::DatasetIndex::read(buffer)
+
+  Read an index written by write().
+
+  @param buffer
+    The contents of the index file
+
+  @return
+    The index
+
+  @throws
+    std::runtime_error if the buffer is not a valid index from this version
+    of Beth Yw? on a machine with the same byte order
+
+  @example
+    std::ifstream file("datasets/popu1009.json.idx", std::ios::binary);
+    std::string contents(std::istreambuf_iterator<char>(file), {});
+    auto index = BethYw::DatasetIndex::read(contents);
+*/
+BethYw::DatasetIndex BethYw::DatasetIndex::read(std::string_view buffer) {
+	IndexHeader header;
+	if (buffer.size() < sizeof(header)){
+		throw std::runtime_error("BethYw::DatasetIndex::read: Truncated index");
+	}
+	std::memcpy(&header, buffer.data(), sizeof(header));
+	if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0){
+		throw std::runtime_error("BethYw::DatasetIndex::read: Not an index");
+	}
+	if (header.version != INDEX_VERSION){
+		throw std::runtime_error("BethYw::DatasetIndex::read: Unsupported index version");
+	}
+	if (header.byteOrder != BYTE_ORDER_MARK){
+		throw std::runtime_error("BethYw::DatasetIndex::read: Index has the wrong byte order");
+	}
+
+	DatasetIndex index;
+	index.type = static_cast<SourceDataType>(header.type);
+	index.fileSize = header.fileSize;
+	index.modified = header.modified;
+	index.headerSize = header.headerSize;
+	index.firstYear = header.firstYear;
+	index.lastYear = header.lastYear;
+
+	IndexReader reader(buffer.substr(sizeof(header)));
+	std::vector<uint32_t> offsets;
+	reader.column(offsets, (uint64_t) header.stringCount + 1);
+	std::string_view characters = reader.bytes(header.stringBytes);
+	if (offsets.front() != 0 || offsets.back() != header.stringBytes){
+		throw std::runtime_error("BethYw::DatasetIndex::read: Corrupt index");
+	}
+	for (uint32_t i = 0; i < header.stringCount; i++){
+		if (offsets[i + 1] < offsets[i]){
+			throw std::runtime_error("BethYw::DatasetIndex::read: Corrupt index");
+		}
+		index.strings.emplace_back(characters.substr(offsets[i], offsets[i + 1] - offsets[i]));
+	}
+
+	reader.column(index.starts, header.runCount);
+	reader.column(index.ends, header.runCount);
+	reader.column(index.runAreas, header.runCount);
+	reader.column(index.runMeasures, header.runCount);
+	for (size_t i = 0; i < header.runCount; i++){
+		if (index.starts[i] > index.ends[i] || index.ends[i] > index.fileSize
+				|| index.runAreas[i] >= header.stringCount
+				|| (index.runMeasures[i] >= header.stringCount
+						&& index.runMeasures[i] != NO_MEASURE)){
+			throw std::runtime_error("BethYw::DatasetIndex::read: Corrupt index");
+		}
+	}
+	if (index.strings.empty() || index.headerSize > index.fileSize){
+		throw std::runtime_error("BethYw::DatasetIndex::read: Corrupt index");
+	}
+	return index;
+}
+
+/*
+  BethYw::DatasetIndex::write(os)
+
+  Write the index to a stream, to be read again with read().
+
+  @param os
+    The stream to write to, which should be opened in binary mode
+
+  @example
+    std::ofstream file("datasets/popu1009.json.idx", std::ios::binary);
+    index.write(file);
+*/
+void BethYw::DatasetIndex::write(std::ostream& os) const {
+	std::vector<uint32_t> offsets{0};
+	std::string characters;
+	for (const std::string& value : strings){
+		characters += value;
+		offsets.push_back((uint32_t) characters.size());
+	}
+
+	IndexHeader header = {};
+	std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+	header.version = INDEX_VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.type = (uint32_t) type;
+	header.stringCount = (uint32_t) strings.size();
+	header.runCount = starts.size();
+	header.fileSize = fileSize;
+	header.modified = modified;
+	header.headerSize = headerSize;
+	header.stringBytes = characters.size();
+	header.firstYear = firstYear;
+	header.lastYear = lastYear;
+
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	writeColumn(os, offsets);
+	os.write(characters.data(), characters.size());
+	writeColumn(os, starts);
+	writeColumn(os, ends);
+	writeColumn(os, runAreas);
+	writeColumn(os, runMeasures);
+}
+
+/*
+  BethYw::DatasetIndex::isFor(source, size, modified)
+
+  @param source
+    The dataset being imported
+
+  @param size
+    The size of the file being imported
+
+  @param modified
+    The modification time of the file being imported
+
+  @return
+    true if the index was built for this dataset from a file with the same
+    size and modification time
+*/
+bool BethYw::DatasetIndex::isFor(const InputFileSource& source,
+		uint64_t size,
+		int64_t _modified) const noexcept {
+	return type == source.PARSER && strings.front() == source.CODE
+			&& fileSize == size && modified == _modified;
+}
+
+//The code of the dataset the index was built for, e.g. popden
+const std::string& BethYw::DatasetIndex::getCode() const noexcept {
+	return strings.front();
+}
+
+BethYw::SourceDataType BethYw::DatasetIndex::getType() const noexcept {
+	return type;
+}
+
+uint64_t BethYw::DatasetIndex::getFileSize() const noexcept {
+	return fileSize;
+}
+
+int64_t BethYw::DatasetIndex::getModified() const noexcept {
+	return modified;
+}
+
+/*
+  BethYw::DatasetIndex::getHeaderSize()
+
+  @return
+    The size of the header line of a CSV file, which must be read along with
+    any selected lines, or 0 for a StatsWales export
+*/
+uint64_t BethYw::DatasetIndex::getHeaderSize() const noexcept {
+	return headerSize;
+}
+
+/*
+  BethYw::DatasetIndex::getFirstYear()
+
+  @return
+    The first year with a value in the file (for a CSV file, the first year
+    in the header), or 0 if there are none
+*/
+int BethYw::DatasetIndex::getFirstYear() const noexcept {
+	return firstYear;
+}
+
+/*
+  BethYw::DatasetIndex::getLastYear()
+
+  @return
+    The last year with a value in the file (for a CSV file, the last year in
+    the header), or 0 if there are none
+*/
+int BethYw::DatasetIndex::getLastYear() const noexcept {
+	return lastYear;
+}
+
+/*
+  BethYw::DatasetIndex::getAreaCodes()
+
+  @return
+    Each local authority code in the file once, in the order first found.
+    The views are valid while the index is.
+*/
+std::vector<std::string_view> BethYw::DatasetIndex::getAreaCodes() const {
+	return codes(runAreas);
+}
+
+/*
+  BethYw::DatasetIndex::getMeasureCodes()
+
+  @return
+    Each measure code in the file once, as written in the file, in the order
+    first found (none for areas.csv). The views are valid while the index is.
+*/
+std::vector<std::string_view> BethYw::DatasetIndex::getMeasureCodes() const {
+	return codes(runMeasures);
+}
+
+/*
+  BethYw::DatasetIndex::runs()
+
+  @return
+    The number of runs of records with the same area and measure
+*/
+size_t BethYw::DatasetIndex::runs() const noexcept {
+	return starts.size();
+}
+
+/*
+  BethYw::DatasetIndex::select(filter, ranges)
+
+  Find the ranges of the file holding the records for the areas and measures
+  a filter keeps, in file order. Neighbouring runs are joined into one range,
+  so anything between them (commas, rows without a value) is also read. The
+  year filter is not used, as every run spans all the years of its area.
+
+  @param filter
+    The filters for the import
+
+  @param ranges
+    Replaced with the ranges to read
+
+  @return
+    true if the ranges are narrow enough to be worth reading instead of the
+    whole file (see MAX_SELECTED_SHARE above)
+
+  @example
+    RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+    std::vector<BethYw::ByteRange> ranges;
+    if (index.select(filter, ranges)) {
+      ...
+    }
+*/
+bool BethYw::DatasetIndex::select(const RecordFilter& filter,
+		std::vector<ByteRange>& ranges) const {
+	ranges.clear();
+
+	//each code is checked once, rather than once per run
+	std::vector<char> keepArea(strings.size());
+	std::vector<char> keepMeasure(strings.size());
+	for (size_t i = 0; i < strings.size(); i++){
+		keepArea[i] = filter.keepArea(strings[i]);
+		keepMeasure[i] = filter.keepMeasure(strings[i]);
+	}
+
+	uint64_t selected = 0;
+	size_t previous = starts.size();
+	for (size_t i = 0; i < starts.size(); i++){
+		if (!keepArea[runAreas[i]]
+				|| (runMeasures[i] != NO_MEASURE && !keepMeasure[runMeasures[i]])){
+			continue;
+		}
+		if (!ranges.empty() && previous + 1 == i){
+			selected += ends[i] - ranges.back().second;
+			ranges.back().second = ends[i];
+		} else {
+			selected += ends[i] - starts[i];
+			ranges.emplace_back(starts[i], ends[i]);
+		}
+		previous = i;
+	}
+
+	return selected <= (fileSize - headerSize) * MAX_SELECTED_SHARE;
+}
+
+/*
+  BethYw::getFileStamp(path, size, modified)
+
+  Find the size and modification time of a file, which indexes and
+  summaries record to tell whether they are still for the file as it is.
+
+  @param path
+    The path of the file
+
+  @param size
+    Set to the size of the file
+
+  @param modified
+    Set to the modification time of the file, in ticks of the filesystem
+    clock
+
+  @return
+    false if the file does not exist or cannot be read
+
+  @example
+    uint64_t size;
+    int64_t modified;
+    if (BethYw::getFileStamp("datasets/popu1009.json", size, modified)) {
+      ...
+    }
+*/
+bool BethYw::getFileStamp(const std::string& path, uint64_t& size, int64_t& modified) {
+	std::error_code error;
+	auto time = std::filesystem::last_write_time(path, error);
+	if (error){
+		return false;
+	}
+	size = std::filesystem::file_size(path, error);
+	if (error){
+		return false;
+	}
+	modified = (int64_t) time.time_since_epoch().count();
+	return true;
+}
+
+/*
+  BethYw::loadDatasetIndex(path, contents, source)
+
+  Get the index for a dataset file: the sidecar index next to it if there is
+  one for the file as it is now, or else a new index, which is saved next to
+  the file for next time along with the file's summary (see summary.h). If
+  they cannot be saved (e.g. the directory is read-only) the index is still
+  returned, and built again next time.
+
+  @param path
+    The path of the dataset file
+
+  @param contents
+    The contents of the file
+
+  @param source
+    The dataset the file holds
+
+  @return
+    The index, or nothing if one could not be built (e.g. the file is
+    malformed, which the import will then report)
+
+  @example
+    InputMmapFile input("datasets/popu1009.json");
+    auto index = BethYw::loadDatasetIndex("datasets/popu1009.json",
+        input.open(), BethYw::InputFiles::POPDEN);
+*/
+std::optional<BethYw::DatasetIndex> BethYw::loadDatasetIndex(
+		const std::string& path,
+		std::string_view contents,
+		const InputFileSource& source) {
+	uint64_t size;
+	int64_t modified;
+	if (!getFileStamp(path, size, modified)){
+		return std::nullopt;
+	}
+
+	const std::string indexPath = path + INDEX_SUFFIX;
+	const std::string summaryPath = path + SUMMARY_SUFFIX;
+	std::ifstream existing(indexPath, std::ios::binary);
+	if (existing.is_open()){
+		std::string buffer((std::istreambuf_iterator<char>(existing)),
+				std::istreambuf_iterator<char>());
+		existing.close();
+		try {
+			DatasetIndex index = DatasetIndex::read(buffer);
+			if (index.isFor(source, contents.size(), modified)){
+				//e.g. the summary was deleted, or written for an older file
+				if (!loadDatasetSummary(path, source)){
+					writeSidecar(summaryPath, DatasetSummary::build(index));
+				}
+				return index;
+			}
+		} catch (const std::runtime_error&) {
+			//a corrupt or outdated index is replaced below
+		}
+	}
+
+	try {
+		DatasetIndex index = DatasetIndex::build(contents, source, modified);
+		writeSidecar(indexPath, index);
+		writeSidecar(summaryPath, DatasetSummary::build(index));
+		return index;
+	} catch (const std::exception&) {
+		return std::nullopt;
+	}
+}
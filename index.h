@@ -0,0 +1,118 @@
+#ifndef INDEX_H_
+#define INDEX_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations for sidecar indexes of dataset files.
+  An index records where the records for each area and measure are in a
+  file, so that an import filtered to a few areas or measures (e.g.
+  `-d complete-pop -a W06000024`) reads just those records rather than every
+  byte of the file.
+
+  Records are grouped into runs of consecutive records with the same area and
+  measure code: ranges of rows in the "value" array of a StatsWales export,
+  or ranges of lines after the header of a CSV file. The runs selected by the
+  filters are parsed with the usual parsers and filters, so the result is the
+  same as reading the whole file.
+
+  The index for a file is kept next to it, with INDEX_SUFFIX added to its
+  name, and is built the first time the file is imported with --index,
+  along with the file's summary (see summary.h). It records the size and
+  modification time of the file, and is rebuilt if either has changed. Like
+  a snapshot (see snapshot.h) it is written in the byte order of the machine
+  that wrote it:
+
+    header     magic "BYWINDEX", version, byte order mark, data type, the
+               number of strings and runs, the size and modification time of
+               the file, the size of the CSV header line, and the first and
+               last year with a value (0 if there are none)
+    strings    stringCount + 1 uint32 offsets into the character data that
+               follows them; string 0 is the code of the dataset
+    runs       runCount uint64 start offsets, runCount uint64 end offsets,
+               runCount uint32 area string indexes and runCount uint32
+               measure string indexes (NO_MEASURE for areas.csv)
+
+  INDEX_VERSION changes whenever the layout does.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "datasets.h"
+#include "filter.h"
+
+namespace BethYw {
+
+constexpr unsigned int INDEX_VERSION = 2;
+
+const std::string INDEX_SUFFIX = ".idx";
+
+/*
+  A range of bytes in a file, from first up to but not including second.
+*/
+using ByteRange = std::pair<uint64_t, uint64_t>;
+
+class DatasetIndex {
+private:
+	SourceDataType type;
+	uint64_t fileSize;
+	int64_t modified;
+	uint64_t headerSize;
+	int firstYear;
+	int lastYear;
+	std::vector<std::string> strings;
+	std::vector<uint64_t> starts;
+	std::vector<uint64_t> ends;
+	std::vector<uint32_t> runAreas;
+	std::vector<uint32_t> runMeasures;
+
+	DatasetIndex();
+	void addRun(uint64_t start, uint64_t end, uint32_t area, uint32_t measure);
+	void addYear(int year) noexcept;
+	std::vector<std::string_view> codes(const std::vector<uint32_t>& runCodes) const;
+public:
+  static constexpr uint32_t NO_MEASURE = UINT32_MAX;
+
+  static DatasetIndex build(std::string_view contents,
+                            const InputFileSource& source,
+                            int64_t modified) noexcept(false);
+  static DatasetIndex read(std::string_view buffer) noexcept(false);
+  void write(std::ostream& os) const;
+
+  bool isFor(const InputFileSource& source,
+             uint64_t size,
+             int64_t modified) const noexcept;
+  const std::string& getCode() const noexcept;
+  SourceDataType getType() const noexcept;
+  uint64_t getFileSize() const noexcept;
+  int64_t getModified() const noexcept;
+  uint64_t getHeaderSize() const noexcept;
+  int getFirstYear() const noexcept;
+  int getLastYear() const noexcept;
+  size_t runs() const noexcept;
+  std::vector<std::string_view> getAreaCodes() const;
+  std::vector<std::string_view> getMeasureCodes() const;
+
+  bool select(const RecordFilter& filter, std::vector<ByteRange>& ranges) const;
+};
+
+bool getFileStamp(const std::string& path, uint64_t& size, int64_t& modified);
+
+std::optional<DatasetIndex> loadDatasetIndex(
+    const std::string& path,
+    std::string_view contents,
+    const InputFileSource& source);
+
+} // namespace BethYw
+
+#endif // INDEX_H_
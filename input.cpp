@@ -17,6 +17,17 @@
   functions not specified.
  */
 
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "input.h"
 
 /*
@@ -83,3 +94,104 @@ std::istream& InputFile::open(){
 	}
 	return openStream;
 }
+
+/*
+  InputMmapFile::InputMmapFile(path)
+
+  Constructor for a memory-mapped file source. The file is not opened until
+  open() is called.
+
+  @param path
+    The complete path for a file to import.
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+*/
+InputMmapFile::InputMmapFile(const std::string& filePath)
+    : InputSource(filePath), mapped(nullptr), length(0) {
+}
+
+/*
+  InputMmapFile::~InputMmapFile()
+
+  Unmap the file, if it was mapped. Any views returned by open() are no longer
+  valid afterwards.
+*/
+InputMmapFile::~InputMmapFile() {
+	close();
+}
+
+//Releases the mapping (or buffer) from a previous open()
+void InputMmapFile::close() noexcept {
+#ifdef _WIN32
+	buffer.clear();
+#else
+	if (mapped != nullptr && length > 0){
+		munmap(const_cast<char*>(mapped), length);
+	}
+#endif
+	mapped = nullptr;
+	length = 0;
+}
+
+/*
+  InputMmapFile::open()
+
+  Map the file at the path retrievable from getSource() read-only into memory
+  and return a view over its contents. Calling open() again remaps the file.
+
+  @return
+    A view over the whole file, which is empty if the file is empty
+
+  @throws
+    std::runtime_error if there is an issue opening the file, with the message:
+    InputMmapFile::open: Failed to open file <file name>
+
+  @example
+    InputMmapFile input("data/areas.csv");
+    std::string_view contents = input.open();
+*/
+std::string_view InputMmapFile::open(){
+	close();
+	const std::string path = this->getSource();
+	const std::string error = "InputMmapFile::open: Failed to open file " + path;
+
+#ifdef _WIN32
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open()){
+		throw std::runtime_error(error);
+	}
+	buffer.assign(std::istreambuf_iterator<char>(file),
+			std::istreambuf_iterator<char>());
+	mapped = buffer.data();
+	length = buffer.size();
+#else
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0){
+		throw std::runtime_error(error);
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)){
+		::close(fd);
+		throw std::runtime_error(error);
+	}
+
+	//mmap() refuses zero-length mappings, so an empty file is an empty view
+	if (info.st_size > 0){
+		void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (addr == MAP_FAILED){
+			::close(fd);
+			throw std::runtime_error(error);
+		}
+		madvise(addr, info.st_size, MADV_SEQUENTIAL);
+		mapped = static_cast<const char*>(addr);
+		length = static_cast<size_t>(info.st_size);
+	}
+
+	//the mapping keeps the file alive, so the descriptor is not needed
+	::close(fd);
+#endif
+
+	return std::string_view(mapped, length);
+}
@@ -9,9 +9,12 @@
   AUTHOR: 963620
 
   This file contains declarations for the input source handlers. There are
-  two classes: InputSource and InputFile. InputSource is abstract (i.e. it
-  contains a pure virtual function). InputFile is a concrete derivation of
-  InputSource, for input from files.
+  three classes: InputSource, InputFile and InputMmapFile. InputSource is
+  abstract (i.e. it contains a pure virtual function). InputFile is a concrete
+  derivation of InputSource, for input from files through a stream.
+  InputMmapFile is a sibling of InputFile that maps a file into memory and
+  hands out a read-only view of its contents, which the parsers in Areas can
+  read directly without going through a stream.
 
   Although only one class derives from InputSource, we have implemented our
   code this way to support future expansion of input from different sources
@@ -22,6 +25,7 @@
  */
 
 #include <string>
+#include <string_view>
 #include <fstream>
 
 /*
@@ -40,6 +44,7 @@ private:
 protected:
   InputSource(const std::string& source);
 public:
+  virtual ~InputSource() = default;
   virtual const std::string getSource() const;
 };
 
@@ -60,4 +65,30 @@ public:
   std::istream& open();
 };
 
+/*
+  Source data that is contained within a file, mapped read-only into memory.
+  The view returned by open() is valid until the InputMmapFile is destroyed,
+  and pages are read in by the kernel as the parsers walk through it (we hint
+  that access will be sequential).
+
+  On platforms without mmap() the file is read into a buffer instead, so the
+  same view-based parsing code can be used everywhere.
+*/
+class InputMmapFile : public InputSource {
+private:
+	const char* mapped;
+	size_t length;
+#ifdef _WIN32
+	std::string buffer;
+#endif
+
+	void close() noexcept;
+public:
+  InputMmapFile(const std::string& filePath);
+  ~InputMmapFile();
+  InputMmapFile(const InputMmapFile&) = delete;
+  InputMmapFile& operator=(const InputMmapFile&) = delete;
+  std::string_view open();
+};
+
 #endif // INPUT_H_
@@ -0,0 +1,248 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the InternTable class. Lookups of
+  strings that are already in the table only take a shared lock, so threads
+  parsing different files do not wait on each other once the table has seen
+  the strings they use.
+*/
+
+#include <cctype>
+#include <mutex>
+#include <stdexcept>
+
+#include "intern.h"
+
+/*
+  InternTable::intern(str)
+
+  Retrieve the ID for a string, adding it to the table if it is not there.
+
+  @param str
+    The string to intern
+
+  @return
+    The ID of the string
+
+  @example
+    InternTable& strings = InternTable::global();
+    InternId id = strings.intern("W06000011");
+    strings.lookup(id); // returns "W06000011"
+*/
+InternId InternTable::intern(std::string_view str) {
+	{
+		std::shared_lock<std::shared_mutex> lock(mutex);
+		auto it = ids.find(str);
+		if (it != ids.end()){
+			return it->second;
+		}
+	}
+
+	std::unique_lock<std::shared_mutex> lock(mutex);
+	//another thread may have added it while we were unlocked
+	auto it = ids.find(str);
+	if (it != ids.end()){
+		return it->second;
+	}
+	InternId id = strings.size();
+	strings.emplace_back(str);
+	ids.emplace(strings.back(), id);
+	return id;
+}
+
+/*
+  InternTable::internLower(str)
+
+  As intern(), but the string is converted to lowercase first. Used for
+  measure codes, which are case-insensitive.
+
+  @param str
+    The string to intern
+
+  @return
+    The ID of the lowercase string
+
+  @example
+    InternTable& strings = InternTable::global();
+    strings.internLower("Pop") == strings.intern("pop"); // true
+*/
+InternId InternTable::internLower(std::string_view str) {
+	thread_local std::string lower;
+	lower.assign(str.data(), str.size());
+	for (size_t i = 0; i < lower.length(); i++){
+		lower[i] = toLower(lower[i]);
+	}
+	return intern(lower);
+}
+
+/*
+  InternTable::find(str, id)
+
+  Retrieve the ID for a string without adding it to the table.
+
+  @param str
+    The string to find
+
+  @param id
+    Set to the ID of the string if it is in the table
+
+  @return
+    true if the string is in the table
+*/
+bool InternTable::find(std::string_view str, InternId& id) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	auto it = ids.find(str);
+	if (it == ids.end()){
+		return false;
+	}
+	id = it->second;
+	return true;
+}
+
+/*
+  InternTable::lookup(id)
+
+  Retrieve the string for an ID.
+
+  @param id
+    An ID returned by intern()
+
+  @return
+    Reference to the string, valid for the lifetime of the table
+
+  @throws
+    std::out_of_range if the ID is not in the table
+*/
+const std::string& InternTable::lookup(InternId id) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	if (id >= strings.size()){
+		throw std::out_of_range("InternTable::lookup: No string with ID " + std::to_string(id));
+	}
+	return strings[id];
+}
+
+//Returns the number of strings in the table
+size_t InternTable::size() const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	return strings.size();
+}
+
+/*
+  InternTable::forEach(end, visit)
+
+  Call visit with each ID below end and its string, in order of ID, taking
+  the lock once rather than once per string as lookup() would. visit must
+  not add to the table.
+
+  @param end
+    One past the last ID to visit, e.g. a size() taken earlier
+
+  @param visit
+    Called with each ID and its string
+
+  @example
+    InternTable& strings = InternTable::global();
+    strings.forEach(strings.size(), [](InternId id, const std::string& str) {
+      std::cout << id << ": " << str << std::endl;
+    });
+*/
+void InternTable::forEach(InternId end,
+		const std::function<void(InternId, const std::string&)>& visit) const {
+	std::shared_lock<std::shared_mutex> lock(mutex);
+	for (InternId id = 0; id < end && id < strings.size(); id++){
+		visit(id, strings[id]);
+	}
+}
+
+/*
+  InternTable::global()
+
+  Retrieve the table shared by the whole program.
+
+  @return
+    Reference to the table
+*/
+InternTable& InternTable::global() {
+	static InternTable table;
+	return table;
+}
+
+/*
+  InternTable::toLower(c)
+
+  Convert a character to lowercase, as internLower() does. tolower() is
+  undefined for negative values other than EOF, which a char above 0x7F
+  holds where char is signed, so it is given the character as an unsigned
+  char.
+
+  @param c
+    The character to convert
+
+  @return
+    c in lowercase, or c if it has no lowercase form
+
+  @example
+    InternTable::toLower('P'); // returns 'p'
+*/
+char InternTable::toLower(char c) noexcept {
+	return (char) tolower(static_cast<unsigned char>(c));
+}
+
+//Constructs an empty cache of IDs from table
+InternCache::InternCache(InternTable& table) : table(table) {}
+
+/*
+  InternCache::intern(str)
+
+  As InternTable::intern(), but the table is only asked the first time the
+  cache sees the string.
+
+  @param str
+    The string to intern
+
+  @return
+    The ID of the string
+
+  @example
+    InternCache cache;
+    cache.intern("W06000011") == InternTable::global().intern("W06000011"); // true
+*/
+InternId InternCache::intern(const std::string& str) {
+	auto it = ids.find(str);
+	if (it == ids.end()){
+		it = ids.emplace(str, table.intern(str)).first;
+	}
+	return it->second;
+}
+
+/*
+  InternCache::internLower(str)
+
+  As InternTable::internLower(), but the table is only asked the first time
+  the cache sees the string. The cache is keyed by the string as given, so
+  it is not converted to lowercase again either.
+
+  @param str
+    The string to intern
+
+  @return
+    The ID of the lowercase string
+
+  @example
+    InternCache cache;
+    cache.internLower("Pop") == cache.intern("pop"); // true
+*/
+InternId InternCache::internLower(const std::string& str) {
+	auto it = lowerIds.find(str);
+	if (it == lowerIds.end()){
+		it = lowerIds.emplace(str, table.internLower(str)).first;
+	}
+	return it->second;
+}
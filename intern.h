@@ -0,0 +1,79 @@
+#ifndef INTERN_H_
+#define INTERN_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the InternTable class. The same few
+  strings (authority codes, area names, measure codes and labels, language
+  codes) appear in every record we import, so rather than storing a copy of
+  each in every Area and Measure, they are stored once in a table and
+  referred to by a small integer ID. Two strings are equal exactly when
+  their IDs are equal.
+ */
+
+#include <deque>
+#include <functional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/*
+  The ID of a string stored in an InternTable.
+*/
+using InternId = unsigned int;
+
+/*
+  A table of unique strings, each with an ID. Strings are never removed, so an
+  ID (and a reference returned by lookup()) stays valid for the lifetime of
+  the table. All functions may be called from several threads at once.
+
+  The program uses a single table, returned by InternTable::global(), so IDs
+  can be compared across Areas, Area and Measure instances.
+*/
+class InternTable {
+private:
+	mutable std::shared_mutex mutex;
+	std::deque<std::string> strings;
+	std::unordered_map<std::string_view, InternId> ids;
+public:
+  InternTable() = default;
+  InternTable(const InternTable&) = delete;
+  InternTable& operator=(const InternTable&) = delete;
+
+  InternId intern(std::string_view str);
+  InternId internLower(std::string_view str);
+  bool find(std::string_view str, InternId& id) const;
+  const std::string& lookup(InternId id) const;
+  size_t size() const;
+  void forEach(InternId end,
+               const std::function<void(InternId, const std::string&)>& visit) const;
+
+  static InternTable& global();
+  static char toLower(char c) noexcept;
+};
+
+/*
+  A cache of IDs from an InternTable for one thread, e.g. one parse of a file
+  or a range of it. Every record of a file repeats the same few strings, so
+  the first lookup of each goes to the table (which takes its lock) and the
+  rest are answered from the cache. Not safe to share between threads.
+*/
+class InternCache {
+private:
+	InternTable& table;
+	std::unordered_map<std::string, InternId> ids;
+	std::unordered_map<std::string, InternId> lowerIds;
+public:
+  explicit InternCache(InternTable& table = InternTable::global());
+
+  InternId intern(const std::string& str);
+  InternId internLower(const std::string& str);
+};
+
+#endif // INTERN_H_
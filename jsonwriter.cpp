@@ -0,0 +1,256 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the JSONWriter class. See
+  jsonwriter.h for details.
+*/
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+#include "jsonwriter.h"
+
+namespace {
+
+//Bytes gathered before they are passed on to the stream
+const size_t BUFFER_SIZE = 64 * 1024;
+
+} // namespace
+
+/*
+  JSONWriter::JSONWriter(os)
+
+  Construct a writer that writes to a stream.
+
+  @param os
+    The stream to write to; it must outlive the writer
+
+  @example
+    JSONWriter writer(std::cout);
+*/
+JSONWriter::JSONWriter(std::ostream& _os) : os(&_os), afterKey(false) {
+	buffer.reserve(BUFFER_SIZE);
+}
+
+/*
+  JSONWriter::JSONWriter()
+
+  Construct a writer that keeps everything it writes, to be retrieved with
+  str().
+
+  @example
+    JSONWriter writer;
+    writer.beginObject();
+    writer.endObject();
+    writer.str(); // returns "{}"
+*/
+JSONWriter::JSONWriter() : os(nullptr), afterKey(false) {
+}
+
+/*
+  JSONWriter::~JSONWriter()
+
+  Write anything still buffered to the stream.
+*/
+JSONWriter::~JSONWriter() {
+	flush();
+}
+
+//Adds the comma needed before the next key (or value, outside any object)
+void JSONWriter::separate() {
+	if (afterKey){
+		afterKey = false;
+		return;
+	}
+	if (!firstInObject.empty()){
+		if (!firstInObject.back()){
+			buffer += ',';
+		}
+		firstInObject.back() = false;
+	}
+}
+
+//Appends a quoted string, escaping the characters JSON does not allow as they are
+void JSONWriter::writeString(std::string_view str) {
+	buffer += '"';
+	size_t start = 0;
+	for (size_t i = 0; i < str.size(); i++){
+		unsigned char c = str[i];
+		if (c >= 0x20 && c != '"' && c != '\\'){
+			continue;
+		}
+		buffer.append(str.data() + start, i - start);
+		start = i + 1;
+		switch (c){
+			case '"': buffer += "\\\""; break;
+			case '\\': buffer += "\\\\"; break;
+			case '\b': buffer += "\\b"; break;
+			case '\f': buffer += "\\f"; break;
+			case '\n': buffer += "\\n"; break;
+			case '\r': buffer += "\\r"; break;
+			case '\t': buffer += "\\t"; break;
+			default: {
+				const char hex[] = "0123456789abcdef";
+				char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+				buffer.append(escape, sizeof(escape));
+			}
+		}
+	}
+	buffer.append(str.data() + start, str.size() - start);
+	buffer += '"';
+}
+
+/*
+  JSONWriter::beginObject()
+
+  Start an object, either at the top level or as the value of the last key.
+*/
+void JSONWriter::beginObject() {
+	separate();
+	buffer += '{';
+	firstInObject.push_back(true);
+}
+
+/*
+  JSONWriter::endObject()
+
+  Finish the innermost object. The buffer is passed on to the stream here
+  once it is full, so a writer flushes at most once per object.
+*/
+void JSONWriter::endObject() {
+	buffer += '}';
+	firstInObject.pop_back();
+	if (os != nullptr && buffer.size() >= BUFFER_SIZE){
+		flush();
+	}
+}
+
+/*
+  JSONWriter::key(key)
+
+  Write the key for the next value in the current object.
+
+  @param key
+    The key, which is escaped as needed
+
+  @example
+    writer.key("names");
+    writer.beginObject();
+*/
+void JSONWriter::key(std::string_view key) {
+	separate();
+	writeString(key);
+	buffer += ':';
+	afterKey = true;
+}
+
+/*
+  JSONWriter::key(key)
+
+  As above, but for a number used as a key (e.g. a year), which JSON requires
+  to be written as a string.
+
+  @param key
+    The number to use as the key
+
+  @example
+    writer.key(2015);
+    writer.value(242316.0);  // "2015":242316.0
+*/
+void JSONWriter::key(int key) {
+	char digits[16];
+	auto result = std::to_chars(digits, digits + sizeof(digits), key);
+	this->key(std::string_view(digits, result.ptr - digits));
+}
+
+/*
+  JSONWriter::value(value)
+
+  Write a string value for the last key.
+
+  @param value
+    The string, which is escaped as needed
+*/
+void JSONWriter::value(std::string_view value) {
+	separate();
+	writeString(value);
+}
+
+/*
+  JSONWriter::value(value)
+
+  Write a number value for the last key, in the shortest form that reads
+  back as the same double. Whole numbers get ".0" added. JSON has no
+  infinity or NaN, so those are written as null.
+
+  @param value
+    The number
+
+  @example
+    writer.value(98.195805);  // 98.195805
+    writer.value(69123);      // 69123.0
+*/
+void JSONWriter::value(double value) {
+	separate();
+	if (!std::isfinite(value)){
+		buffer += "null";
+		return;
+	}
+	char digits[32];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	size_t length = result.ptr - digits;
+	buffer.append(digits, length);
+	if (std::memchr(digits, '.', length) == nullptr && std::memchr(digits, 'e', length) == nullptr){
+		buffer += ".0";
+	}
+}
+
+/*
+  JSONWriter::integer(value)
+
+  Write an integer value for the last key, without the ".0" that value()
+  adds, e.g. for counts.
+
+  @param value
+    The integer
+
+  @example
+    writer.integer(1000);  // 1000
+*/
+void JSONWriter::integer(long long value) {
+	separate();
+	char digits[24];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	buffer.append(digits, result.ptr - digits);
+}
+
+/*
+  JSONWriter::flush()
+
+  Pass anything buffered on to the stream. Does nothing for a writer with no
+  stream.
+*/
+void JSONWriter::flush() {
+	if (os != nullptr && !buffer.empty()){
+		os->write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+}
+
+/*
+  JSONWriter::str()
+
+  @return
+    Everything written so far, for a writer with no stream
+*/
+const std::string& JSONWriter::str() const noexcept {
+	return buffer;
+}
@@ -0,0 +1,67 @@
+#ifndef JSONWRITER_H_
+#define JSONWRITER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the JSONWriter class, which writes
+  JSON text as it is produced rather than building a document first. Output
+  is gathered in a fixed-size buffer and passed on to the stream in large
+  blocks, so writing a value costs a few bytes of copying and no allocations.
+
+  Numbers are written in the shortest form that reads back as the same
+  double (std::to_chars), with ".0" added to whole numbers so that they read
+  back as floating point, as the JSON library does.
+ */
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+  Writes nested JSON objects to a stream or a string. Commas and colons are
+  added automatically, so callers only say what comes next:
+
+    JSONWriter writer(std::cout);
+    writer.beginObject();
+    writer.key("pop");
+    writer.value(1234.5);
+    writer.endObject();   // {"pop":1234.5}
+
+  Anything still buffered is written when the writer is destroyed, or
+  earlier with flush(). Only objects are supported, as that is all we write.
+*/
+class JSONWriter {
+private:
+	std::ostream* os;
+	std::string buffer;
+	std::vector<bool> firstInObject;
+	bool afterKey;
+
+	void separate();
+	void writeString(std::string_view str);
+public:
+  explicit JSONWriter(std::ostream& os);
+  JSONWriter();
+  ~JSONWriter();
+  JSONWriter(const JSONWriter&) = delete;
+  JSONWriter& operator=(const JSONWriter&) = delete;
+
+  void beginObject();
+  void endObject();
+  void key(std::string_view key);
+  void key(int key);
+  void value(std::string_view value);
+  void value(double value);
+  void integer(long long value);
+
+  void flush();
+  const std::string& str() const noexcept;
+};
+
+#endif // JSONWRITER_H_
@@ -18,13 +18,17 @@
   must implement has a TODO block comment. 
 */
 
+#include <algorithm>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 
+#include "analytics.h"
 #include "measure.h"
+#include "tablewriter.h"
 
 /*
   TODO: Measure::Measure(codename, label);
@@ -45,12 +49,30 @@
     std::string label = "Population";
     Measure measure(codename, label);
 */
-Measure::Measure(std::string codename, const std::string &label) {
-	for (size_t i = 0; i<codename.length();i++){
-		codename[i] = (char) tolower(codename[i]);
-	}
-	this->codename = codename;
-	this->label = label;
+Measure::Measure(std::string codename, const std::string &label)
+    : firstYear(0), count(0) {
+	this->codename = InternTable::global().internLower(codename);
+	this->label = InternTable::global().intern(label);
+}
+
+/*
+  Measure::Measure(code, label)
+
+  Construct a Measure from strings that are already interned, without
+  touching the strings themselves.
+
+  @param code
+    The ID of the codename, which must already be lowercase
+
+  @param label
+    The ID of the label
+
+  @example
+    InternTable& strings = InternTable::global();
+    Measure measure(strings.internLower("Pop"), strings.intern("Population"));
+*/
+Measure::Measure(InternId code, InternId label) noexcept
+    : label(label), codename(code), firstYear(0), count(0) {
 }
 
 /*
@@ -72,7 +94,12 @@ Measure::Measure(std::string codename, const std::string &label) {
     ...
     auto codename2 = measure.getCodename();
 */
-const std::string Measure::getCodename() const noexcept{
+const std::string& Measure::getCodename() const noexcept{
+	return InternTable::global().lookup(this->codename);
+}
+
+//Returns the ID of the codename in InternTable::global()
+InternId Measure::getCodenameId() const noexcept{
 	return this->codename;
 }
 
@@ -95,7 +122,12 @@ const std::string Measure::getCodename() const noexcept{
     ...
     auto label = measure.getLabel();
 */
-const std::string Measure::getLabel() const noexcept{
+const std::string& Measure::getLabel() const noexcept{
+	return InternTable::global().lookup(this->label);
+}
+
+//Returns the ID of the label in InternTable::global()
+InternId Measure::getLabelId() const noexcept{
 	return this->label;
 }
 
@@ -115,7 +147,7 @@ const std::string Measure::getLabel() const noexcept{
     measure.setLabel("New Population");
 */
 void Measure::setLabel(std::string _label){
-	this->label = _label;
+	this->label = InternTable::global().intern(_label);
 }
 
 /*
@@ -147,18 +179,21 @@ void Measure::setLabel(std::string _label){
 */
 
 const double Measure::getValue(int key) const {
-	auto it = this->values.find(key);
-
-	if (it != this->values.end()){
-		return it->second;
+	if (hasValue(key)){
+		return this->values[(int64_t) key - this->firstYear];
 	} else {
 		throw std::out_of_range("No value found for year " + std::to_string(key));
 	}
 }
 
-//Returns full list of the values
+//Returns a copy of the values as a map. Only kept for the coursework interface;
+//iterate over the Measure instead, which does not copy
 const std::map<int,double> Measure::getValues() const {
-	return values;
+	std::map<int,double> result;
+	for (auto yearValue : *this){
+		result.emplace_hint(result.end(), yearValue);
+	}
+	return result;
 }
 /*
   TODO: Measure::setValue(key, value)
@@ -175,6 +210,10 @@ const std::map<int,double> Measure::getValues() const {
   @return
     void
 
+  @throws
+    std::out_of_range if the Measure would then span more than MAX_YEAR_SPAN
+    years, with the message Year <year> is too far from the other years
+
   @example
     std::string codename = "Pop";
     std::string label = "Population";
@@ -183,11 +222,174 @@ const std::map<int,double> Measure::getValues() const {
     measure.setValue(1999, 12345678.9);
 */
 void Measure::setValue(int key, double value){
-	auto it = this->values.find(key);
-	if (it != this->values.end()){
-		this->values.erase(it);
+	if (this->values.empty()){
+		this->firstYear = key;
+		this->values.push_back(value);
+		this->present.push_back(true);
+		this->count = 1;
+		return;
+	}
+
+	//offsets are taken in 64 bits so that years far apart cannot overflow
+	const int64_t first = std::min<int64_t>(key, this->firstYear);
+	const int64_t last = std::max<int64_t>(key, getLastYear());
+	if (last - first >= MAX_YEAR_SPAN){
+		throw std::out_of_range("Year " + std::to_string(key)
+				+ " is too far from the other years");
+	}
+
+	//grow the storage at either end so that it covers key
+	if (key < this->firstYear){
+		size_t extra = (size_t) (this->firstYear - first);
+		this->values.insert(this->values.begin(), extra, 0);
+		this->present.insert(this->present.begin(), extra, false);
+		this->firstYear = key;
+	} else if (key > getLastYear()){
+		size_t slots = (size_t) (last - first) + 1;
+		this->values.resize(slots, 0);
+		this->present.resize(slots, false);
+	}
+
+	size_t i = (size_t) ((int64_t) key - this->firstYear);
+	this->values[i] = value;
+	if (!this->present[i]){
+		this->present[i] = true;
+		this->count++;
+	}
+}
+
+/*
+  Measure::isValidYear(year)
+
+  Check whether a year read from a dataset is one a Measure accepts, i.e.
+  between MIN_YEAR and MAX_YEAR. The parsers refuse any other year.
+
+  @param year
+    The year to check
+
+  @return
+    true if the year is in range
+
+  @example
+    Measure::isValidYear(2020); // returns true
+    Measure::isValidYear(99999); // returns false
+*/
+bool Measure::isValidYear(int year) noexcept{
+	return year >= MIN_YEAR && year <= MAX_YEAR;
+}
+
+/*
+  Measure::setDenseValues(first, values, present, slots)
+
+  Replace all of the readings with a dense array, e.g. one read back from a
+  snapshot (see snapshot.h). values[i] is the reading for first + i, and is
+  only kept if present[i] is non-zero. Missing slots at either end are
+  dropped.
+
+  @param first
+    The year of the first slot
+
+  @param values
+    The readings, one per slot
+
+  @param present
+    Non-zero for each slot that holds a reading
+
+  @param slots
+    The number of slots in values and present
+
+  @return
+    void
+
+  @example
+    double values[] = {1.5, 0, 2.5};
+    unsigned char present[] = {1, 0, 1};
+
+    Measure measure("pop", "Population");
+    measure.setDenseValues(2010, values, present, 3);
+    measure.size(); // returns 2
+*/
+void Measure::setDenseValues(int first, const double* values,
+		const unsigned char* present, size_t slots){
+	size_t begin = 0;
+	while (begin < slots && present[begin] == 0){
+		begin++;
+	}
+	size_t end = slots;
+	while (end > begin && present[end - 1] == 0){
+		end--;
+	}
+
+	this->values.assign(values + begin, values + end);
+	this->present.assign(end - begin, false);
+	this->firstYear = begin < end ? first + (int) begin : 0;
+	this->count = 0;
+	for (size_t i = begin; i < end; i++){
+		if (present[i] != 0){
+			this->present[i - begin] = true;
+			this->count++;
+		} else {
+			//missing years always hold 0, see getAverage()
+			this->values[i - begin] = 0;
+		}
+	}
+}
+
+/*
+  Measure::hasValue(key)
+
+  Check whether the Measure has a value for a given year.
+
+  @param key
+    The year to check
+
+  @return
+    true if there is a value for the year
+
+  @example
+    Measure measure("pop", "Population");
+    measure.setValue(1999, 12345678.9);
+    measure.hasValue(1999); // returns true
+    measure.hasValue(2000); // returns false
+*/
+bool Measure::hasValue(int key) const noexcept{
+	if (this->values.empty() || key < this->firstYear || key > getLastYear()){
+		return false;
+	}
+	return this->present[(int64_t) key - this->firstYear];
+}
+
+//Returns the earliest year with a value, or 0 if there are none
+int Measure::getFirstYear() const noexcept{
+	return this->firstYear;
+}
+
+//Returns the latest year with a value, or 0 if there are none
+int Measure::getLastYear() const noexcept{
+	if (this->values.empty()){
+		return 0;
 	}
-	this->values.insert({key,value});
+	return this->firstYear + (int) this->values.size() - 1;
+}
+
+/*
+  Measure::getDenseValues()
+
+  Retrieve the values as a contiguous array, one element per year from
+  getFirstYear() to getLastYear(). Years without a value hold 0; use
+  hasValue() to tell these apart from real readings.
+
+  @return
+    Reference to the values, valid until the Measure is next modified
+
+  @example
+    Measure measure("pop", "Population");
+    measure.setValue(1999, 1);
+    measure.setValue(2001, 3);
+    auto& values = measure.getDenseValues(); // {1, 0, 3}
+*/
+const std::vector<double>& Measure::getDenseValues() const noexcept{
+	return this->values;
 }
 
 /*
@@ -210,7 +412,7 @@ void Measure::setValue(int key, double value){
 */
 
 const int Measure::size() const noexcept{
-	return values.size();
+	return this->count;
 }
 /*
   TODO: Measure::getDifference()
@@ -231,8 +433,11 @@ const int Measure::size() const noexcept{
 */
 
 const double Measure::getDifference() const noexcept{
-	return (this->values.begin()->second -
-			this->values.end()->second);
+	if (this->values.empty()){
+		return 0;
+	}
+	//the first and last slots always hold a value
+	return this->values.back() - this->values.front();
 }
 /*
   TODO: Measure::getDifferenceAsPercentage()
@@ -253,8 +458,10 @@ const double Measure::getDifference() const noexcept{
 */
 
 const double Measure::getDifferenceAsPercentage() const noexcept{
-	return (this->values.end()->second /
-				this->values.begin()->second) * 100;
+	if (this->values.empty() || this->values.front() == 0){
+		return 0;
+	}
+	return (getDifference() / this->values.front()) * 100;
 }
 /*
   TODO: Measure::getAverage()
@@ -274,11 +481,72 @@ const double Measure::getDifferenceAsPercentage() const noexcept{
 */
 
 const double Measure::getAverage() const noexcept{
-	double average;
-	for (auto it = this->values.begin(); it!=this->values.end();it++){
-		average += it->second;
+	if (this->count == 0){
+		return 0;
 	}
-	return average/this->size();
+	//missing years hold 0, so the whole array can be summed
+	return stableSum(this->values.data(), this->values.size())/this->count;
+}
+
+/*
+  Measure::begin()
+
+  Retrieve an iterator to the first year with a value. Together with end(),
+  this allows a Measure to be used in a range-based for loop.
+
+  @return
+    Iterator to the first (year, value) pair
+
+  @example
+    Measure measure("pop", "Population");
+    measure.setValue(1999, 12345678.9);
+    for (auto yearValue : measure) {
+      std::cout << yearValue.first << ": " << yearValue.second << std::endl;
+    }
+*/
+Measure::const_iterator Measure::begin() const noexcept{
+	return const_iterator(this, 0);
+}
+
+//Returns an iterator to one past the last year with a value
+Measure::const_iterator Measure::end() const noexcept{
+	return const_iterator(this, this->values.size());
+}
+
+Measure::const_iterator::const_iterator(const Measure* _measure, size_t _index) noexcept
+    : measure(_measure), index(_index) {
+	skipMissing();
+}
+
+//Moves forward past any years without a value
+void Measure::const_iterator::skipMissing() noexcept{
+	while (index < measure->values.size() && !measure->present[index]){
+		index++;
+	}
+}
+
+Measure::const_iterator::value_type Measure::const_iterator::operator*() const noexcept{
+	return {measure->firstYear + (int) index, measure->values[index]};
+}
+
+Measure::const_iterator& Measure::const_iterator::operator++() noexcept{
+	index++;
+	skipMissing();
+	return *this;
+}
+
+Measure::const_iterator Measure::const_iterator::operator++(int) noexcept{
+	const_iterator previous = *this;
+	++(*this);
+	return previous;
+}
+
+bool Measure::const_iterator::operator==(const const_iterator& other) const noexcept{
+	return measure == other.measure && index == other.index;
+}
+
+bool Measure::const_iterator::operator!=(const const_iterator& other) const noexcept{
+	return !(*this == other);
 }
 /*
   TODO: operator<<(os, measure)
@@ -299,6 +567,9 @@ const double Measure::getAverage() const noexcept{
 
   See the coursework specification for more information.
 
+  The table is rendered by TableWriter (see tablewriter.h), which formats
+  the cells itself rather than through the stream.
+
   @param os
     The output stream to write to
 
@@ -316,18 +587,9 @@ const double Measure::getAverage() const noexcept{
     measure.setValue(1999, 12345678.9);
     std::cout << measure << std::end;
 */
-std::ostream& operator<<(std::ostream& os, Measure measure){
-	os << measure.getLabel() << "(" << measure.getCodename() << ")\n";
-	std::map<int,double> values = measure.getValues();
-	for (auto it = values.begin();it != values.end();it++){
-		os << std::setw(10) << it->first; // @suppress("Function cannot be resolved")
-	}
-	os << std::setw(13) << "Average" << std::setw(12) << "Diff." << std::setw(8) << "%Diff.";// @suppress("Function cannot be resolved")
-	os << "\n";
-	for (auto it = values.begin();it != values.end();it++){
-		os << std::setw(10) << it->second;// @suppress("Function cannot be resolved")
-	}
-	os << "\n";
+std::ostream& operator<<(std::ostream& os, const Measure& measure){
+	TableWriter writer(os);
+	writer.write(measure);
 	return os;
 }
 
@@ -347,18 +609,24 @@ std::ostream& operator<<(std::ostream& os, Measure measure){
     true if both Measure objects have the same codename, label and data; false
     otherwise
 */
-bool operator==(Measure lhs, Measure rhs){
+bool operator==(const Measure& lhs, const Measure& rhs){
 	if (lhs.size() != rhs.size()){
 		return false;
 	}
-	if (lhs.getLabel() != rhs.getLabel()){
+	if (lhs.getLabelId() != rhs.getLabelId()){
 		return false;
 	}
-	if (lhs.getCodename() != rhs.getCodename()){
+	if (lhs.getCodenameId() != rhs.getCodenameId()){
 			return false;
 		}
-	if (lhs.getValues() != rhs.getValues()){
+	if (lhs.getFirstYear() != rhs.getFirstYear()
+			|| lhs.getDenseValues() != rhs.getDenseValues()){
 		return false;
 	}
+	for (int year = lhs.getFirstYear(); year <= lhs.getLastYear(); year++){
+		if (lhs.hasValue(year) != rhs.hasValue(year)){
+			return false;
+		}
+	}
 	return true;
 }
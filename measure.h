@@ -14,37 +14,105 @@
   functions and member variables you need to declare in this class.
  */
 
+#include <cstddef>
+#include <iterator>
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
 #include <iomanip>
 
+#include "intern.h"
+
 /*
   The Measure class contains a measure code, label, and a container for readings
   from across a number of years.
 
+  Readings are held densely: values[i] is the reading for firstYear + i, and
+  present[i] says whether there is a reading for that year at all. Years
+  without a reading hold 0 so that sums can run over the whole array. The
+  first and last slots always hold a reading.
+
+  The codename and label are held as IDs in InternTable::global().
+
+  Iterating over a Measure visits each year that has a reading, in order, as a
+  (year, value) pair, without copying the readings:
+
+    for (auto yearValue : measure) {
+      yearValue.first ... yearValue.second
+    }
+
+  getValues() builds a std::map copy of the readings on every call; it is
+  only kept for the coursework interface, and nothing in the program calls it.
+
   TODO: Based on your implementation, there may be additional constructors
   or functions you implement here, and perhaps additional operators you may wish
   to overload.
 */
 class Measure {
 private:
-	std::string label;
-	std::string codename;
-	std::map<int,double> values;
+	InternId label;
+	InternId codename;
+	int firstYear;
+	int count;
+	std::vector<double> values;
+	std::vector<bool> present;
 public:
+	/*
+	  Iterator over the years that have a reading. Dereferencing gives a
+	  (year, value) pair by value.
+	*/
+	class const_iterator {
+	private:
+		const Measure* measure;
+		size_t index;
+		void skipMissing() noexcept;
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = std::pair<int,double>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const value_type*;
+		using reference = value_type;
+
+		const_iterator(const Measure* measure, size_t index) noexcept;
+		value_type operator*() const noexcept;
+		const_iterator& operator++() noexcept;
+		const_iterator operator++(int) noexcept;
+		bool operator==(const const_iterator& other) const noexcept;
+		bool operator!=(const const_iterator& other) const noexcept;
+	};
+
 	Measure(std::string code, const std::string &label);
-	const std::string getCodename() const noexcept;
-	const std::string getLabel() const noexcept;
+	Measure(InternId code, InternId label) noexcept;
+	const std::string& getCodename() const noexcept;
+	const std::string& getLabel() const noexcept;
+	InternId getCodenameId() const noexcept;
+	InternId getLabelId() const noexcept;
 	void setLabel(std::string label);
 	const double getValue(int key) const;
 	const std::map<int,double> getValues() const;
+	//years are parsed from the data, so an outlier (e.g. 0 or 99999) is
+	//refused rather than given a slot for every year between it and the rest
+	static const int MIN_YEAR = 1;
+	static const int MAX_YEAR = 9999;
+	static const int MAX_YEAR_SPAN = 1000;
+	static bool isValidYear(int year) noexcept;
+
 	void setValue(int key, double value);
+	void setDenseValues(int first, const double* values,
+			const unsigned char* present, size_t slots);
+	bool hasValue(int key) const noexcept;
+	int getFirstYear() const noexcept;
+	int getLastYear() const noexcept;
+	const std::vector<double>& getDenseValues() const noexcept;
 	const int size() const noexcept;
 	const double getDifference() const noexcept;
 	const double getDifferenceAsPercentage() const noexcept;
 	const double getAverage() const noexcept;
+	const_iterator begin() const noexcept;
+	const_iterator end() const noexcept;
 };
 
-bool operator==(Measure lhs, Measure rhs);
-std::ostream& operator<<(std::ostream& os, Measure measure);
+bool operator==(const Measure& lhs, const Measure& rhs);
+std::ostream& operator<<(std::ostream& os, const Measure& measure);
 #endif // MEASURE_H_
@@ -0,0 +1,63 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the PipelineStage class. See
+  pipeline.h for details.
+*/
+
+#include "pipeline.h"
+
+/*
+  BethYw::PipelineStage::PipelineStage(group, work)
+
+  Construct a stage, which does nothing until it is woken.
+
+  @param group
+    The group to run the stage's work in; wait for it to wait for the
+    pipeline, and cancel it to stop the pipeline
+
+  @param work
+    The function that does the stage's work, until its input is empty or
+    its output is full
+
+  @example
+    BethYw::TaskGroup group;
+    BethYw::PipelineStage parse(group, [&]() { ... });
+    parse.wake();
+    group.wait();
+*/
+BethYw::PipelineStage::PipelineStage(TaskGroup& _group, std::function<void()> _work)
+		: group(_group), work(std::move(_work)), wakeups(0) {
+}
+
+/*
+  BethYw::PipelineStage::wake()
+
+  Make sure the stage's work function runs after this call. If it is not
+  running, a task is submitted to run it; if it is, it runs again once it
+  has finished. Any thread may call this.
+*/
+void BethYw::PipelineStage::wake() {
+	if (wakeups++ == 0){
+		group.run([this]() { run(); });
+	}
+}
+
+//Runs the work function until no wake() has come in while it was running
+void BethYw::PipelineStage::run() {
+	while (true){
+		unsigned int seen = wakeups;
+		work();
+		//a wake() after this succeeds submits a new task, as wakeups is 0
+		if (wakeups.compare_exchange_strong(seen, 0)){
+			return;
+		}
+	}
+}
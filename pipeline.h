@@ -0,0 +1,200 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the building blocks of the staged import pipeline (see
+  Areas::populateFromWelshStatsPipeline()): a bounded, lock-free queue
+  between two stages, and PipelineStage, which runs one stage as tasks on a
+  TaskScheduler (see scheduler.h).
+
+  Each stage takes items from the queue before it, does its part of the work
+  and puts the results on the queue after it, e.g.
+
+    read ──▶ parse ──▶ merge
+
+  so that reading a block of the file, parsing the block before it and
+  merging the one before that all happen at the same time.
+
+  The pipeline only serves StatsWales JSON files read from a buffer with
+  more than one thread, and only those of at least two PIPELINE_BLOCK_BYTES
+  blocks that are too small to split into two MIN_JSON_CHUNK_BYTES chunks
+  parsed side by side (see Areas::populateFromWelshStatsJSON()). Larger
+  files are split into chunks instead. CSV files and files read from a
+  stream are parsed in one go. The queues are
+  small, so an early stage that gets ahead stops once its queue is full,
+  and memory stays bounded however large the file is.
+
+  A stage never waits for a queue. Instead it works until its input is empty
+  or its output is full and then returns, and whichever stage next changes
+  one of those queues wakes it up again. Stages therefore never tie up a
+  worker thread, and a pipeline runs (more slowly) on a single worker. A
+  stage never runs on two threads at once, so each queue only ever has one
+  producer and one consumer, and items go through each stage in order.
+ */
+
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+#include "scheduler.h"
+
+namespace BethYw {
+
+/*
+  A queue of at most `capacity` items, for exactly one producer and one
+  consumer, which may be on different threads. Neither side ever blocks or
+  takes a lock: tryPush() fails if the queue is full and tryPop() fails if it
+  is empty. The producer calls close() after its last item.
+*/
+template <typename T>
+class BoundedQueue {
+private:
+	std::vector<T> slots;
+	//counts of the items ever popped and pushed; only the consumer writes
+	//head and only the producer writes tail
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+	std::atomic<bool> closed;
+public:
+  explicit BoundedQueue(size_t capacity);
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+  bool full() const noexcept;
+  bool tryPush(T& item);
+  bool tryPop(T& item);
+  void close() noexcept;
+  bool isDrained() const noexcept;
+};
+
+/*
+  BethYw::BoundedQueue<T>::BoundedQueue(capacity)
+
+  Construct an empty queue.
+
+  @param capacity
+    The most items the queue can hold
+
+  @throws
+    std::invalid_argument if capacity is 0
+*/
+template <typename T>
+BoundedQueue<T>::BoundedQueue(size_t capacity)
+		: slots(capacity), head(0), tail(0), closed(false) {
+	if (capacity == 0){
+		throw std::invalid_argument("BethYw::BoundedQueue: The capacity must be at least 1");
+	}
+}
+
+/*
+  BethYw::BoundedQueue<T>::full()
+
+  @return
+    True if the queue is full; only meaningful to the producer
+*/
+template <typename T>
+bool BoundedQueue<T>::full() const noexcept {
+	return tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire)
+			== slots.size();
+}
+
+/*
+  BethYw::BoundedQueue<T>::tryPush(item)
+
+  Add an item to the back of the queue, if it is not full. Only the producer
+  may call this.
+
+  @param item
+    The item, which is moved into the queue if there is room
+
+  @return
+    True if the item was added
+*/
+template <typename T>
+bool BoundedQueue<T>::tryPush(T& item) {
+	size_t back = tail.load(std::memory_order_relaxed);
+	if (back - head.load(std::memory_order_acquire) == slots.size()){
+		return false;
+	}
+	slots[back % slots.size()] = std::move(item);
+	tail.store(back + 1, std::memory_order_release);
+	return true;
+}
+
+/*
+  BethYw::BoundedQueue<T>::tryPop(item)
+
+  Take the item at the front of the queue, if there is one. Only the
+  consumer may call this.
+
+  @param item
+    Set to the item taken
+
+  @return
+    True if an item was taken
+*/
+template <typename T>
+bool BoundedQueue<T>::tryPop(T& item) {
+	size_t front = head.load(std::memory_order_relaxed);
+	if (front == tail.load(std::memory_order_acquire)){
+		return false;
+	}
+	item = std::move(slots[front % slots.size()]);
+	head.store(front + 1, std::memory_order_release);
+	return true;
+}
+
+/*
+  BethYw::BoundedQueue<T>::close()
+
+  Record that the producer has pushed its last item.
+*/
+template <typename T>
+void BoundedQueue<T>::close() noexcept {
+	closed.store(true, std::memory_order_release);
+}
+
+/*
+  BethYw::BoundedQueue<T>::isDrained()
+
+  @return
+    True if the queue has been closed and every item has been popped
+*/
+template <typename T>
+bool BoundedQueue<T>::isDrained() const noexcept {
+	return closed.load(std::memory_order_acquire)
+			&& head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+}
+
+/*
+  One stage of a pipeline. wake() is called whenever the stage may have
+  something to do (its input has a new item, or its output has room again),
+  and makes sure the stage's work function runs, as a task in group, after
+  the call. The work function does as much as it can and returns; it never
+  runs on two threads at once.
+*/
+class PipelineStage {
+private:
+	TaskGroup& group;
+	std::function<void()> work;
+	std::atomic<unsigned int> wakeups;
+
+	void run();
+public:
+  PipelineStage(TaskGroup& group, std::function<void()> work);
+  PipelineStage(const PipelineStage&) = delete;
+  PipelineStage& operator=(const PipelineStage&) = delete;
+
+  void wake();
+};
+
+} // namespace BethYw
+
+#endif // PIPELINE_H_
@@ -0,0 +1,373 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the TaskScheduler and TaskGroup
+  classes. See scheduler.h for details.
+*/
+
+#include <algorithm>
+#include <chrono>
+
+#include "scheduler.h"
+
+namespace {
+
+//The scheduler and queue of the worker running on this thread, if any
+thread_local const BethYw::TaskScheduler* currentScheduler = nullptr;
+thread_local size_t currentQueue = 0;
+
+//The scheduler installed with TaskScheduler::Scope, if any
+std::atomic<BethYw::TaskScheduler*> installed(nullptr);
+
+//How often a worker waiting for a group looks for tasks again once it has
+//found none, in case tasks it can help with have been submitted since
+const std::chrono::milliseconds HELP_INTERVAL(1);
+
+} // namespace
+
+/*
+  BethYw::TaskScheduler::TaskScheduler(threads)
+
+  Construct a scheduler and start its worker threads, which sleep until
+  tasks are submitted.
+
+  @param threads
+    The number of worker threads; 0 is taken as 1
+
+  @example
+    BethYw::TaskScheduler scheduler(std::thread::hardware_concurrency());
+*/
+BethYw::TaskScheduler::TaskScheduler(unsigned int threads)
+		: queued(0), stopping(false) {
+	threads = std::max(1u, threads);
+	for (unsigned int i = 0; i <= threads; i++){
+		queues.push_back(std::make_unique<Queue>());
+	}
+	for (unsigned int i = 0; i < threads; i++){
+		workers.emplace_back(&TaskScheduler::work, this, i);
+	}
+}
+
+/*
+  BethYw::TaskScheduler::~TaskScheduler()
+
+  Run any tasks still queued, then stop the worker threads.
+*/
+BethYw::TaskScheduler::~TaskScheduler() {
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto& t : workers){
+		t.join();
+	}
+}
+
+/*
+  BethYw::TaskScheduler::getThreads()
+
+  @return
+    The number of worker threads, i.e. the most tasks that run at once
+*/
+unsigned int BethYw::TaskScheduler::getThreads() const noexcept {
+	return static_cast<unsigned int>(queues.size() - 1);
+}
+
+/*
+  BethYw::TaskScheduler::isWorkerThread()
+
+  @return
+    True if the calling thread is one of this scheduler's workers
+*/
+bool BethYw::TaskScheduler::isWorkerThread() const noexcept {
+	return currentScheduler == this;
+}
+
+/*
+  BethYw::TaskScheduler::submit(task)
+
+  Queue a task to be run by a worker. A task submitted by a worker goes on
+  its own queue; others go on the queue shared by the threads outside the
+  pool. Nothing waits for the task or sees its exceptions, so a task that
+  throws ends the program: use a TaskGroup for that.
+
+  @param task
+    The function to run
+
+  @example
+    scheduler.submit([]() { std::cerr << "Hello" << std::endl; });
+*/
+void BethYw::TaskScheduler::submit(std::function<void()> task) {
+	size_t queue = isWorkerThread() ? currentQueue : queues.size() - 1;
+	{
+		std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+		queues[queue]->tasks.push_back(std::move(task));
+	}
+	queued++;
+
+	//taking the lock means a worker is either asleep or will see queued
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+/*
+  BethYw::TaskScheduler::runOne()
+
+  Run one queued task on the calling thread, if it is one of this
+  scheduler's workers. This is how a worker waiting for a TaskGroup helps
+  with the work, rather than sleeping.
+
+  @return
+    True if a task was run, false if there were none or the calling thread
+    is not a worker
+*/
+bool BethYw::TaskScheduler::runOne() {
+	std::function<void()> task;
+	if (!isWorkerThread() || !take(currentQueue, task)){
+		return false;
+	}
+	queued--;
+	task();
+	return true;
+}
+
+//Takes the newest task from queue, or else the oldest task from another queue
+bool BethYw::TaskScheduler::take(size_t queue, std::function<void()>& task) {
+	{
+		Queue& own = *queues[queue];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.tasks.empty()){
+			task = std::move(own.tasks.back());
+			own.tasks.pop_back();
+			return true;
+		}
+	}
+
+	//steal, starting with the next queue so that workers spread out
+	for (size_t i = 1; i < queues.size(); i++){
+		Queue& other = *queues[(queue + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(other.mutex);
+		if (!other.tasks.empty()){
+			task = std::move(other.tasks.front());
+			other.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+//The loop each worker thread runs until the scheduler is destroyed
+void BethYw::TaskScheduler::work(size_t queue) {
+	currentScheduler = this;
+	currentQueue = queue;
+
+	std::function<void()> task;
+	while (true){
+		if (take(queue, task)){
+			queued--;
+			task();
+			task = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [&]() { return queued > 0 || stopping; });
+		if (stopping && queued == 0){
+			return;
+		}
+	}
+}
+
+/*
+  BethYw::TaskScheduler::global()
+
+  Get the scheduler that parallel work should be submitted to: the one
+  installed with a TaskScheduler::Scope (BethYw::run() installs one with the
+  number of threads given by --threads), or else a scheduler with a thread
+  per core, which is started the first time it is needed.
+
+  @return
+    The scheduler to use
+
+  @example
+    BethYw::TaskGroup group(BethYw::TaskScheduler::global());
+*/
+BethYw::TaskScheduler& BethYw::TaskScheduler::global() {
+	TaskScheduler* scheduler = installed;
+	if (scheduler != nullptr){
+		return *scheduler;
+	}
+	static TaskScheduler fallback(std::thread::hardware_concurrency());
+	return fallback;
+}
+
+/*
+  BethYw::TaskScheduler::Scope::Scope(scheduler)
+
+  Install scheduler as the one returned by TaskScheduler::global(), until
+  this Scope is destroyed.
+
+  @param scheduler
+    The scheduler to install, which must outlive this Scope
+
+  @example
+    BethYw::TaskScheduler scheduler(threads);
+    BethYw::TaskScheduler::Scope scope(scheduler);
+*/
+BethYw::TaskScheduler::Scope::Scope(TaskScheduler& scheduler)
+		: previous(installed.exchange(&scheduler)) {
+}
+
+/*
+  BethYw::TaskScheduler::Scope::~Scope()
+
+  Reinstall the scheduler that was installed before this Scope, if any.
+*/
+BethYw::TaskScheduler::Scope::~Scope() {
+	installed = previous;
+}
+
+/*
+  BethYw::TaskGroup::TaskGroup(scheduler)
+
+  Construct an empty group of tasks.
+
+  @param scheduler
+    The scheduler to run the tasks on, by default TaskScheduler::global()
+
+  @example
+    BethYw::TaskGroup group;
+*/
+BethYw::TaskGroup::TaskGroup(TaskScheduler& _scheduler)
+		: scheduler(_scheduler), pending(0), cancelled(false) {
+}
+
+/*
+  BethYw::TaskGroup::~TaskGroup()
+
+  Cancel the tasks that have not started, and wait for the rest, as they may
+  refer to variables that are about to go out of scope (e.g. when an
+  exception is thrown before wait() is called). Their exceptions are lost.
+*/
+BethYw::TaskGroup::~TaskGroup() {
+	cancel();
+	try {
+		wait();
+	} catch (...) {
+	}
+}
+
+/*
+  BethYw::TaskGroup::run(task)
+
+  Submit a task to the scheduler as part of this group. If the group has
+  been cancelled by the time a worker gets to the task, it is skipped.
+
+  @param task
+    The function to run
+
+  @example
+    group.run([&]() { shard.populate(buffer, type, cols); });
+*/
+void BethYw::TaskGroup::run(std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		pending++;
+	}
+	scheduler.submit([this, task = std::move(task)]() {
+		std::exception_ptr taskError;
+		if (!cancelled){
+			try {
+				task();
+			} catch (...) {
+				taskError = std::current_exception();
+			}
+		}
+		finish(taskError);
+	});
+}
+
+//Records that a task has finished, with the exception it threw if any
+void BethYw::TaskGroup::finish(std::exception_ptr taskError) {
+	//notified while locked, so wait() cannot return (and the group be
+	//destroyed) until this is done with it
+	std::lock_guard<std::mutex> lock(mutex);
+	if (taskError && !error){
+		error = taskError;
+		cancelled = true;
+	}
+	if (--pending == 0){
+		done.notify_all();
+	}
+}
+
+/*
+  BethYw::TaskGroup::cancel()
+
+  Skip the tasks in this group that have not started yet. Tasks already
+  running carry on, unless they check isCancelled().
+*/
+void BethYw::TaskGroup::cancel() noexcept {
+	cancelled = true;
+}
+
+/*
+  BethYw::TaskGroup::isCancelled()
+
+  @return
+    True if the group has been cancelled, or a task in it has thrown
+*/
+bool BethYw::TaskGroup::isCancelled() const noexcept {
+	return cancelled;
+}
+
+/*
+  BethYw::TaskGroup::wait()
+
+  Wait until every task submitted to this group has finished or been
+  skipped. A worker thread runs queued tasks (from any group) while it
+  waits; other threads sleep.
+
+  @throws
+    The first exception thrown by a task in the group, if any
+
+  @example
+    group.wait();
+*/
+void BethYw::TaskGroup::wait() {
+	const bool helping = scheduler.isWorkerThread();
+	while (true){
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!helping){
+				done.wait(lock, [&]() { return pending == 0; });
+			}
+			if (pending == 0){
+				break;
+			}
+		}
+		if (!scheduler.runOne()){
+			std::unique_lock<std::mutex> lock(mutex);
+			done.wait_for(lock, HELP_INTERVAL, [&]() { return pending == 0; });
+		}
+	}
+
+	std::exception_ptr taskError;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		std::swap(taskError, error);
+	}
+	if (taskError){
+		std::rethrow_exception(taskError);
+	}
+}
@@ -0,0 +1,126 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations of the TaskScheduler and TaskGroup
+  classes. Rather than each part of Beth Yw? starting its own threads (one
+  per dataset, one per chunk of a large file, ...), which on a shared host
+  could run many more threads than there are cores, all parallel work is
+  submitted as tasks to one pool of worker threads, created by BethYw::run()
+  with the number of threads given by --threads.
+
+  Each worker has its own queue of tasks. A task submitted by a worker goes
+  on that worker's queue, which it works through newest first, so nested
+  work (e.g. the chunks of a file being loaded by a task) stays on one core
+  while it is warm in the cache. A worker that runs out of tasks steals the
+  oldest task from another worker, or takes one submitted from outside the
+  pool, so no worker is idle while there is work queued.
+
+  A worker that waits for a TaskGroup runs other tasks until the group is
+  done, so tasks can wait for tasks they submit without tying up the pool.
+  Other threads (e.g. the main thread) just sleep while they wait, so at
+  most getThreads() threads are ever busy with tasks.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace BethYw {
+
+class TaskScheduler {
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	//one queue per worker, and a last one for tasks from other threads
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<size_t> queued;
+	std::atomic<bool> stopping;
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+
+	bool take(size_t queue, std::function<void()>& task);
+	void work(size_t queue);
+public:
+  explicit TaskScheduler(unsigned int threads);
+  ~TaskScheduler();
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  unsigned int getThreads() const noexcept;
+  bool isWorkerThread() const noexcept;
+
+  void submit(std::function<void()> task);
+  bool runOne();
+
+  static TaskScheduler& global();
+
+  /*
+    Makes a scheduler the one returned by TaskScheduler::global() until the
+    Scope is destroyed, e.g. for the length of BethYw::run().
+  */
+  class Scope {
+  private:
+		TaskScheduler* previous;
+  public:
+    explicit Scope(TaskScheduler& scheduler);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+};
+
+/*
+  A set of tasks that are waited for, and cancelled, together:
+
+    BethYw::TaskGroup group;
+    for (size_t i = 0; i < parts.size(); i++){
+      group.run([&, i]() { results[i] = work(parts[i]); });
+    }
+    group.wait();
+
+  If a task throws, the tasks in the group that have not started yet are
+  cancelled, and wait() rethrows the exception once the rest have finished.
+  Long tasks can check isCancelled() to stop early.
+*/
+class TaskGroup {
+private:
+	TaskScheduler& scheduler;
+	std::mutex mutex;
+	std::condition_variable done;
+	size_t pending;
+	std::atomic<bool> cancelled;
+	std::exception_ptr error;
+
+	void finish(std::exception_ptr taskError);
+public:
+  explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::global());
+  ~TaskGroup();
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  void run(std::function<void()> task);
+  void cancel() noexcept;
+  bool isCancelled() const noexcept;
+  void wait();
+};
+
+} // namespace BethYw
+
+#endif // SCHEDULER_H_
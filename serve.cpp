@@ -0,0 +1,505 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the QueryServer class. See
+  serve.h for the protocol.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "lib_cxxopts.hpp"
+
+#include "bethyw.h"
+#include "filter.h"
+#include "scheduler.h"
+#include "serve.h"
+
+namespace {
+
+//How often the server wakes up to check whether it is stopping
+const int POLL_INTERVAL_MS = 100;
+
+//Connections with nothing to read, write or answer for this long are closed
+const int IDLE_TIMEOUT_MS = 60 * 1000;
+
+//Queries longer than this are rejected, and the connection closed
+const size_t MAX_QUERY_BYTES = 64 * 1024;
+
+//Options that only make sense at startup, so may not be used in a query
+const char* const STARTUP_OPTIONS[] = {"dir", "threads", "serve", "snapshot-read",
+		"snapshot-write", "help"};
+
+//Splits a query into words, as a shell would for arguments without quotes
+std::vector<std::string> splitQuery(const std::string& request) {
+	std::vector<std::string> words;
+	std::istringstream stream(request);
+	std::string word;
+	while (stream >> word){
+		words.push_back(word);
+	}
+	return words;
+}
+
+} // namespace
+
+/*
+  BethYw::QueryServer::QueryServer(dir,
+                                   datasetsToLoad,
+                                   areasFilter,
+                                   measuresFilter,
+                                   yearsFilter,
+                                   threads)
+
+  Import areas.csv and each dataset in datasetsToLoad into its own Areas
+  instance, ready to answer queries. The filters given here limit what can
+  be queried at all, e.g. to serve only some areas.
+
+  @param dir
+    The directory the datasets are in, ending with a directory separator
+
+  @param datasetsToLoad
+    The datasets that queries may ask for
+
+  @param areasFilter, measuresFilter, yearsFilter
+    As for BethYw::loadDatasets()
+
+  @param threads
+    The number of threads to import each dataset with
+
+  @throws
+    std::runtime_error if a dataset cannot be imported
+
+  @example
+    BethYw::QueryServer server("datasets/", BethYw::parseDatasetsArg(args),
+        {}, {}, std::make_tuple(0, 0), 4);
+*/
+BethYw::QueryServer::QueryServer(const std::string& dir,
+		const std::vector<InputFileSource>& datasetsToLoad,
+		const StringFilterSet& areasFilter,
+		const StringFilterSet& measuresFilter,
+		const YearFilterTuple& yearsFilter,
+		unsigned int threads) {
+	BethYw::loadAreas(names, dir, areasFilter);
+	for (const InputFileSource& dataset : datasetsToLoad){
+		Areas data = Areas();
+		BethYw::loadDatasets(data, dir, {dataset}, areasFilter, measuresFilter,
+				yearsFilter, threads);
+		datasets.emplace_back(dataset.CODE, std::move(data));
+	}
+}
+
+/*
+  BethYw::QueryServer::query(request)
+
+  Answer a single query, written like the arguments to bethyw. The data
+  from areas.csv and from each dataset asked for is copied, filtered, into a
+  new Areas instance, exactly as bethyw would import it, and printed as a
+  table or as JSON. A query without -d is answered from every dataset the
+  server loaded.
+
+  @param request
+    The query, e.g. "-d popden -a W06000011 -j"
+
+  @return
+    What bethyw would print to stdout for the same arguments
+
+  @throws
+    std::invalid_argument if the query uses an option other than -d, -a, -m,
+    -y or -j, has other unexpected words, or names a dataset with -d that was
+    not loaded; the exceptions from the BethYw::parse*Arg() functions and from
+    cxxopts are passed on
+
+  @example
+    std::string output = server.query("-a W06000011 -m pop");
+*/
+std::string BethYw::QueryServer::query(const std::string& request) const {
+	//each thread keeps its own parser, as parsing changes the options
+	thread_local cxxopts::Options options = BethYw::cxxoptsSetup();
+
+	std::vector<std::string> words = splitQuery(request);
+	std::vector<char*> argv;
+	std::string program = "bethyw";
+	argv.push_back(&program[0]);
+	for (std::string& word : words){
+		argv.push_back(&word[0]);
+	}
+	int argc = static_cast<int>(argv.size());
+	char** argvData = argv.data();
+	auto args = options.parse(argc, argvData);
+
+	for (const char* option : STARTUP_OPTIONS){
+		if (args.count(option)){
+			throw std::invalid_argument(
+					"Option not allowed in a query: --" + std::string(option));
+		}
+	}
+	if (argc > 1){
+		throw std::invalid_argument(
+				"Unexpected argument in query: " + std::string(argvData[1]));
+	}
+
+	auto areasFilter     = BethYw::parseAreasArg(args);
+	auto measuresFilter  = BethYw::parseMeasuresArg(args);
+	auto yearsFilter     = BethYw::parseYearsArg(args);
+
+	//without -d, a query is answered from every dataset the server loaded,
+	//rather than every dataset bethyw knows of
+	std::vector<const Areas*> datasetsToQuery;
+	if (args.count("datasets")){
+		for (const InputFileSource& dataset : BethYw::parseDatasetsArg(args)){
+			auto it = datasets.begin();
+			while (it != datasets.end() && it->first != dataset.CODE){
+				it++;
+			}
+			if (it == datasets.end()){
+				throw std::invalid_argument("Dataset not loaded by server: " + dataset.CODE);
+			}
+			datasetsToQuery.push_back(&it->second);
+		}
+	} else {
+		for (const auto& dataset : datasets){
+			datasetsToQuery.push_back(&dataset.second);
+		}
+	}
+
+	//areas.csv is only filtered by area, as in BethYw::loadAreas()
+	Areas result = Areas();
+	result.merge(names, RecordFilter(&areasFilter, nullptr, nullptr));
+
+	RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+	for (const Areas* data : datasetsToQuery){
+		result.merge(*data, filter);
+	}
+
+	std::ostringstream output;
+	if (args.count("json")){
+		result.writeJSON(output);
+	} else {
+		output << result;
+	}
+	output << '\n';
+	return output.str();
+}
+
+#ifdef _WIN32
+
+void BethYw::QueryServer::serve(const std::string&, unsigned int,
+		const std::atomic<bool>&) const {
+	throw std::runtime_error("BethYw::QueryServer::serve: UNIX domain sockets are not supported on Windows");
+}
+
+#else
+
+namespace {
+
+/*
+  A client connection, as seen by the thread running serve(). Only that
+  thread touches a Connection; the answer to a query comes back to it as an
+  Answer, matched up by id (fds are reused, ids are not).
+*/
+struct Connection {
+	int fd;
+	//received but not yet answered, and answered but not yet sent
+	std::string input;
+	std::string output;
+	//a query from this connection is being answered; queries from one
+	//connection are answered one at a time, so responses stay in order
+	bool busy;
+	//close once output has been sent
+	bool closing;
+	std::chrono::steady_clock::time_point lastActive;
+};
+
+struct Answer {
+	uint64_t connection;
+	std::string response;
+};
+
+//Sets fd not to block on reads and writes
+void setNonBlocking(int fd) {
+	int flags = ::fcntl(fd, F_GETFL, 0);
+	if (flags >= 0){
+		::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+	}
+}
+
+//Formats a response with its header (see serve.h)
+std::string response(const std::string& status, const std::string& body) {
+	return status + " " + std::to_string(body.size()) + "\n" + body;
+}
+
+//Reads whatever has arrived on a connection, returning false if the client
+//has closed it or it has failed
+bool receive(Connection& connection) {
+	char chunk[4096];
+	while (true){
+		ssize_t n = ::recv(connection.fd, chunk, sizeof(chunk), 0);
+		if (n > 0){
+			connection.input.append(chunk, static_cast<size_t>(n));
+			connection.lastActive = std::chrono::steady_clock::now();
+			if (connection.input.size() > MAX_QUERY_BYTES){
+				return true;
+			}
+			continue;
+		}
+		if (n < 0 && errno == EINTR){
+			continue;
+		}
+		return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+}
+
+//Sends as much of a connection's output as it will take, returning false if
+//the client has gone away
+bool transmit(Connection& connection) {
+	while (!connection.output.empty()){
+		ssize_t n = ::send(connection.fd, connection.output.data(), connection.output.size(),
+				MSG_NOSIGNAL);
+		if (n > 0){
+			connection.output.erase(0, static_cast<size_t>(n));
+			connection.lastActive = std::chrono::steady_clock::now();
+			continue;
+		}
+		if (n < 0 && errno == EINTR){
+			continue;
+		}
+		return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+	}
+	return true;
+}
+
+} // namespace
+
+/*
+  BethYw::QueryServer::serve(socketPath, threads, stopping)
+
+  Listen on a UNIX domain socket and answer queries (see serve.h) until
+  stopping becomes true. Every connection is watched by the calling thread
+  with poll(), which reads queries and writes responses without blocking,
+  so an idle or slow client never holds up anyone else. Only complete
+  query lines are handed on, as tasks on BethYw::TaskScheduler::global().
+  A connection that has sent nothing and been sent nothing for
+  IDLE_TIMEOUT_MS, while it has no query being answered, is closed.
+
+  An existing socket at socketPath (e.g. left by a server that crashed) is
+  replaced, and the socket is removed again when the server stops.
+
+  @param socketPath
+    The path to create the socket at
+
+  @param threads
+    The most queries to answer at once; complete queries beyond that wait
+    until one finishes
+
+  @param stopping
+    Set to true (e.g. from a signal handler) to stop the server; it is
+    checked several times a second
+
+  @return
+    void
+
+  @throws
+    std::runtime_error if the socket cannot be created, with the message:
+    BethYw::QueryServer::serve: Failed to listen on <socketPath>
+
+  @example
+    std::atomic<bool> stopping(false);
+    server.serve("/tmp/bethyw.sock", 4, stopping);
+*/
+void BethYw::QueryServer::serve(const std::string& socketPath,
+		unsigned int threads,
+		const std::atomic<bool>& stopping) const {
+	const std::string error = "BethYw::QueryServer::serve: Failed to listen on " + socketPath;
+
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+	if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)){
+		throw std::runtime_error(error);
+	}
+	socketPath.copy(address.sun_path, socketPath.size());
+
+	//only replace a socket, never some other file
+	struct stat info;
+	if (::stat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)){
+		::unlink(socketPath.c_str());
+	}
+
+	int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0){
+		throw std::runtime_error(error);
+	}
+	//tasks finishing a query write a byte here to wake up poll()
+	int wake[2];
+	if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+			|| ::listen(listener, SOMAXCONN) != 0 || ::pipe(wake) != 0){
+		::close(listener);
+		throw std::runtime_error(error);
+	}
+	setNonBlocking(listener);
+	setNonBlocking(wake[0]);
+	setNonBlocking(wake[1]);
+
+	std::map<uint64_t, Connection> connections;
+	uint64_t nextId = 0;
+	const unsigned int maxAnswering = std::max(1u, threads);
+	unsigned int answering = 0;
+
+	std::mutex answersMutex;
+	std::vector<Answer> answers;
+	TaskGroup queries;
+
+	std::vector<pollfd> waiting;
+	std::vector<uint64_t> waitingIds;
+	while (!stopping){
+		waiting.assign({{listener, POLLIN, 0}, {wake[0], POLLIN, 0}});
+		waitingIds.clear();
+		for (auto& entry : connections){
+			const Connection& connection = entry.second;
+			//stop reading from a connection that is far enough ahead
+			short events = connection.closing || connection.input.size() > MAX_QUERY_BYTES
+					? 0 : POLLIN;
+			if (!connection.output.empty()){
+				events |= POLLOUT;
+			}
+			waiting.push_back({connection.fd, events, 0});
+			waitingIds.push_back(entry.first);
+		}
+
+		int ready = ::poll(waiting.data(), waiting.size(), POLL_INTERVAL_MS);
+		if (ready < 0 && errno != EINTR){
+			break;
+		}
+		const auto now = std::chrono::steady_clock::now();
+
+		//collect answered queries
+		if (waiting[1].revents & POLLIN){
+			char drain[256];
+			while (::read(wake[0], drain, sizeof(drain)) > 0){
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(answersMutex);
+			for (Answer& answer : answers){
+				answering--;
+				auto it = connections.find(answer.connection);
+				//the client may have gone away in the meantime
+				if (it != connections.end()){
+					it->second.output += answer.response;
+					it->second.busy = false;
+					it->second.lastActive = now;
+				}
+			}
+			answers.clear();
+		}
+
+		if (waiting[0].revents & POLLIN){
+			int fd;
+			while ((fd = ::accept(listener, nullptr, nullptr)) >= 0){
+				setNonBlocking(fd);
+				connections[nextId++] = Connection{fd, "", "", false, false, now};
+			}
+		}
+
+		//read and write whatever is ready
+		for (size_t i = 0; i < waitingIds.size(); i++){
+			auto it = connections.find(waitingIds[i]);
+			Connection& connection = it->second;
+			const short revents = waiting[i + 2].revents;
+			bool open = true;
+			if (revents & (POLLIN | POLLHUP | POLLERR)){
+				open = receive(connection);
+			}
+			if (open && (revents & POLLOUT)){
+				open = transmit(connection);
+			}
+			if (!open || (connection.closing && connection.output.empty())){
+				::close(connection.fd);
+				connections.erase(it);
+			}
+		}
+
+		//hand on complete queries, and close idle connections
+		for (auto it = connections.begin(); it != connections.end();){
+			Connection& connection = it->second;
+			const size_t newline = connection.input.find('\n');
+			const size_t length = std::min(newline, connection.input.size());
+			if (!connection.busy && !connection.closing && length > MAX_QUERY_BYTES){
+				connection.output += response("ERROR", "Query too long");
+				connection.input.clear();
+				connection.closing = true;
+				transmit(connection);
+			} else if (!connection.busy && !connection.closing && newline != std::string::npos
+					&& answering < maxAnswering){
+				std::string request = connection.input.substr(0, newline);
+				connection.input.erase(0, newline + 1);
+				if (!request.empty() && request.back() == '\r'){
+					request.pop_back();
+				}
+				connection.busy = true;
+				answering++;
+				const uint64_t id = it->first;
+				const int wakeFd = wake[1];
+				queries.run([this, id, wakeFd, request, &answersMutex, &answers]() {
+					std::string answer;
+					try {
+						answer = response("OK", query(request));
+					} catch (const std::exception& e) {
+						answer = response("ERROR", e.what());
+					}
+					{
+						std::lock_guard<std::mutex> lock(answersMutex);
+						answers.push_back(Answer{id, std::move(answer)});
+					}
+					const char byte = 0;
+					ssize_t written = ::write(wakeFd, &byte, 1);
+					(void) written;
+				});
+			}
+
+			if ((!connection.busy && now - connection.lastActive
+						> std::chrono::milliseconds(IDLE_TIMEOUT_MS))
+					|| (connection.closing && connection.output.empty())){
+				::close(connection.fd);
+				it = connections.erase(it);
+			} else {
+				it++;
+			}
+		}
+	}
+
+	queries.wait();
+	for (auto& entry : connections){
+		::close(entry.second.fd);
+	}
+	::close(listener);
+	::close(wake[0]);
+	::close(wake[1]);
+	::unlink(socketPath.c_str());
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef SERVE_H_
+#define SERVE_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the QueryServer class, which backs
+  the --serve mode of Beth Yw?. The datasets are imported once, and queries
+  are then answered from memory over a UNIX domain socket, rather than every
+  query starting a new process that parses every file again.
+
+  Protocol: a client connects to the socket and sends one query per line.
+  A query is written exactly like the arguments to bethyw, but only -d, -a,
+  -m, -y and -j (and their long forms) are allowed, e.g.
+
+    -d popden -a W06000011,W06000012 -m pop -y 2010-2015 -j
+
+  Each query gets one response, a header line followed by a body:
+
+    OK <length>\n<body>      the body is what bethyw would print to stdout
+    ERROR <length>\n<body>   the body is the error message
+
+  where <length> is the number of bytes in the body. A connection can send
+  any number of queries, one after another, and is closed by the client, or
+  by the server once it has been idle for a minute.
+ */
+
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "areas.h"
+#include "datasets.h"
+
+namespace BethYw {
+
+/*
+  Holds the data imported from areas.csv and from each dataset separately,
+  so that queries can pick datasets as well as filter them. All functions
+  are const apart from construction, so queries can be answered on several
+  threads at once.
+*/
+class QueryServer {
+private:
+	Areas names;
+	std::vector<std::pair<std::string, Areas>> datasets;
+
+public:
+  QueryServer(const std::string& dir,
+              const std::vector<InputFileSource>& datasetsToLoad,
+              const StringFilterSet& areasFilter,
+              const StringFilterSet& measuresFilter,
+              const YearFilterTuple& yearsFilter,
+              unsigned int threads);
+  QueryServer(const QueryServer&) = delete;
+  QueryServer& operator=(const QueryServer&) = delete;
+
+  std::string query(const std::string& request) const;
+  void serve(const std::string& socketPath,
+             unsigned int threads,
+             const std::atomic<bool>& stopping) const;
+};
+
+} // namespace BethYw
+
+#endif // SERVE_H_
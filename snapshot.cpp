@@ -0,0 +1,380 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the code for writing and reading binary snapshots of an
+  Areas instance. See snapshot.h for the layout of the file.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "area.h"
+#include "intern.h"
+#include "measure.h"
+#include "snapshot.h"
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'B', 'Y', 'W', 'S', 'N', 'A', 'P', '\0'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const size_t COLUMN_ALIGNMENT = 8;
+
+struct SnapshotHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t stringCount;
+	uint32_t areaCount;
+	uint32_t nameCount;
+	uint32_t measureCount;
+	uint64_t valueCount;
+	uint64_t stringBytes;
+};
+static_assert(sizeof(SnapshotHeader) % COLUMN_ALIGNMENT == 0,
+		"the first column must start on an aligned boundary");
+
+//Gives each global string ID used in a snapshot an index into its own string table
+class SnapshotStrings {
+private:
+	std::unordered_map<InternId, uint32_t> indexes;
+public:
+	std::vector<uint32_t> offsets{0};
+	std::string data;
+
+	uint32_t index(InternId id) {
+		auto it = indexes.try_emplace(id, (uint32_t) indexes.size());
+		if (it.second){
+			data += InternTable::global().lookup(id);
+			offsets.push_back((uint32_t) data.size());
+		}
+		return it.first->second;
+	}
+
+	uint32_t size() const noexcept {
+		return (uint32_t) indexes.size();
+	}
+};
+
+//Writes columns to a stream, padding each one to an aligned boundary
+class SnapshotWriter {
+private:
+	std::ostream& os;
+	uint64_t written;
+public:
+	SnapshotWriter(std::ostream& os) : os(os), written(0) {}
+
+	void bytes(const void* data, size_t size) {
+		os.write(static_cast<const char*>(data), size);
+		written += size;
+		const char padding[COLUMN_ALIGNMENT] = {};
+		size_t extra = written % COLUMN_ALIGNMENT;
+		if (extra != 0){
+			os.write(padding, COLUMN_ALIGNMENT - extra);
+			written += COLUMN_ALIGNMENT - extra;
+		}
+	}
+
+	template <typename T>
+	void column(const std::vector<T>& values) {
+		bytes(values.data(), values.size() * sizeof(T));
+	}
+};
+
+//Hands out views of the columns in a snapshot, checking each one is in bounds
+class SnapshotReader {
+private:
+	std::string_view buffer;
+	size_t pos;
+public:
+	SnapshotReader(std::string_view buffer) : buffer(buffer), pos(0) {}
+
+	template <typename T>
+	const T* column(uint64_t count) {
+		if (reinterpret_cast<uintptr_t>(buffer.data() + pos) % alignof(T) != 0){
+			throw std::runtime_error("BethYw::readSnapshot: Misaligned snapshot");
+		}
+		if (count > (buffer.size() - pos) / sizeof(T)){
+			throw std::runtime_error("BethYw::readSnapshot: Truncated snapshot");
+		}
+		const T* values = reinterpret_cast<const T*>(buffer.data() + pos);
+		pos += count * sizeof(T);
+		pos += (COLUMN_ALIGNMENT - pos % COLUMN_ALIGNMENT) % COLUMN_ALIGNMENT;
+		pos = std::min(pos, buffer.size());
+		return values;
+	}
+};
+
+//Checks that a column of end offsets never decreases and finishes at total
+void checkEnds(const uint32_t* ends, uint32_t count, uint64_t total) {
+	uint64_t previous = 0;
+	for (uint32_t i = 0; i < count; i++){
+		if (ends[i] < previous || ends[i] > total){
+			throw std::runtime_error("BethYw::readSnapshot: Corrupt snapshot");
+		}
+		previous = ends[i];
+	}
+	if (previous != total){
+		throw std::runtime_error("BethYw::readSnapshot: Corrupt snapshot");
+	}
+}
+
+//Checks that a column of string indexes only refers to strings in the table
+void checkIndexes(const uint32_t* indexes, uint32_t count, uint32_t stringCount) {
+	for (uint32_t i = 0; i < count; i++){
+		if (indexes[i] >= stringCount){
+			throw std::runtime_error("BethYw::readSnapshot: Corrupt snapshot");
+		}
+	}
+}
+
+} // namespace
+
+/*
+  BethYw::writeSnapshot(os, areas)
+
+  Write every Area, name, Measure and reading in an Areas instance to a
+  stream as a binary snapshot, which can be loaded again with
+  BethYw::readSnapshot(). Only the strings the Areas instance uses are
+  written, not the whole InternTable.
+
+  @param os
+    The stream to write to, which should be opened in binary mode
+
+  @param areas
+    The Areas instance to save
+
+  @return
+    void
+
+  @throws
+    std::runtime_error if the stream could not be written to
+
+  @example
+    std::ofstream file("popden.snapshot", std::ios::binary);
+    BethYw::writeSnapshot(file, areas);
+*/
+void BethYw::writeSnapshot(std::ostream& os, const Areas& areas) {
+	SnapshotStrings strings;
+	std::vector<uint32_t> areaCodes, areaNameEnds, areaMeasureEnds;
+	std::vector<uint32_t> nameLangs, nameValues;
+	std::vector<uint32_t> measureCodes, measureLabels;
+	std::vector<int32_t> measureFirstYears;
+	std::vector<uint64_t> measureValueEnds;
+	std::vector<double> values;
+	std::vector<unsigned char> present;
+
+	//flatten the tree into columns, in the same order as it is stored
+	for (const auto& codeArea : areas.getAreas()){
+		const Area& area = codeArea.second;
+		areaCodes.push_back(strings.index(codeArea.first));
+
+		for (const auto& langName : area.getNamesById()){
+			nameLangs.push_back(strings.index(langName.first));
+			nameValues.push_back(strings.index(langName.second));
+		}
+		areaNameEnds.push_back((uint32_t) nameLangs.size());
+
+		for (const auto& codeMeasure : area.getMeasuresById()){
+			const Measure& measure = codeMeasure.second;
+			measureCodes.push_back(strings.index(codeMeasure.first));
+			measureLabels.push_back(strings.index(measure.getLabelId()));
+			measureFirstYears.push_back(measure.getFirstYear());
+
+			const std::vector<double>& dense = measure.getDenseValues();
+			values.insert(values.end(), dense.begin(), dense.end());
+			for (size_t i = 0; i < dense.size(); i++){
+				present.push_back(measure.hasValue(measure.getFirstYear() + (int) i));
+			}
+			measureValueEnds.push_back(values.size());
+		}
+		areaMeasureEnds.push_back((uint32_t) measureCodes.size());
+	}
+
+	SnapshotHeader header = {};
+	std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version = SNAPSHOT_VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.stringCount = strings.size();
+	header.areaCount = (uint32_t) areaCodes.size();
+	header.nameCount = (uint32_t) nameLangs.size();
+	header.measureCount = (uint32_t) measureCodes.size();
+	header.valueCount = values.size();
+	header.stringBytes = strings.data.size();
+
+	SnapshotWriter writer(os);
+	writer.bytes(&header, sizeof(header));
+	writer.column(strings.offsets);
+	writer.bytes(strings.data.data(), strings.data.size());
+	writer.column(areaCodes);
+	writer.column(areaNameEnds);
+	writer.column(areaMeasureEnds);
+	writer.column(nameLangs);
+	writer.column(nameValues);
+	writer.column(measureCodes);
+	writer.column(measureLabels);
+	writer.column(measureFirstYears);
+	writer.column(measureValueEnds);
+	writer.column(values);
+	writer.column(present);
+
+	if (!os){
+		throw std::runtime_error("BethYw::writeSnapshot: Failed to write snapshot");
+	}
+}
+
+/*
+  BethYw::readSnapshot(buffer, areas, filter)
+
+  Load a snapshot written by BethYw::writeSnapshot() into an Areas instance,
+  e.g. from the view returned by InputMmapFile::open(). The data is merged
+  with anything already in areas, as with Areas::populate().
+
+  If a filter is given, areas and measures that fail it are skipped, and
+  only the years it keeps are loaded. Measures left with no readings are
+  skipped too.
+
+  @param buffer
+    The whole snapshot, which must start on an 8 byte boundary (as mapped
+    files and heap buffers do)
+
+  @param areas
+    The Areas instance to load into
+
+  @param filter
+    The filters to apply, or nullptr to load everything
+
+  @return
+    void
+
+  @throws
+    std::runtime_error if the buffer is not a snapshot, was written by a
+    different version or on a machine with a different byte order, or is
+    truncated or corrupt
+
+  @example
+    InputMmapFile input("popden.snapshot");
+
+    Areas areas = Areas();
+    BethYw::readSnapshot(input.open(), areas);
+*/
+void BethYw::readSnapshot(
+    std::string_view buffer,
+    Areas& areas,
+    const RecordFilter * const filter) {
+	SnapshotReader reader(buffer);
+	if (buffer.size() < sizeof(SnapshotHeader)){
+		throw std::runtime_error("BethYw::readSnapshot: Not a snapshot");
+	}
+	const SnapshotHeader& header = *reader.column<SnapshotHeader>(1);
+	if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0){
+		throw std::runtime_error("BethYw::readSnapshot: Not a snapshot");
+	}
+	if (header.byteOrder != BYTE_ORDER_MARK){
+		throw std::runtime_error("BethYw::readSnapshot: Snapshot has a different byte order");
+	}
+	if (header.version != SNAPSHOT_VERSION){
+		throw std::runtime_error("BethYw::readSnapshot: Unsupported snapshot version "
+				+ std::to_string(header.version));
+	}
+
+	const uint32_t* stringOffsets = reader.column<uint32_t>((uint64_t) header.stringCount + 1);
+	const char* stringData = reader.column<char>(header.stringBytes);
+	const uint32_t* areaCodes = reader.column<uint32_t>(header.areaCount);
+	const uint32_t* areaNameEnds = reader.column<uint32_t>(header.areaCount);
+	const uint32_t* areaMeasureEnds = reader.column<uint32_t>(header.areaCount);
+	const uint32_t* nameLangs = reader.column<uint32_t>(header.nameCount);
+	const uint32_t* nameValues = reader.column<uint32_t>(header.nameCount);
+	const uint32_t* measureCodes = reader.column<uint32_t>(header.measureCount);
+	const uint32_t* measureLabels = reader.column<uint32_t>(header.measureCount);
+	const int32_t* measureFirstYears = reader.column<int32_t>(header.measureCount);
+	const uint64_t* measureValueEnds = reader.column<uint64_t>(header.measureCount);
+	const double* values = reader.column<double>(header.valueCount);
+	const unsigned char* present = reader.column<unsigned char>(header.valueCount);
+
+	//check every offset and index before following any of them
+	if (stringOffsets[0] != 0){
+		throw std::runtime_error("BethYw::readSnapshot: Corrupt snapshot");
+	}
+	checkEnds(stringOffsets + 1, header.stringCount, header.stringBytes);
+	checkEnds(areaNameEnds, header.areaCount, header.nameCount);
+	checkEnds(areaMeasureEnds, header.areaCount, header.measureCount);
+	uint64_t previousEnd = 0;
+	for (uint32_t i = 0; i < header.measureCount; i++){
+		if (measureValueEnds[i] < previousEnd || measureValueEnds[i] > header.valueCount){
+			throw std::runtime_error("BethYw::readSnapshot: Corrupt snapshot");
+		}
+		previousEnd = measureValueEnds[i];
+	}
+	checkIndexes(areaCodes, header.areaCount, header.stringCount);
+	checkIndexes(nameLangs, header.nameCount, header.stringCount);
+	checkIndexes(nameValues, header.nameCount, header.stringCount);
+	checkIndexes(measureCodes, header.measureCount, header.stringCount);
+	checkIndexes(measureLabels, header.measureCount, header.stringCount);
+
+	//each distinct string is interned once, not once per use
+	InternTable& strings = InternTable::global();
+	std::vector<InternId> ids(header.stringCount);
+	for (uint32_t i = 0; i < header.stringCount; i++){
+		ids[i] = strings.intern(std::string_view(stringData + stringOffsets[i],
+				stringOffsets[i + 1] - stringOffsets[i]));
+	}
+
+	uint32_t nameBegin = 0;
+	uint32_t measureBegin = 0;
+	for (uint32_t a = 0; a < header.areaCount; a++){
+		uint32_t nameEnd = areaNameEnds[a];
+		uint32_t measureEnd = areaMeasureEnds[a];
+		if (filter != nullptr && !filter->keepArea(ids[areaCodes[a]])){
+			nameBegin = nameEnd;
+			measureBegin = measureEnd;
+			continue;
+		}
+
+		Area area(ids[areaCodes[a]]);
+		for (uint32_t n = nameBegin; n < nameEnd; n++){
+			area.setName(ids[nameLangs[n]], ids[nameValues[n]]);
+		}
+
+		for (uint32_t m = measureBegin; m < measureEnd; m++){
+			if (filter != nullptr && !filter->keepMeasure(ids[measureCodes[m]])){
+				continue;
+			}
+			uint64_t valueBegin = m == 0 ? 0 : measureValueEnds[m - 1];
+			size_t first = 0;
+			size_t slots = measureValueEnds[m] - valueBegin;
+
+			//the year filter is a range, so it keeps a contiguous run of slots
+			if (filter != nullptr){
+				while (first < slots && !filter->keepYear(measureFirstYears[m] + (int) first)){
+					first++;
+				}
+				while (slots > first && !filter->keepYear(measureFirstYears[m] + (int) slots - 1)){
+					slots--;
+				}
+			}
+
+			Measure measure(ids[measureCodes[m]], ids[measureLabels[m]]);
+			measure.setDenseValues(measureFirstYears[m] + (int) first,
+					values + valueBegin + first, present + valueBegin + first, slots - first);
+			if (measure.size() > 0){
+				area.setMeasure(ids[measureCodes[m]], std::move(measure));
+			}
+		}
+
+		areas.setArea(ids[areaCodes[a]], std::move(area));
+		nameBegin = nameEnd;
+		measureBegin = measureEnd;
+	}
+}
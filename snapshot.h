@@ -0,0 +1,59 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations for saving a populated Areas instance to
+  a binary snapshot and loading it back. Loading a snapshot is much faster
+  than parsing the text datasets again: there is no text to tokenise or
+  convert, each distinct string is interned once, and the readings for each
+  Measure are copied straight out of a dense array in the mapped file.
+
+  A snapshot is laid out in columns, all in the byte order of the machine that
+  wrote it (the header records it, and a snapshot from a machine with a
+  different byte order is rejected). The sections follow one another, and
+  every column in them starts on an 8 byte boundary:
+
+    header       magic "BYWSNAP", version, byte order mark, and the number of
+                 strings, areas, names, measures and value slots
+    strings      stringCount + 1 uint32 offsets into the character data that
+                 follows them; each string is referred to by its index
+    areas        areaCount uint32 code indexes, then areaCount uint32 ends
+                 into the names columns and areaCount uint32 ends into the
+                 measures columns
+    names        nameCount uint32 language indexes and nameCount uint32 name
+                 indexes
+    measures     measureCount uint32 code indexes, label indexes, int32 first
+                 years, and uint64 ends into the value columns
+    values       valueCount doubles, one per year from each measure's first
+                 year, then valueCount bytes that are non-zero where there is
+                 a reading
+
+  SNAPSHOT_VERSION changes whenever the layout does.
+ */
+
+#include <ostream>
+#include <string_view>
+
+#include "areas.h"
+#include "filter.h"
+
+namespace BethYw {
+
+constexpr unsigned int SNAPSHOT_VERSION = 1;
+
+void writeSnapshot(std::ostream& os, const Areas& areas);
+
+void readSnapshot(
+    std::string_view buffer,
+    Areas& areas,
+    const RecordFilter * const filter = nullptr) noexcept(false);
+
+} // namespace BethYw
+
+#endif // SNAPSHOT_H_
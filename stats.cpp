@@ -0,0 +1,231 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the --stats report. See stats.h
+  for details.
+*/
+
+#include "jsonwriter.h"
+#include "stats.h"
+#include "tablewriter.h"
+
+namespace {
+
+//Widths of the name column and the figures columns of the table
+const size_t NAME_WIDTH = 16;
+const size_t FIGURE_WIDTH = 11;
+
+const char* const HEADINGS[] = {"Bytes", "Parsed", "Filtered", "Merged",
+		"Open ms", "Parse ms", "Merge ms", "Wall ms"};
+
+//Writes the first cell of a row, which is left-aligned unlike the others
+void writeName(TableWriter& writer, const std::string& name) {
+	writer.text(name);
+	if (name.size() < NAME_WIDTH){
+		writer.text("", NAME_WIDTH - name.size());
+	}
+}
+
+//Writes one row of the table
+void writeRow(TableWriter& writer, const BethYw::ImportStats& stats) {
+	writeName(writer, stats.name);
+	writer.text(std::to_string(stats.bytesRead), FIGURE_WIDTH);
+	writer.text(std::to_string(stats.recordsParsed), FIGURE_WIDTH);
+	writer.text(std::to_string(stats.recordsFiltered), FIGURE_WIDTH);
+	writer.text(std::to_string(stats.recordsMerged), FIGURE_WIDTH);
+	writer.number(stats.openMs, FIGURE_WIDTH);
+	writer.number(stats.parseMs, FIGURE_WIDTH);
+	writer.number(stats.mergeMs, FIGURE_WIDTH);
+	writer.number(stats.wallMs(), FIGURE_WIDTH);
+	writer.text("\n");
+}
+
+//Writes the figures of one import as the members of a JSON object
+void writeFigures(JSONWriter& writer, const BethYw::ImportStats& stats) {
+	writer.key("bytesRead");
+	writer.integer(stats.bytesRead);
+	writer.key("recordsParsed");
+	writer.integer(stats.recordsParsed);
+	writer.key("recordsFiltered");
+	writer.integer(stats.recordsFiltered);
+	writer.key("recordsMerged");
+	writer.integer(stats.recordsMerged);
+	writer.key("openMs");
+	writer.value(stats.openMs);
+	writer.key("parseMs");
+	writer.value(stats.parseMs);
+	writer.key("mergeMs");
+	writer.value(stats.mergeMs);
+	writer.key("wallMs");
+	writer.value(stats.wallMs());
+}
+
+//Adds up the figures of every import
+BethYw::ImportStats total(const std::vector<BethYw::ImportStats>& imports) {
+	BethYw::ImportStats sum;
+	sum.name = "Total";
+	for (const BethYw::ImportStats& stats : imports){
+		sum.add(stats);
+	}
+	return sum;
+}
+
+} // namespace
+
+/*
+  BethYw::ImportStats::add(other)
+
+  Add the figures of another import (e.g. of one part of a file parsed on
+  another thread) to these. The name is left as it is.
+
+  @param other
+    The figures to add
+*/
+void BethYw::ImportStats::add(const ImportStats& other) {
+	bytesRead += other.bytesRead;
+	recordsParsed += other.recordsParsed;
+	recordsFiltered += other.recordsFiltered;
+	recordsMerged += other.recordsMerged;
+	openMs += other.openMs;
+	parseMs += other.parseMs;
+	mergeMs += other.mergeMs;
+}
+
+/*
+  BethYw::ImportStats::wallMs()
+
+  @return
+    The total time spent importing, i.e. opening, parsing and merging
+*/
+double BethYw::ImportStats::wallMs() const {
+	return openMs + parseMs + mergeMs;
+}
+
+/*
+  BethYw::RunStats::writeTable(os)
+
+  Write the report as a table, with a row for each import, a row of totals
+  and a line for the output.
+
+  @param os
+    The stream to write to, normally std::cerr
+
+  @example
+    stats.writeTable(std::cerr);
+*/
+void BethYw::RunStats::writeTable(std::ostream& os) const {
+	TableWriter writer(os);
+	writeName(writer, "Import");
+	for (const char* heading : HEADINGS){
+		writer.text(heading, FIGURE_WIDTH);
+	}
+	writer.text("\n");
+	for (const ImportStats& stats : imports){
+		writeRow(writer, stats);
+	}
+	writeRow(writer, total(imports));
+	writer.text("Output " + std::to_string(outputBytes) + " bytes, format ms ");
+	writer.number(formatMs, 0);
+	writer.text(", run ms ");
+	writer.number(runMs, 0);
+	writer.text("\n");
+}
+
+/*
+  BethYw::RunStats::writeJSON(os)
+
+  Write the report as a JSON object, with an object for each import keyed by
+  its name, the totals, and the output.
+
+  @param os
+    The stream to write to, normally std::cerr
+
+  @example
+    stats.writeJSON(std::cerr);
+    // {"imports":{"areas":{"bytesRead":1234,...},...},"total":{...},
+    //  "format":{"outputBytes":5678,"formatMs":0.25},"runMs":12.5}
+*/
+void BethYw::RunStats::writeJSON(std::ostream& os) const {
+	JSONWriter writer(os);
+	writer.beginObject();
+	writer.key("imports");
+	writer.beginObject();
+	for (const ImportStats& stats : imports){
+		writer.key(stats.name);
+		writer.beginObject();
+		writeFigures(writer, stats);
+		writer.endObject();
+	}
+	writer.endObject();
+	writer.key("total");
+	writer.beginObject();
+	writeFigures(writer, total(imports));
+	writer.endObject();
+	writer.key("format");
+	writer.beginObject();
+	writer.key("outputBytes");
+	writer.integer(outputBytes);
+	writer.key("formatMs");
+	writer.value(formatMs);
+	writer.endObject();
+	writer.key("runMs");
+	writer.value(runMs);
+	writer.endObject();
+	writer.flush();
+	os << '\n';
+}
+
+BethYw::Stopwatch::Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+//Starts measuring again from now
+void BethYw::Stopwatch::restart() {
+	start = std::chrono::steady_clock::now();
+}
+
+//Returns the milliseconds since construction or the last restart()
+double BethYw::Stopwatch::elapsedMs() const {
+	std::chrono::duration<double, std::milli> elapsed =
+			std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+BethYw::CountingStreamBuf::CountingStreamBuf(std::streambuf* _target)
+		: target(_target), count(0) {}
+
+//Passes a single character on
+BethYw::CountingStreamBuf::int_type BethYw::CountingStreamBuf::overflow(int_type c) {
+	if (traits_type::eq_int_type(c, traits_type::eof())){
+		return traits_type::not_eof(c);
+	}
+	if (traits_type::eq_int_type(target->sputc(traits_type::to_char_type(c)),
+			traits_type::eof())){
+		return traits_type::eof();
+	}
+	count++;
+	return c;
+}
+
+//Passes a block of characters on in one go
+std::streamsize BethYw::CountingStreamBuf::xsputn(const char* s, std::streamsize n) {
+	std::streamsize written = target->sputn(s, n);
+	if (written > 0){
+		count += static_cast<size_t>(written);
+	}
+	return written;
+}
+
+int BethYw::CountingStreamBuf::sync() {
+	return target->pubsync();
+}
+
+//Returns the number of bytes passed on so far
+size_t BethYw::CountingStreamBuf::bytes() const noexcept {
+	return count;
+}
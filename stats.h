@@ -0,0 +1,103 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations for the --stats report, which shows
+  where the time of a run goes: opening each file, parsing it, merging it
+  into the imported data, and formatting the output.
+
+  Nothing is measured unless --stats is given. The loading functions and
+  parsers take a pointer to somewhere to record their figures, which is null
+  when there is nothing to record; the parsers count records in local
+  variables either way and only store them at the end.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace BethYw {
+
+/*
+  The figures for importing one file. A record is a row of the file, e.g. a
+  row of the "value" array of a StatsWales export or a line of a CSV file.
+  A record is filtered out if none of it is kept (rows without a value are
+  counted here too). recordsMerged counts the values stored, so it may
+  exceed recordsParsed for CSV files with a column per year.
+*/
+struct ImportStats {
+  std::string name;
+  size_t bytesRead = 0;
+  size_t recordsParsed = 0;
+  size_t recordsFiltered = 0;
+  size_t recordsMerged = 0;
+  double openMs = 0;
+  double parseMs = 0;
+  double mergeMs = 0;
+
+  void add(const ImportStats& other);
+  double wallMs() const;
+};
+
+/*
+  The figures for a whole run: one ImportStats per file imported, in the
+  order they were imported, and the output. Files imported on several
+  threads at once overlap, so runMs may be less than the total of their
+  times.
+*/
+struct RunStats {
+  std::vector<ImportStats> imports;
+  double formatMs = 0;
+  size_t outputBytes = 0;
+  double runMs = 0;
+
+  void writeTable(std::ostream& os) const;
+  void writeJSON(std::ostream& os) const;
+};
+
+/*
+  Measures the wall time since it was constructed, or since restart().
+
+    Stopwatch timer;
+    ...
+    stats.parseMs = timer.elapsedMs();
+*/
+class Stopwatch {
+private:
+	std::chrono::steady_clock::time_point start;
+public:
+  Stopwatch();
+  void restart();
+  double elapsedMs() const;
+};
+
+/*
+  A stream buffer that passes everything on to another stream buffer,
+  counting the bytes as they go, e.g. to count what is written to
+  std::cout without keeping a copy of it.
+*/
+class CountingStreamBuf : public std::streambuf {
+private:
+	std::streambuf* target;
+	size_t count;
+protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
+  int sync() override;
+public:
+  explicit CountingStreamBuf(std::streambuf* target);
+  size_t bytes() const noexcept;
+};
+
+} // namespace BethYw
+
+#endif // STATS_H_
@@ -0,0 +1,812 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the streaming reader for StatsWales JSON exports. The
+  exports look like:
+
+    {
+      "odata.metadata": "...",
+      "value": [ { "Data": 1.0, "Year_Code": "2002", ... }, ... ],
+      "odata.nextLink": "..."
+    }
+
+  WelshStatsSax below receives the SAX events from the JSON library and keeps
+  track of how deep it is in that structure. Scalars inside an object in the
+  "value" array are copied into a WelshStatsRecord if their key matches one of
+  the mapped columns, and the record is handed to the callback when the object
+  ends. Everything else (metadata, unmapped columns) is skipped without being
+  stored.
+
+  With a RecordFilter, the area, measure and year of a record are checked as
+  soon as they are read. Once one fails, the record is marked as rejected and
+  its remaining fields are skipped. A data value given as a string is only
+  converted once the whole record has passed.
+*/
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "lib_json.hpp"
+
+#include "measure.h"
+#include "statswales.h"
+
+/*
+  An alias for the imported JSON parsing library.
+*/
+using json = nlohmann::json;
+
+namespace {
+
+/*
+  The columns from a record that we keep. Anything else is Ignored.
+*/
+enum RecordField {
+  Ignored,
+  AuthCode,
+  AuthNameEng,
+  MeasureCode,
+  MeasureLabel,
+  Year,
+  Value
+};
+
+/*
+  Nesting depths of the interesting parts of an export: 1 is inside the
+  top-level object, 2 is inside the "value" array, and 3 is inside a record.
+*/
+constexpr int TOP_LEVEL_DEPTH = 1;
+constexpr int VALUES_DEPTH    = 2;
+constexpr int RECORD_DEPTH    = 3;
+
+class WelshStatsSax : public nlohmann::json_sax<json> {
+private:
+  const BethYw::WelshStatsRecordHandler& handler;
+  const RecordFilter* filter;
+
+  std::string authCodeCol;
+  std::string authNameCol;
+  std::string measureCodeCol;
+  std::string measureLabelCol;
+  std::string yearCol;
+  std::string valueCol;
+  bool singleMeasure;
+  bool rejectAll;
+
+  BethYw::WelshStatsRecord record;
+  std::string valueText;
+  int depth;
+  bool inValues;
+  bool inRecord;
+  bool topKeyIsValue;
+  RecordField field;
+  bool hasAuthCode;
+  bool hasYear;
+  bool hasValue;
+  bool valueIsText;
+  bool rejected;
+  size_t rows;
+
+  void startRecord();
+  void endRecord();
+  void setText(const std::string& val);
+  void setNumber(double val);
+
+public:
+  WelshStatsSax(const BethYw::SourceColumnMapping& cols,
+                const BethYw::WelshStatsRecordHandler& handler,
+                const RecordFilter* filter);
+
+  void expectValuesArray();
+  size_t rowsRead() const noexcept { return rows; }
+
+  bool null() override;
+  bool boolean(bool val) override;
+  bool number_integer(number_integer_t val) override;
+  bool number_unsigned(number_unsigned_t val) override;
+  bool number_float(number_float_t val, const string_t& s) override;
+  bool string(string_t& val) override;
+  bool binary(binary_t& val) override;
+  bool start_object(std::size_t elements) override;
+  bool key(string_t& val) override;
+  bool end_object() override;
+  bool start_array(std::size_t elements) override;
+  bool end_array() override;
+  bool parse_error(std::size_t position,
+                   const std::string& last_token,
+                   const nlohmann::detail::exception& ex) override;
+};
+
+/*
+  Look up a column name in the mapping, returning an empty string (which
+  never matches a key) if the dataset does not have that column.
+*/
+std::string column(const BethYw::SourceColumnMapping& cols,
+                   BethYw::SourceColumn col) {
+  auto it = cols.find(col);
+  return it != cols.end() ? it->second : std::string();
+}
+
+WelshStatsSax::WelshStatsSax(const BethYw::SourceColumnMapping& cols,
+                             const BethYw::WelshStatsRecordHandler& _handler,
+                             const RecordFilter* _filter)
+    : handler(_handler),
+      filter(_filter),
+      authCodeCol(column(cols, BethYw::AUTH_CODE)),
+      authNameCol(column(cols, BethYw::AUTH_NAME_ENG)),
+      measureCodeCol(column(cols, BethYw::MEASURE_CODE)),
+      measureLabelCol(column(cols, BethYw::MEASURE_NAME)),
+      yearCol(column(cols, BethYw::YEAR)),
+      valueCol(column(cols, BethYw::VALUE)),
+      singleMeasure(cols.count(BethYw::SINGLE_MEASURE_CODE) > 0),
+      rejectAll(false),
+      record(),
+      valueText(),
+      depth(0),
+      inValues(false),
+      inRecord(false),
+      topKeyIsValue(false),
+      field(Ignored),
+      hasAuthCode(false),
+      hasYear(false),
+      hasValue(false),
+      valueIsText(false),
+      rejected(false),
+      rows(0) {
+  if (authCodeCol.empty() || yearCol.empty() || valueCol.empty()) {
+    throw std::out_of_range("there are not enough columns in cols");
+  }
+
+  if (singleMeasure) {
+    if (cols.count(BethYw::SINGLE_MEASURE_NAME) <= 0) {
+      throw std::out_of_range("there are not enough columns in cols");
+    }
+    record.measureCode  = cols.at(BethYw::SINGLE_MEASURE_CODE);
+    record.measureLabel = cols.at(BethYw::SINGLE_MEASURE_NAME);
+    rejectAll = filter != nullptr && !filter->keepMeasure(record.measureCode);
+  } else if (measureCodeCol.empty() || measureLabelCol.empty()) {
+    throw std::out_of_range("there are not enough columns in cols");
+  }
+}
+
+//Treats the next array as the "value" array, for parsing a bare list of rows
+void WelshStatsSax::expectValuesArray() {
+	depth = TOP_LEVEL_DEPTH;
+	topKeyIsValue = true;
+}
+
+//Clears the previous record, keeping the string buffers for reuse
+void WelshStatsSax::startRecord() {
+	inRecord = true;
+	field = Ignored;
+	hasAuthCode = false;
+	hasYear = false;
+	hasValue = false;
+	valueIsText = false;
+	rejected = rejectAll;
+	record.authCode.clear();
+	record.authNameEng.clear();
+	if (!singleMeasure) {
+		record.measureCode.clear();
+		record.measureLabel.clear();
+	}
+}
+
+//Hands a finished record on, skipping rows that have no data value
+void WelshStatsSax::endRecord() {
+	inRecord = false;
+	rows++;
+	if (!hasValue || rejected) {
+		return;
+	}
+	if (!hasAuthCode || !hasYear) {
+		throw std::runtime_error(
+				"BethYw::parseWelshStatsJSON: record is missing its area or year");
+	}
+	if (valueIsText) {
+		//some exports (e.g. envi0201.json) store the data as strings
+		const char* end = valueText.data() + valueText.size();
+		auto result = std::from_chars(valueText.data(), end, record.value);
+		if (result.ec != std::errc()) {
+			throw std::runtime_error(
+					"BethYw::parseWelshStatsJSON: Invalid value " + valueText);
+		}
+	}
+	handler(record);
+}
+
+void WelshStatsSax::setText(const std::string& val) {
+	if (rejected) {
+		return;
+	}
+	switch (field) {
+	case AuthCode:
+		if (filter != nullptr && !filter->keepArea(val)) {
+			rejected = true;
+			return;
+		}
+		record.authCode = val;
+		hasAuthCode = true;
+		break;
+	case AuthNameEng:
+		record.authNameEng = val;
+		break;
+	case MeasureCode:
+		if (filter != nullptr && !filter->keepMeasure(val)) {
+			rejected = true;
+			return;
+		}
+		record.measureCode = val;
+		//some exports (e.g. envi0201.json) use one column for both
+		if (measureLabelCol == measureCodeCol) {
+			record.measureLabel = val;
+		}
+		break;
+	case MeasureLabel:
+		record.measureLabel = val;
+		break;
+	case Year: {
+		int year;
+		const char* end = val.data() + val.size();
+		auto result = std::from_chars(val.data(), end, year);
+		if (result.ec != std::errc() || !Measure::isValidYear(year)) {
+			throw std::runtime_error(
+					"BethYw::parseWelshStatsJSON: Invalid year " + val);
+		}
+		if (filter != nullptr && !filter->keepYear(year)) {
+			rejected = true;
+			return;
+		}
+		record.year = year;
+		hasYear = true;
+		break;
+	}
+	case Value:
+		//converted in endRecord(), if the record is kept
+		valueText = val;
+		valueIsText = true;
+		hasValue = true;
+		break;
+	case Ignored:
+		break;
+	}
+}
+
+void WelshStatsSax::setNumber(double val) {
+	if (rejected) {
+		return;
+	}
+	if (field == Year) {
+		//checked before the cast, which is undefined for doubles out of range
+		if (!(val >= Measure::MIN_YEAR && val <= Measure::MAX_YEAR)
+				|| val != static_cast<int>(val)) {
+			throw std::runtime_error(
+					"BethYw::parseWelshStatsJSON: Invalid year " + std::to_string(val));
+		}
+		if (filter != nullptr && !filter->keepYear(static_cast<int>(val))) {
+			rejected = true;
+			return;
+		}
+		record.year = static_cast<int>(val);
+		hasYear = true;
+	} else if (field == Value) {
+		valueIsText = false;
+		record.value = val;
+		hasValue = true;
+	}
+}
+
+bool WelshStatsSax::null() {
+	return true;
+}
+
+bool WelshStatsSax::boolean(bool) {
+	return true;
+}
+
+bool WelshStatsSax::number_integer(number_integer_t val) {
+	if (inRecord && depth == RECORD_DEPTH) {
+		setNumber(static_cast<double>(val));
+	}
+	return true;
+}
+
+bool WelshStatsSax::number_unsigned(number_unsigned_t val) {
+	if (inRecord && depth == RECORD_DEPTH) {
+		setNumber(static_cast<double>(val));
+	}
+	return true;
+}
+
+bool WelshStatsSax::number_float(number_float_t val, const string_t&) {
+	if (inRecord && depth == RECORD_DEPTH) {
+		setNumber(val);
+	}
+	return true;
+}
+
+bool WelshStatsSax::string(string_t& val) {
+	if (inRecord && depth == RECORD_DEPTH) {
+		setText(val);
+	}
+	return true;
+}
+
+bool WelshStatsSax::binary(binary_t&) {
+	return true;
+}
+
+bool WelshStatsSax::start_object(std::size_t) {
+	if (inValues && depth == VALUES_DEPTH) {
+		startRecord();
+	}
+	depth++;
+	return true;
+}
+
+bool WelshStatsSax::key(string_t& val) {
+	if (depth == TOP_LEVEL_DEPTH) {
+		topKeyIsValue = val == "value";
+	} else if (inRecord && depth == RECORD_DEPTH) {
+		if (val == authCodeCol) {
+			field = AuthCode;
+		} else if (val == authNameCol) {
+			field = AuthNameEng;
+		} else if (val == measureCodeCol && !singleMeasure) {
+			field = MeasureCode;
+		} else if (val == measureLabelCol && !singleMeasure) {
+			field = MeasureLabel;
+		} else if (val == yearCol) {
+			field = Year;
+		} else if (val == valueCol) {
+			field = Value;
+		} else {
+			field = Ignored;
+		}
+	}
+	return true;
+}
+
+bool WelshStatsSax::end_object() {
+	depth--;
+	if (inRecord && depth == VALUES_DEPTH) {
+		endRecord();
+	}
+	return true;
+}
+
+bool WelshStatsSax::start_array(std::size_t) {
+	if (depth == TOP_LEVEL_DEPTH && topKeyIsValue) {
+		inValues = true;
+	}
+	depth++;
+	return true;
+}
+
+bool WelshStatsSax::end_array() {
+	depth--;
+	if (inValues && depth == TOP_LEVEL_DEPTH) {
+		inValues = false;
+	}
+	return true;
+}
+
+bool WelshStatsSax::parse_error(std::size_t,
+                                const std::string&,
+                                const nlohmann::detail::exception& ex) {
+	throw std::runtime_error(std::string("BethYw::parseWelshStatsJSON: ") + ex.what());
+}
+
+/*
+  Iterates over a list of rows as if it were wrapped in square brackets, so
+  that it can be parsed as a JSON array without copying it. closed is set if
+  the parser reads the closing bracket we added.
+*/
+class BracketedIterator {
+private:
+  std::string_view text;
+  size_t pos;
+  bool* closed;
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = char;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = const char*;
+  using reference         = char;
+
+  BracketedIterator(std::string_view _text, size_t _pos, bool* _closed)
+      : text(_text), pos(_pos), closed(_closed) {}
+
+  char operator*() const {
+    if (pos == 0) {
+      return '[';
+    }
+    if (pos <= text.size()) {
+      return text[pos - 1];
+    }
+    *closed = true;
+    return ']';
+  }
+
+  BracketedIterator& operator++() {
+    pos++;
+    return *this;
+  }
+
+  BracketedIterator operator++(int) {
+    BracketedIterator old = *this;
+    pos++;
+    return old;
+  }
+
+  bool operator==(const BracketedIterator& other) const {
+    return pos == other.pos;
+  }
+
+  bool operator!=(const BracketedIterator& other) const {
+    return pos != other.pos;
+  }
+};
+
+bool isSpace(char c) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+//Returns the position just after the string whose opening quote is at pos
+size_t skipString(std::string_view buffer, size_t pos) {
+	for (pos++; pos < buffer.size(); pos++){
+		if (buffer[pos] == '\\'){
+			pos++;
+		} else if (buffer[pos] == '"'){
+			return pos + 1;
+		}
+	}
+	return buffer.size();
+}
+
+/*
+  Find the top-level "value" array, returning the position just after its
+  opening bracket, or npos if there isn't one. Only the part of the file
+  before the array is read.
+*/
+size_t findValuesArray(std::string_view buffer) {
+	int depth = 0;
+	size_t pos = 0;
+	while (pos < buffer.size()){
+		char c = buffer[pos];
+		if (c == '"'){
+			size_t end = skipString(buffer, pos);
+			std::string_view key = buffer.substr(pos + 1, end - pos - 2);
+			pos = end;
+			if (depth != TOP_LEVEL_DEPTH || key != "value"){
+				continue;
+			}
+			while (pos < buffer.size() && isSpace(buffer[pos])){
+				pos++;
+			}
+			if (pos >= buffer.size() || buffer[pos] != ':'){
+				continue;
+			}
+			for (pos++; pos < buffer.size() && isSpace(buffer[pos]); pos++){
+			}
+			if (pos < buffer.size() && buffer[pos] == '['){
+				return pos + 1;
+			}
+			continue;
+		}
+		if (c == '{' || c == '['){
+			depth++;
+		} else if (c == '}' || c == ']'){
+			depth--;
+		}
+		pos++;
+	}
+	return std::string_view::npos;
+}
+
+/*
+  Find the first place at or after pos that looks like the start of a row,
+  i.e. a '{' preceded by a ',' and a '}' (with any whitespace between them).
+  The match may be inside a string; parseWelshStatsRecords() detects that.
+*/
+size_t findRowStart(std::string_view buffer, size_t pos) {
+	while (pos < buffer.size()){
+		const void* brace = std::memchr(buffer.data() + pos, '}', buffer.size() - pos);
+		if (brace == nullptr){
+			return std::string_view::npos;
+		}
+		size_t end = static_cast<const char*>(brace) - buffer.data();
+		size_t next = end + 1;
+		while (next < buffer.size() && isSpace(buffer[next])){
+			next++;
+		}
+		if (next < buffer.size() && buffer[next] == ','){
+			for (next++; next < buffer.size() && isSpace(buffer[next]); next++){
+			}
+			if (next < buffer.size() && buffer[next] == '{'){
+				return next;
+			}
+		}
+		pos = end + 1;
+	}
+	return std::string_view::npos;
+}
+
+} // namespace
+
+/*
+  Read a StatsWales JSON export from a stream, calling handler for every row
+  of the "value" array as soon as it has been read. Rows without a data value
+  (i.e. null) are skipped.
+
+  @param is
+    The input stream from InputSource
+
+  @param cols
+    A map of the enum BethyYw::SourceColumnMapping (see datasets.h) to strings
+    that give the keys in each row
+
+  @param handler
+    Function to call with each row
+
+  @param filter
+    Rows that do not pass this filter are skipped, or nullptr to keep every
+    row
+
+  @throws
+    std::runtime_error if a parsing error occurs (e.g. due to a malformed file)
+    std::out_of_range if there are not enough columns in cols
+
+  @example
+    InputFile input("data/popu1009.json");
+    BethYw::parseWelshStatsJSON(
+      input.open(),
+      BethYw::InputFiles::POPDEN.COLS,
+      [](const BethYw::WelshStatsRecord& record) {
+        std::cout << record.authCode << " " << record.value << std::endl;
+      });
+*/
+void BethYw::parseWelshStatsJSON(std::istream& is,
+                                 const SourceColumnMapping& cols,
+                                 const WelshStatsRecordHandler& handler,
+                                 const RecordFilter * const filter) {
+	WelshStatsSax sax(cols, handler, filter);
+	json::sax_parse(is, &sax);
+}
+
+/*
+  Read a StatsWales JSON export that is already in memory (e.g. from
+  InputMmapFile), calling handler for every row of the "value" array. The
+  parser reads straight from the buffer, nothing is copied.
+
+  @param buffer
+    The contents of the file
+
+  @param cols
+    A map of the enum BethyYw::SourceColumnMapping (see datasets.h) to strings
+    that give the keys in each row
+
+  @param handler
+    Function to call with each row
+
+  @param filter
+    Rows that do not pass this filter are skipped, or nullptr to keep every
+    row
+
+  @param rowsRead
+    Set to the number of rows read, including those skipped, or nullptr
+
+  @throws
+    std::runtime_error if a parsing error occurs (e.g. due to a malformed file)
+    std::out_of_range if there are not enough columns in cols
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+    BethYw::parseWelshStatsJSON(
+      input.open(),
+      BethYw::InputFiles::POPDEN.COLS,
+      [](const BethYw::WelshStatsRecord& record) { ... });
+*/
+void BethYw::parseWelshStatsJSON(std::string_view buffer,
+                                 const SourceColumnMapping& cols,
+                                 const WelshStatsRecordHandler& handler,
+                                 const RecordFilter * const filter,
+                                 size_t * const rowsRead) {
+	WelshStatsSax sax(cols, handler, filter);
+	json::sax_parse(buffer.data(), buffer.data() + buffer.size(), &sax);
+	if (rowsRead != nullptr){
+		*rowsRead = sax.rowsRead();
+	}
+}
+
+/*
+  Split the "value" array of a StatsWales JSON export into up to `chunks`
+  ranges of roughly equal size, each starting at the beginning of a row. The
+  ranges can be passed to parseWelshStatsRecords() separately. The last range
+  runs to the end of the buffer.
+
+  Split points are found by looking for the text between two rows, which
+  could also appear inside a string value. parseWelshStatsRecords() fails on
+  any range that does not end on a row boundary, so callers must fall back to
+  parseWelshStatsJSON() if any of the ranges fail.
+
+  @param buffer
+    The contents of the file
+
+  @param chunks
+    The maximum number of ranges to return
+
+  @return
+    The ranges of rows, or an empty vector if there is no "value" array
+
+  @example
+    InputMmapFile input("data/popu1009.json");
+    auto ranges = BethYw::splitWelshStatsJSON(input.open(), 8);
+*/
+std::vector<std::string_view> BethYw::splitWelshStatsJSON(
+    std::string_view buffer,
+    size_t chunks) {
+	std::vector<std::string_view> ranges;
+	size_t start = findValuesArray(buffer);
+	if (start == std::string_view::npos){
+		return ranges;
+	}
+	if (chunks < 1){
+		chunks = 1;
+	}
+
+	size_t chunkSize = (buffer.size() - start) / chunks;
+	size_t previous = start;
+	for (size_t i = 1; i < chunks; i++){
+		size_t target = std::max(start + i * chunkSize, previous + 1);
+		size_t next = findRowStart(buffer, target);
+		if (next == std::string_view::npos){
+			break;
+		}
+		ranges.push_back(buffer.substr(previous, next - previous));
+		previous = next;
+	}
+	ranges.push_back(buffer.substr(previous));
+	return ranges;
+}
+
+/*
+  Parse a range of rows from the "value" array of a StatsWales JSON export
+  (as returned by splitWelshStatsJSON()), calling handler for each row. The
+  range is a list of objects separated by commas. If it contains the end of
+  the "value" array, parsing stops there and anything after it is ignored.
+
+  A range that was split in the middle of a row fails to parse. A range that
+  contains the end of the array but isn't the last range returns true, which
+  means a later split point was not between two rows.
+
+  @param records
+    A range of rows
+
+  @param cols
+    A map of the enum BethyYw::SourceColumnMapping (see datasets.h) to strings
+    that give the keys in each row
+
+  @param handler
+    Function to call with each row
+
+  @param filter
+    Rows that do not pass this filter are skipped, or nullptr to keep every
+    row
+
+  @param rowsRead
+    Set to the number of rows read, including those skipped, or nullptr
+
+  @return
+    true if the range contained the end of the "value" array
+
+  @throws
+    std::runtime_error if the range is not a list of whole rows
+    std::out_of_range if there are not enough columns in cols
+
+  @example
+    auto ranges = BethYw::splitWelshStatsJSON(input.open(), 8);
+    for (size_t i = 0; i < ranges.size(); i++) {
+      bool last = BethYw::parseWelshStatsRecords(ranges[i], cols, handler);
+      ...
+    }
+*/
+bool BethYw::parseWelshStatsRecords(std::string_view records,
+                                    const SourceColumnMapping& cols,
+                                    const WelshStatsRecordHandler& handler,
+                                    const RecordFilter * const filter,
+                                    size_t * const rowsRead) {
+	WelshStatsSax sax(cols, handler, filter);
+	sax.expectValuesArray();
+
+	//a range that stops before the end of the array has a trailing comma
+	std::string_view rows = records;
+	while (!rows.empty() && (isSpace(rows.back()) || rows.back() == ',')){
+		rows.remove_suffix(1);
+	}
+
+	bool closed = false;
+	BracketedIterator first(rows, 0, &closed);
+	BracketedIterator last(rows, rows.size() + 2, &closed);
+	json::sax_parse(first, last, &sax, nlohmann::detail::input_format_t::json,
+			false);
+	if (rowsRead != nullptr){
+		*rowsRead = sax.rowsRead();
+	}
+	return !closed;
+}
+
+/*
+  Call handler with each row of the "value" array of a StatsWales JSON export,
+  as a view from the row's opening brace to its closing brace, without parsing
+  the row. Each view can be passed to parseWelshStatsRecords() on its own, so
+  this is how the positions of the rows in a file are found (see index.h).
+
+  @param buffer
+    The contents of the file
+
+  @param handler
+    Function to call with the offset of each row in buffer and a view of it
+
+  @throws
+    std::runtime_error if there is no "value" array, or a row or the array
+    is not closed
+
+  @example
+    BethYw::scanWelshStatsRows(input.open(),
+        [](size_t offset, std::string_view row) { ... });
+*/
+void BethYw::scanWelshStatsRows(std::string_view buffer,
+                                const WelshStatsRowHandler& handler) {
+	size_t pos = findValuesArray(buffer);
+	if (pos == std::string_view::npos){
+		throw std::runtime_error("BethYw::scanWelshStatsRows: No value array");
+	}
+
+	while (pos < buffer.size()){
+		char c = buffer[pos];
+		if (isSpace(c) || c == ','){
+			pos++;
+			continue;
+		}
+		if (c == ']'){
+			return;
+		}
+		if (c != '{'){
+			throw std::runtime_error("BethYw::scanWelshStatsRows: Expected a row");
+		}
+
+		//find the brace that closes this row, stepping over strings
+		size_t start = pos;
+		int depth = 0;
+		while (pos < buffer.size()){
+			c = buffer[pos];
+			if (c == '"'){
+				pos = skipString(buffer, pos);
+				continue;
+			}
+			pos++;
+			if (c == '{' || c == '['){
+				depth++;
+			} else if ((c == '}' || c == ']') && --depth == 0){
+				break;
+			}
+		}
+		if (depth != 0){
+			break;
+		}
+		handler(start, buffer.substr(start, pos - start));
+	}
+	throw std::runtime_error("BethYw::scanWelshStatsRows: Unterminated value array");
+}
@@ -0,0 +1,95 @@
+#ifndef STATSWALES_H_
+#define STATSWALES_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations for reading StatsWales OData JSON
+  exports one record at a time. Rather than loading a whole file into a JSON
+  document, the reader walks the top-level "value" array with the SAX
+  interface of the JSON library and hands each row to a callback as soon as
+  the row's closing brace has been read. Only one row is held in memory.
+
+  If a RecordFilter is given, each field is checked against it as soon as it
+  is read, and once a row has failed the filter the rest of it is skipped
+  without converting or copying anything.
+
+  For large files that are already in memory, the "value" array can also be
+  split into ranges of whole rows which are parsed independently (e.g. on
+  separate threads) with parseWelshStatsRecords(), and the position of each
+  row can be found with scanWelshStatsRows() without parsing it.
+ */
+
+#include <functional>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "datasets.h"
+#include "filter.h"
+
+namespace BethYw {
+
+/*
+  A single row from the "value" array of a StatsWales export, reduced to the
+  columns named in a SourceColumnMapping. For single measure datasets (i.e.
+  those with SINGLE_MEASURE_CODE in their mapping) the measure code and label
+  are taken from the mapping rather than the row.
+*/
+struct WelshStatsRecord {
+  std::string authCode;
+  std::string authNameEng;
+  std::string measureCode;
+  std::string measureLabel;
+  int year;
+  double value;
+};
+
+/*
+  Called once for every complete row. The record passed in is reused for the
+  next row, so copy anything that needs to outlive the call.
+*/
+using WelshStatsRecordHandler = std::function<void(const WelshStatsRecord&)>;
+
+/*
+  Called with the offset in the file of a row of the "value" array, and a
+  view of the row from its opening to its closing brace.
+*/
+using WelshStatsRowHandler = std::function<void(size_t, std::string_view)>;
+
+void parseWelshStatsJSON(
+    std::istream& is,
+    const SourceColumnMapping& cols,
+    const WelshStatsRecordHandler& handler,
+    const RecordFilter * const filter = nullptr) noexcept(false);
+
+void parseWelshStatsJSON(
+    std::string_view buffer,
+    const SourceColumnMapping& cols,
+    const WelshStatsRecordHandler& handler,
+    const RecordFilter * const filter = nullptr,
+    size_t * const rowsRead = nullptr) noexcept(false);
+
+std::vector<std::string_view> splitWelshStatsJSON(
+    std::string_view buffer,
+    size_t chunks);
+
+bool parseWelshStatsRecords(
+    std::string_view records,
+    const SourceColumnMapping& cols,
+    const WelshStatsRecordHandler& handler,
+    const RecordFilter * const filter = nullptr,
+    size_t * const rowsRead = nullptr) noexcept(false);
+
+void scanWelshStatsRows(
+    std::string_view buffer,
+    const WelshStatsRowHandler& handler) noexcept(false);
+
+} // namespace BethYw
+
+#endif // STATSWALES_H_
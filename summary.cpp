@@ -0,0 +1,459 @@
+
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the code for the Bloom filters in dataset summaries, and
+  for building, writing and reading the summaries. See summary.h for what a
+  summary holds and the layout of the file.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+
+#include "index.h"
+#include "intern.h"
+#include "summary.h"
+
+namespace {
+
+const char SUMMARY_MAGIC[8] = {'B', 'Y', 'W', 'S', 'U', 'M', 'R', 'Y'};
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+//The share of codes not in a file that its summary wrongly says may be
+const double FALSE_POSITIVE_RATE = 0.01;
+
+struct SummaryHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	uint32_t type;
+	uint32_t hasMeasures;
+	uint64_t fileSize;
+	int64_t modified;
+	int32_t firstYear;
+	int32_t lastYear;
+	uint64_t areaWords;
+	uint64_t measureWords;
+	uint32_t areaHashes;
+	uint32_t measureHashes;
+	uint32_t codeBytes;
+	uint32_t padding;
+};
+
+//FNV-1a, which gives the same hash for the same bytes on every platform
+uint64_t hashBytes(std::string_view value) noexcept {
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : value){
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+//Mixes the bits of a hash (the SplitMix64 finaliser), for the second hash
+uint64_t mix(uint64_t z) noexcept {
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+std::string lower(std::string_view value) {
+	std::string lowered(value);
+	for (size_t i = 0; i < lowered.length(); i++){
+		lowered[i] = InternTable::toLower(lowered[i]);
+	}
+	return lowered;
+}
+
+//Copies a column of words out of a summary file, checking it is in bounds
+std::vector<uint64_t> readWords(std::string_view buffer, size_t& pos, uint64_t count) {
+	if (count == 0 || count > (buffer.size() - pos) / sizeof(uint64_t)){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Truncated summary");
+	}
+	std::vector<uint64_t> words(count);
+	std::memcpy(words.data(), buffer.data() + pos, count * sizeof(uint64_t));
+	pos += count * sizeof(uint64_t);
+	return words;
+}
+
+} // namespace
+
+/*
+  BethYw::BloomFilter::BloomFilter()
+
+  Construct an empty filter, which contains nothing.
+*/
+BethYw::BloomFilter::BloomFilter() : words(1, 0), hashes(1) {
+}
+
+/*
+  BethYw::BloomFilter::BloomFilter(items, falsePositiveRate)
+
+  Construct an empty filter sized for a number of items, so that once they
+  have been inserted, strings that were not inserted are reported as present
+  at about the given rate. The usual sizes are used: -n ln p / (ln 2)^2 bits,
+  rounded up to whole words, and -log2 p hashes.
+
+  @param items
+    The number of strings that will be inserted
+
+  @param falsePositiveRate
+    The chance of a false positive, greater than 0 and less than 1
+
+  @example
+    BethYw::BloomFilter filter(22, 0.01);
+*/
+BethYw::BloomFilter::BloomFilter(size_t items, double falsePositiveRate) {
+	const double ln2 = std::log(2.0);
+	double bits = std::ceil(-(double) items * std::log(falsePositiveRate) / (ln2 * ln2));
+	words.assign(std::max<size_t>(1, (size_t) std::ceil(bits / 64)), 0);
+	hashes = std::max<uint32_t>(1, (uint32_t) std::ceil(-std::log2(falsePositiveRate)));
+}
+
+/*
+  BethYw::BloomFilter::BloomFilter(words, hashes)
+
+  Construct a filter from the words and number of hashes of another, e.g.
+  one read back from a file.
+
+  @throws
+    std::invalid_argument if there are no words or no hashes
+*/
+BethYw::BloomFilter::BloomFilter(std::vector<uint64_t> _words, uint32_t _hashes)
+		: words(std::move(_words)), hashes(_hashes) {
+	if (words.empty() || hashes == 0){
+		throw std::invalid_argument("BethYw::BloomFilter: There must be at least one word and hash");
+	}
+}
+
+/*
+  BethYw::BloomFilter::insert(value)
+
+  Add a string to the filter. The bits for it are chosen by double hashing:
+  the i-th bit is h1 + i * h2, modulo the number of bits.
+
+  @param value
+    The string to add
+*/
+void BethYw::BloomFilter::insert(std::string_view value) noexcept {
+	const uint64_t bits = words.size() * 64;
+	const uint64_t h1 = hashBytes(value);
+	const uint64_t h2 = mix(h1) | 1;
+	for (uint32_t i = 0; i < hashes; i++){
+		uint64_t bit = (h1 + i * h2) % bits;
+		words[bit / 64] |= 1ULL << (bit % 64);
+	}
+}
+
+/*
+  BethYw::BloomFilter::mayContain(value)
+
+  @param value
+    The string to look for
+
+  @return
+    false if the string was definitely not inserted, true if it may have been
+*/
+bool BethYw::BloomFilter::mayContain(std::string_view value) const noexcept {
+	const uint64_t bits = words.size() * 64;
+	const uint64_t h1 = hashBytes(value);
+	const uint64_t h2 = mix(h1) | 1;
+	for (uint32_t i = 0; i < hashes; i++){
+		uint64_t bit = (h1 + i * h2) % bits;
+		if ((words[bit / 64] & (1ULL << (bit % 64))) == 0){
+			return false;
+		}
+	}
+	return true;
+}
+
+const std::vector<uint64_t>& BethYw::BloomFilter::getWords() const noexcept {
+	return words;
+}
+
+uint32_t BethYw::BloomFilter::getHashes() const noexcept {
+	return hashes;
+}
+
+BethYw::DatasetSummary::DatasetSummary()
+		: type(None), fileSize(0), modified(0), firstYear(0), lastYear(0),
+		  hasMeasures(false) {
+}
+
+/*
+  BethYw::DatasetSummary::build(index)
+
+  Summarise a dataset file from its index: every authority code and measure
+  code in the index goes into the Bloom filters, and the index's range of
+  years is copied.
+
+  @param index
+    The index of the file, see index.h
+
+  @return
+    The summary
+
+  @example
+    auto summary = BethYw::DatasetSummary::build(index);
+*/
+BethYw::DatasetSummary BethYw::DatasetSummary::build(const DatasetIndex& index) {
+	DatasetSummary summary;
+	summary.code = index.getCode();
+	summary.type = index.getType();
+	summary.fileSize = index.getFileSize();
+	summary.modified = index.getModified();
+	summary.firstYear = index.getFirstYear();
+	summary.lastYear = index.getLastYear();
+	summary.hasMeasures = index.getType() != AuthorityCodeCSV;
+
+	std::vector<std::string_view> areaCodes = index.getAreaCodes();
+	summary.areas = BloomFilter(areaCodes.size(), FALSE_POSITIVE_RATE);
+	for (std::string_view code : areaCodes){
+		summary.areas.insert(code);
+	}
+
+	//measures are filtered case-insensitively, so they are summarised in lowercase
+	std::vector<std::string_view> measureCodes = index.getMeasureCodes();
+	summary.measures = BloomFilter(measureCodes.size(), FALSE_POSITIVE_RATE);
+	for (std::string_view code : measureCodes){
+		summary.measures.insert(lower(code));
+	}
+	return summary;
+}
+
+/*
+  BethYw::DatasetSummary::read(buffer)
+
+  Read a summary written by write().
+
+  @param buffer
+    The contents of the summary file
+
+  @return
+    The summary
+
+  @throws
+    std::runtime_error if the buffer is not a valid summary from this version
+    of Beth Yw? on a machine with the same byte order
+
+  @example
+    std::ifstream file("datasets/popu1009.json.sum", std::ios::binary);
+    std::string contents(std::istreambuf_iterator<char>(file), {});
+    auto summary = BethYw::DatasetSummary::read(contents);
+*/
+BethYw::DatasetSummary BethYw::DatasetSummary::read(std::string_view buffer) {
+	SummaryHeader header;
+	if (buffer.size() < sizeof(header)){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Truncated summary");
+	}
+	std::memcpy(&header, buffer.data(), sizeof(header));
+	if (std::memcmp(header.magic, SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC)) != 0){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Not a summary");
+	}
+	if (header.version != SUMMARY_VERSION){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Unsupported summary version");
+	}
+	if (header.byteOrder != BYTE_ORDER_MARK){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Summary has the wrong byte order");
+	}
+	if (header.areaHashes == 0 || header.measureHashes == 0){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Corrupt summary");
+	}
+
+	DatasetSummary summary;
+	size_t pos = sizeof(header);
+	if (header.codeBytes > buffer.size() - pos){
+		throw std::runtime_error("BethYw::DatasetSummary::read: Truncated summary");
+	}
+	summary.code = std::string(buffer.substr(pos, header.codeBytes));
+	pos += header.codeBytes;
+	summary.type = static_cast<SourceDataType>(header.type);
+	summary.fileSize = header.fileSize;
+	summary.modified = header.modified;
+	summary.firstYear = header.firstYear;
+	summary.lastYear = header.lastYear;
+	summary.hasMeasures = header.hasMeasures != 0;
+	summary.areas = BloomFilter(readWords(buffer, pos, header.areaWords), header.areaHashes);
+	summary.measures = BloomFilter(readWords(buffer, pos, header.measureWords),
+			header.measureHashes);
+	return summary;
+}
+
+/*
+  BethYw::DatasetSummary::write(os)
+
+  Write the summary to a stream, to be read again with read().
+
+  @param os
+    The stream to write to, which should be opened in binary mode
+
+  @example
+    std::ofstream file("datasets/popu1009.json.sum", std::ios::binary);
+    summary.write(file);
+*/
+void BethYw::DatasetSummary::write(std::ostream& os) const {
+	SummaryHeader header = {};
+	std::memcpy(header.magic, SUMMARY_MAGIC, sizeof(SUMMARY_MAGIC));
+	header.version = SUMMARY_VERSION;
+	header.byteOrder = BYTE_ORDER_MARK;
+	header.type = (uint32_t) type;
+	header.hasMeasures = hasMeasures;
+	header.fileSize = fileSize;
+	header.modified = modified;
+	header.firstYear = firstYear;
+	header.lastYear = lastYear;
+	header.areaWords = areas.getWords().size();
+	header.measureWords = measures.getWords().size();
+	header.areaHashes = areas.getHashes();
+	header.measureHashes = measures.getHashes();
+	header.codeBytes = (uint32_t) code.size();
+
+	os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	os.write(code.data(), code.size());
+	os.write(reinterpret_cast<const char*>(areas.getWords().data()),
+			areas.getWords().size() * sizeof(uint64_t));
+	os.write(reinterpret_cast<const char*>(measures.getWords().data()),
+			measures.getWords().size() * sizeof(uint64_t));
+}
+
+/*
+  BethYw::DatasetSummary::isFor(source, size, modified)
+
+  @return
+    true if the summary was built for this dataset from a file with the same
+    size and modification time
+*/
+bool BethYw::DatasetSummary::isFor(const InputFileSource& source,
+		uint64_t size,
+		int64_t _modified) const noexcept {
+	return type == source.PARSER && code == source.CODE
+			&& fileSize == size && modified == _modified;
+}
+
+int BethYw::DatasetSummary::getFirstYear() const noexcept {
+	return firstYear;
+}
+
+int BethYw::DatasetSummary::getLastYear() const noexcept {
+	return lastYear;
+}
+
+/*
+  BethYw::DatasetSummary::mayMatch(areasFilter, measuresFilter, yearsFilter)
+
+  Check whether any record in the file could pass the filters given to an
+  import. Each filter is checked on its own, so a file with records for the
+  area in one filter and the measure in another may match even if no record
+  has both. A Bloom filter can only be asked about whole codes, so a filter
+  with a pattern in it (e.g. "W06*") may always match.
+
+  @param areasFilter
+    The areas to import, or an empty set/nullptr for all areas
+
+  @param measuresFilter
+    The measures to import (in any case), or an empty set/nullptr for all
+    measures
+
+  @param yearsFilter
+    The range of years to import, or nullptr/a range with a 0 in it for all
+    years
+
+  @return
+    false if importing the file with these filters would import nothing,
+    true if it may import something
+
+  @example
+    StringFilterSet areasFilter = {"W06000024"};
+    if (!summary.mayMatch(&areasFilter, nullptr, nullptr)) {
+      // skip the file
+    }
+*/
+bool BethYw::DatasetSummary::mayMatch(const StringFilterSet * const areasFilter,
+		const StringFilterSet * const measuresFilter,
+		const YearFilterTuple * const yearsFilter) const {
+	if (areasFilter != nullptr && !areasFilter->empty()){
+		bool found = false;
+		for (auto it = areasFilter->begin(); it != areasFilter->end() && !found; it++){
+			found = PatternMatcher::isPattern(*it) || areas.mayContain(*it);
+		}
+		if (!found){
+			return false;
+		}
+	}
+
+	if (hasMeasures && measuresFilter != nullptr && !measuresFilter->empty()){
+		bool found = false;
+		for (auto it = measuresFilter->begin(); it != measuresFilter->end() && !found; it++){
+			found = PatternMatcher::isPattern(*it) || measures.mayContain(lower(*it));
+		}
+		if (!found){
+			return false;
+		}
+	}
+
+	if (yearsFilter != nullptr && firstYear != 0){
+		int first = std::get<0>(*yearsFilter);
+		int last = std::get<1>(*yearsFilter);
+		if (first != 0 && last != 0 && (last < firstYear || first > lastYear)){
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+  BethYw::loadDatasetSummary(path, source)
+
+  Read the summary next to a dataset file, if there is one for the file as
+  it is now. Summaries are only written by BethYw::loadDatasetIndex(), so
+  the first import of a file with --index always reads the file.
+
+  @param path
+    The path of the dataset file
+
+  @param source
+    The dataset the file holds
+
+  @return
+    The summary, or nothing if there is no summary for the file as it is
+
+  @example
+    auto summary = BethYw::loadDatasetSummary("datasets/tran0152.json",
+        BethYw::InputFiles::TRAINS);
+*/
+std::optional<BethYw::DatasetSummary> BethYw::loadDatasetSummary(
+		const std::string& path,
+		const InputFileSource& source) {
+	uint64_t size;
+	int64_t modified;
+	if (!getFileStamp(path, size, modified)){
+		return std::nullopt;
+	}
+
+	std::ifstream file(path + SUMMARY_SUFFIX, std::ios::binary);
+	if (!file.is_open()){
+		return std::nullopt;
+	}
+	std::string buffer((std::istreambuf_iterator<char>(file)),
+			std::istreambuf_iterator<char>());
+	try {
+		DatasetSummary summary = DatasetSummary::read(buffer);
+		if (summary.isFor(source, size, modified)){
+			return summary;
+		}
+	} catch (const std::runtime_error&) {
+		//a corrupt summary is ignored, and replaced with the index
+	}
+	return std::nullopt;
+}
@@ -0,0 +1,116 @@
+#ifndef SUMMARY_H_
+#define SUMMARY_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declarations for dataset summaries: a few kilobytes
+  kept next to a dataset file (with SUMMARY_SUFFIX added to its name), which
+  say which areas and measures the file may have records for, and the range
+  of years it has values for. With --index, BethYw::loadDatasets() reads the
+  summary before opening a file, and skips the file altogether if none of
+  its records could pass the filters, e.g. `-d trains,popden -a W06000024`
+  when the file has no records for W06000024.
+
+  The areas and measures are held in Bloom filters, which may wrongly say a
+  code is in the file (about 1 time in 100) but never wrongly say it isn't,
+  so a file is only ever skipped if it really has nothing to import. A
+  summary is built from the file's sidecar index (see index.h), at the same
+  time as the index, and like the index records the size and modification
+  time of the file so that it is ignored once the file changes.
+
+  The layout of a summary file, in the byte order of the machine that wrote
+  it, is:
+
+    header     magic "BYWSUMRY", version, byte order mark, data type, the
+               size and modification time of the file, the first and last
+               year with a value (0 if there are none), whether the file has
+               measures, the size and number of hashes of each filter, and
+               the length of the dataset code, which follows the header
+    areas      the words of the Bloom filter of authority codes
+    measures   the words of the Bloom filter of lowercase measure codes
+
+  SUMMARY_VERSION changes whenever the layout does.
+ */
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "datasets.h"
+#include "filter.h"
+
+namespace BethYw {
+
+constexpr unsigned int SUMMARY_VERSION = 1;
+
+const std::string SUMMARY_SUFFIX = ".sum";
+
+class DatasetIndex;
+
+/*
+  A set of strings that can be tested for membership in a fixed amount of
+  space, at the cost of some false positives. Each string sets `hashes` bits
+  in an array of 64 bit words; a string may be in the set if all of its bits
+  are set.
+*/
+class BloomFilter {
+private:
+	std::vector<uint64_t> words;
+	uint32_t hashes;
+public:
+  BloomFilter();
+  BloomFilter(size_t items, double falsePositiveRate);
+  BloomFilter(std::vector<uint64_t> words, uint32_t hashes);
+
+  void insert(std::string_view value) noexcept;
+  bool mayContain(std::string_view value) const noexcept;
+
+  const std::vector<uint64_t>& getWords() const noexcept;
+  uint32_t getHashes() const noexcept;
+};
+
+class DatasetSummary {
+private:
+	std::string code;
+	SourceDataType type;
+	uint64_t fileSize;
+	int64_t modified;
+	int firstYear;
+	int lastYear;
+	bool hasMeasures;
+	BloomFilter areas;
+	BloomFilter measures;
+
+	DatasetSummary();
+public:
+  static DatasetSummary build(const DatasetIndex& index) noexcept(false);
+  static DatasetSummary read(std::string_view buffer) noexcept(false);
+  void write(std::ostream& os) const;
+
+  bool isFor(const InputFileSource& source,
+             uint64_t size,
+             int64_t modified) const noexcept;
+  int getFirstYear() const noexcept;
+  int getLastYear() const noexcept;
+
+  bool mayMatch(const StringFilterSet * const areasFilter,
+                const StringFilterSet * const measuresFilter,
+                const YearFilterTuple * const yearsFilter) const;
+};
+
+std::optional<DatasetSummary> loadDatasetSummary(
+    const std::string& path,
+    const InputFileSource& source);
+
+} // namespace BethYw
+
+#endif // SUMMARY_H_
@@ -0,0 +1,241 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the implementation of the TableWriter class. See
+  tablewriter.h for details.
+*/
+
+#include <charconv>
+
+#include "intern.h"
+#include "tablewriter.h"
+
+namespace {
+
+//Bytes gathered before they are passed on to the stream
+const size_t BUFFER_SIZE = 64 * 1024;
+
+//The buffer of the last writer destroyed on this thread, for the next to reuse
+thread_local std::string spareBuffer;
+
+//Widths of the year/value columns and the summary headings
+const size_t VALUE_WIDTH = 10;
+const size_t AVERAGE_WIDTH = 13;
+const size_t DIFF_WIDTH = 12;
+const size_t PERCENT_DIFF_WIDTH = 8;
+
+} // namespace
+
+/*
+  TableWriter::TableWriter(os)
+
+  Construct a writer for a stream. The buffer left by the last writer on
+  this thread is reused, so printing one small object after another does not
+  allocate a new buffer each time.
+
+  @param os
+    The stream to write to; it must outlive the writer
+
+  @example
+    TableWriter writer(std::cout);
+*/
+TableWriter::TableWriter(std::ostream& _os) : os(_os) {
+	buffer.swap(spareBuffer);
+	buffer.reserve(BUFFER_SIZE);
+}
+
+/*
+  TableWriter::~TableWriter()
+
+  Write anything still buffered to the stream, and keep the buffer for the
+  next writer.
+*/
+TableWriter::~TableWriter() {
+	flush();
+	if (buffer.capacity() > spareBuffer.capacity()){
+		buffer.swap(spareBuffer);
+	}
+}
+
+//Adds the spaces that right-align a cell of length characters in width
+void TableWriter::pad(size_t length, size_t width) {
+	if (length < width){
+		buffer.append(width - length, ' ');
+	}
+}
+
+//Ends a line, passing the buffer on to the stream once it is full
+void TableWriter::endLine() {
+	buffer += '\n';
+	if (buffer.size() >= BUFFER_SIZE){
+		flush();
+	}
+}
+
+/*
+  TableWriter::text(text, width)
+
+  Write some text, right-aligned in a column.
+
+  @param text
+    The text to write
+
+  @param width
+    The width of the column; text longer than this is not cut short
+*/
+void TableWriter::text(std::string_view text, size_t width) {
+	pad(text.size(), width);
+	buffer.append(text.data(), text.size());
+}
+
+/*
+  TableWriter::integer(value, width)
+
+  Write an integer, right-aligned in a column.
+
+  @param value
+    The integer to write
+
+  @param width
+    The width of the column
+*/
+void TableWriter::integer(int value, size_t width) {
+	char digits[16];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value);
+	text(std::string_view(digits, result.ptr - digits), width);
+}
+
+/*
+  TableWriter::number(value, width)
+
+  Write a double to six significant figures, right-aligned in a column.
+
+  @param value
+    The number to write
+
+  @param width
+    The width of the column
+
+  @example
+    writer.number(97.126504, 10);  // "   97.1265"
+*/
+void TableWriter::number(double value, size_t width) {
+	char digits[32];
+	auto result = std::to_chars(digits, digits + sizeof(digits), value,
+			std::chars_format::general, 6);
+	text(std::string_view(digits, result.ptr - digits), width);
+}
+
+/*
+  TableWriter::write(measure)
+
+  Write a Measure as its label and codename, followed by a row of years and
+  a row of the values for those years. See operator<<(os, measure).
+
+  @param measure
+    The Measure to write
+*/
+void TableWriter::write(const Measure& measure) {
+	text(measure.getLabel());
+	buffer += '(';
+	text(measure.getCodename());
+	buffer += ')';
+	endLine();
+
+	for (auto yearValue : measure){
+		integer(yearValue.first, VALUE_WIDTH);
+	}
+	text("Average", AVERAGE_WIDTH);
+	text("Diff.", DIFF_WIDTH);
+	text("%Diff.", PERCENT_DIFF_WIDTH);
+	endLine();
+
+	for (auto yearValue : measure){
+		number(yearValue.second, VALUE_WIDTH);
+	}
+	endLine();
+}
+
+/*
+  TableWriter::write(area)
+
+  Write an Area as its names and local authority code, followed by each of
+  its Measures in order of codename. See operator<<(os, area).
+
+  @param area
+    The Area to write
+*/
+void TableWriter::write(const Area& area) {
+	//look the language codes up without adding them to the table
+	InternTable& strings = InternTable::global();
+	const std::map<InternId,InternId>& names = area.getNamesById();
+	auto findName = [&](std::string_view code) -> const std::string* {
+		InternId lang;
+		if (strings.find(code, lang)){
+			auto it = names.find(lang);
+			if (it != names.end()){
+				return &strings.lookup(it->second);
+			}
+		}
+		return nullptr;
+	};
+	const std::string* english = findName("eng");
+	const std::string* welsh = findName("cym");
+
+	if (english != nullptr && welsh != nullptr){
+		text(*english);
+		text(" / ");
+		text(*welsh);
+	} else if (english != nullptr || welsh != nullptr){
+		text(english != nullptr ? *english : *welsh);
+	} else {
+		text("Unnamed");
+	}
+	text(" (");
+	text(area.getLocalAuthorityCode());
+	buffer += ')';
+	endLine();
+
+	if (area.size() > 0){
+		for (const Measure* measure : area.getMeasuresInOrder()){
+			write(*measure);
+		}
+	} else {
+		text("<no measures>");
+		endLine();
+	}
+}
+
+/*
+  TableWriter::write(areas)
+
+  Write every Area in order of local authority code. See
+  operator<<(os, areas).
+
+  @param areas
+    The Areas to write
+*/
+void TableWriter::write(const Areas& areas) {
+	for (const Area* area : areas.getAreasInOrder()){
+		write(*area);
+	}
+}
+
+/*
+  TableWriter::flush()
+
+  Pass anything buffered on to the stream.
+*/
+void TableWriter::flush() {
+	if (!buffer.empty()){
+		os.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+}
@@ -0,0 +1,59 @@
+#ifndef TABLEWRITER_H_
+#define TABLEWRITER_H_
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  This file contains the declaration of the TableWriter class, which renders
+  Areas, Area and Measure objects as the text tables printed by Beth Yw?.
+  Rather than formatting each cell through the stream (with std::setw and
+  the stream's locale), cells are formatted with std::to_chars into a large
+  buffer, which is passed on to the stream in a few big writes.
+ */
+
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "area.h"
+#include "areas.h"
+#include "measure.h"
+
+/*
+  Renders tables into a buffer and writes it to a stream whenever it fills
+  up, and when the writer is destroyed. Numbers are right-aligned in
+  fixed-width columns; doubles are written as with printf("%g"), i.e. to six
+  significant figures, which is how a default std::ostream writes them.
+
+    TableWriter writer(std::cout);
+    writer.write(areas);
+*/
+class TableWriter {
+private:
+	std::ostream& os;
+	std::string buffer;
+
+	void pad(size_t length, size_t width);
+	void endLine();
+public:
+  explicit TableWriter(std::ostream& os);
+  ~TableWriter();
+  TableWriter(const TableWriter&) = delete;
+  TableWriter& operator=(const TableWriter&) = delete;
+
+  void text(std::string_view text, size_t width = 0);
+  void integer(int value, size_t width);
+  void number(double value, size_t width);
+
+  void write(const Measure& measure);
+  void write(const Area& area);
+  void write(const Areas& areas);
+
+  void flush();
+};
+
+#endif // TABLEWRITER_H_
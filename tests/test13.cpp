@@ -0,0 +1,133 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+#include "../input.h"
+#include "../datasets.h"
+#include "../areas.h"
+
+SCENARIO( "a source file can be mapped into memory and read", "[InputMmapFile][existent]" ) {
+
+  auto read_file = [](const std::string &path) {
+    std::ifstream stream(path);
+    return std::string(std::istreambuf_iterator<char>(stream),
+                       std::istreambuf_iterator<char>());
+  };
+
+  const std::string test_file = "../datasets/areas.csv";
+  const std::string expected  = read_file(test_file);
+  REQUIRE_FALSE( expected.empty() );
+
+  GIVEN( "a constructed InputMmapFile instance" ) {
+
+    InputMmapFile input(test_file);
+
+    THEN( "the source value can be retrieved" ) {
+
+      REQUIRE( input.getSource() == test_file );
+
+    } // THEN
+
+    THEN( "the file can be mapped without exception" ) {
+
+      REQUIRE_NOTHROW( input.open() );
+
+      AND_THEN( "the view contains the whole file" ) {
+
+        std::string_view contents = input.open();
+
+        REQUIRE( contents.size() == expected.size() );
+        REQUIRE( std::string(contents) == expected );
+
+      } // AND_THEN
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a mapped areas.csv file" ) {
+
+    InputMmapFile input(test_file);
+    std::string_view contents = input.open();
+
+    THEN( "an Areas instance can be populated from the view" ) {
+
+      Areas areas = Areas();
+
+      REQUIRE_NOTHROW( areas.populate(contents, BethYw::AuthorityCodeCSV, BethYw::InputFiles::AREAS.COLS) );
+      REQUIRE( areas.size() == 22 );
+      REQUIRE( areas.getArea("W06000011").getName("eng") == "Swansea" );
+      REQUIRE( areas.getArea("W06000011").getName("cym") == "Abertawe" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a nonexistant source file cannot be mapped", "[InputMmapFile][nonexistent]" ) {
+
+  const std::string test_file = "datasets/jibberish.json";
+
+  GIVEN( "a constructed InputMmapFile instance" ) {
+
+    InputMmapFile input(test_file);
+
+    const std::string exceptionMessage = "InputMmapFile::open: Failed to open file " + test_file;
+
+    THEN( "when the source file is attempted to be mapped, a std::runtime_error is thrown with message " + exceptionMessage ) {
+
+      REQUIRE_THROWS_AS( input.open(), std::runtime_error );
+      REQUIRE_THROWS_WITH( input.open(), exceptionMessage );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a StatsWales JSON file gives the same data mapped or streamed", "[InputMmapFile][popu1009]" ) {
+
+  const std::string test_file = "../datasets/popu1009.json";
+
+  GIVEN( "popu1009.json parsed from a stream and from a mapped view" ) {
+
+    std::ifstream stream(test_file);
+    REQUIRE( stream.is_open() );
+
+    Areas streamed = Areas();
+    streamed.populateFromWelshStatsJSON(stream, BethYw::InputFiles::POPDEN.COLS);
+
+    InputMmapFile input(test_file);
+    Areas mapped = Areas();
+    mapped.populateFromWelshStatsJSON(input.open(), BethYw::InputFiles::POPDEN.COLS);
+
+    THEN( "both Areas instances contain the same data" ) {
+
+      REQUIRE( mapped.size() == streamed.size() );
+      REQUIRE( mapped.getArea("W06000001") == streamed.getArea("W06000001") );
+      REQUIRE( mapped.getArea("W06000012") == streamed.getArea("W06000012") );
+      REQUIRE( mapped.getArea("W06000023").getMeasure("pop").getValue(2019) == 132435 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,150 @@
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../csv.h"
+#include "../datasets.h"
+#include "../areas.h"
+
+SCENARIO( "a CSVReader splits a buffer into rows of cells", "[CSVReader][rows]" ) {
+
+  std::vector<std::string_view> cells;
+
+  GIVEN( "a buffer with a header, CRLF line endings and an empty cell" ) {
+
+    const std::string data = "AuthorityCode,1991,2001\r\nW06000001,1.5,\r\nW06000002,,2\r\n";
+    CSVReader reader(data);
+
+    THEN( "each row is returned with the correct cells" ) {
+
+      REQUIRE( reader.nextRow(cells) );
+      REQUIRE( cells.size() == 3 );
+      REQUIRE( std::string(cells[0]) == "AuthorityCode" );
+      REQUIRE( std::string(cells[2]) == "2001" );
+
+      REQUIRE( reader.nextRow(cells) );
+      REQUIRE( cells.size() == 3 );
+      REQUIRE( std::string(cells[1]) == "1.5" );
+      REQUIRE( cells[2].empty() );
+
+      REQUIRE( reader.nextRow(cells) );
+      REQUIRE( cells.size() == 3 );
+      REQUIRE( cells[1].empty() );
+      REQUIRE( std::string(cells[2]) == "2" );
+
+      AND_THEN( "there are no more rows" ) {
+
+        REQUIRE_FALSE( reader.nextRow(cells) );
+        REQUIRE( reader.done() );
+
+      } // AND_THEN
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a buffer with quoted cells and no trailing line break" ) {
+
+    const std::string data = "W06000015,\"Cardiff, City of\",\"Caerdydd\nline\"\nW06000016,Rhondda,Rhondda";
+    CSVReader reader(data);
+
+    THEN( "quoted cells may contain delimiters and line breaks" ) {
+
+      REQUIRE( reader.nextRow(cells) );
+      REQUIRE( cells.size() == 3 );
+      REQUIRE( std::string(cells[1]) == "Cardiff, City of" );
+      REQUIRE( std::string(cells[2]) == "Caerdydd\nline" );
+
+      REQUIRE( reader.nextRow(cells) );
+      REQUIRE( cells.size() == 3 );
+      REQUIRE( std::string(cells[2]) == "Rhondda" );
+
+      REQUIRE_FALSE( reader.nextRow(cells) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a CSVReader converts cells to numbers", "[CSVReader][numbers]" ) {
+
+  int year = 0;
+  double value = 0;
+
+  THEN( "valid numbers are converted" ) {
+
+    REQUIRE( CSVReader::toInt("1991", year) );
+    REQUIRE( year == 1991 );
+    REQUIRE( CSVReader::toDouble("711.6801", value) );
+    REQUIRE( value == 711.6801 );
+    REQUIRE( CSVReader::toDouble("69123", value) );
+    REQUIRE( value == 69123 );
+
+  } // THEN
+
+  THEN( "invalid or partial numbers are rejected" ) {
+
+    REQUIRE_FALSE( CSVReader::toInt("", year) );
+    REQUIRE_FALSE( CSVReader::toInt("19x1", year) );
+    REQUIRE_FALSE( CSVReader::toDouble("abc", value) );
+    REQUIRE_FALSE( CSVReader::toDouble("1.5 ", value) );
+
+  } // THEN
+
+} // SCENARIO
+
+SCENARIO( "a by-year CSV file with missing values can be parsed", "[Areas][authorityByYearCSV]" ) {
+
+  GIVEN( "an Areas instance containing the area" ) {
+
+    Areas areas = Areas();
+    areas.setArea("W06000001", Area("W06000001"));
+
+    const std::string data = "AuthorityCode,1991,2001,2011\nW06000001,69123,,69913\n";
+
+    THEN( "only the years with values are imported" ) {
+
+      REQUIRE_NOTHROW( areas.populateFromAuthorityByYearCSV(std::string_view(data), BethYw::InputFiles::COMPLETE_POP.COLS) );
+
+      Measure &pop = areas.getArea("W06000001").getMeasure("pop");
+      REQUIRE( pop.size() == 2 );
+      REQUIRE( pop.getValue(1991) == 69123 );
+      REQUIRE( pop.getValue(2011) == 69913 );
+      REQUIRE_THROWS_AS( pop.getValue(2001), std::out_of_range );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a file with a value that is not a number" ) {
+
+    Areas areas = Areas();
+    areas.setArea("W06000001", Area("W06000001"));
+
+    const std::string data = "AuthorityCode,1991\nW06000001,lots\n";
+
+    THEN( "a std::runtime_error is thrown" ) {
+
+      REQUIRE_THROWS_AS( areas.populateFromAuthorityByYearCSV(std::string_view(data), BethYw::InputFiles::COMPLETE_POP.COLS), std::runtime_error );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,108 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../input.h"
+#include "../datasets.h"
+#include "../areas.h"
+#include "../statswales.h"
+
+SCENARIO( "a StatsWales JSON file can be split into ranges of rows", "[statswales][split]" ) {
+
+  const std::string test_file = "../datasets/popu1009.json";
+
+  GIVEN( "popu1009.json mapped into memory" ) {
+
+    InputMmapFile input(test_file);
+    std::string_view contents = input.open();
+    const auto cols = BethYw::InputFiles::POPDEN.COLS;
+
+    Areas expected = Areas();
+    expected.populateFromWelshStatsJSON(contents, cols);
+
+    WHEN( "the file is split into four ranges" ) {
+
+      auto ranges = BethYw::splitWelshStatsJSON(contents, 4);
+
+      THEN( "four ranges are returned which cover the rest of the file" ) {
+
+        REQUIRE( ranges.size() == 4 );
+        for (size_t i = 1; i < ranges.size(); i++) {
+          REQUIRE( ranges[i - 1].data() + ranges[i - 1].size() == ranges[i].data() );
+          REQUIRE( ranges[i].front() == '{' );
+        }
+        REQUIRE( ranges.back().data() + ranges.back().size() == contents.data() + contents.size() );
+
+      } // THEN
+
+      THEN( "parsing each range gives the same data as parsing the whole file, and only the last range ends the array" ) {
+
+        Areas split = Areas();
+        for (size_t i = 0; i < ranges.size(); i++) {
+          bool ended = BethYw::parseWelshStatsRecords(ranges[i], cols,
+              [&](const BethYw::WelshStatsRecord &record) {
+            Area area(record.authCode);
+            area.setName("eng", record.authNameEng);
+            Measure measure(record.measureCode, record.measureLabel);
+            measure.setValue(record.year, record.value);
+            area.setMeasure(record.measureCode, measure);
+            split.setArea(record.authCode, area);
+          });
+          REQUIRE( ended == (i + 1 == ranges.size()) );
+        }
+
+        REQUIRE( split.size() == expected.size() );
+        REQUIRE( split.getArea("W06000001") == expected.getArea("W06000001") );
+        REQUIRE( split.getArea("W06000023") == expected.getArea("W06000023") );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a range does not end on a row boundary" ) {
+
+      auto ranges = BethYw::splitWelshStatsJSON(contents, 2);
+      REQUIRE( ranges.size() == 2 );
+      std::string_view cut = ranges[1].substr(0, ranges[1].size() / 2);
+
+      THEN( "parsing it throws a std::runtime_error" ) {
+
+        REQUIRE_THROWS_AS( BethYw::parseWelshStatsRecords(cut, cols, [](const BethYw::WelshStatsRecord &) {}), std::runtime_error );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the file is parsed on several threads" ) {
+
+      Areas threaded = Areas();
+      threaded.populateFromWelshStatsJSON(contents, cols, nullptr, nullptr, nullptr, 4);
+
+      THEN( "the data is the same as parsing on one thread" ) {
+
+        REQUIRE( threaded.size() == expected.size() );
+        REQUIRE( threaded.getArea("W06000011") == expected.getArea("W06000011") );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
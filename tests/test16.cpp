@@ -0,0 +1,220 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <climits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../datasets.h"
+#include "../measure.h"
+#include "../areas.h"
+
+SCENARIO( "a Measure stores values for non-contiguous years", "[Measure][dense]" ) {
+
+  GIVEN( "a Measure with values set out of order and with gaps" ) {
+
+    Measure measure("pop", "Population");
+    measure.setValue(2005, 50);
+    measure.setValue(2001, 10);
+    measure.setValue(2003, 30);
+    measure.setValue(2010, 100);
+
+    THEN( "the size is the number of years with a value" ) {
+
+      REQUIRE( measure.size() == 4 );
+
+    } // THEN
+
+    THEN( "the values can be retrieved by year" ) {
+
+      REQUIRE( measure.getValue(2001) == 10 );
+      REQUIRE( measure.getValue(2003) == 30 );
+      REQUIRE( measure.getValue(2005) == 50 );
+      REQUIRE( measure.getValue(2010) == 100 );
+
+    } // THEN
+
+    THEN( "years in the gaps or outside the range have no value" ) {
+
+      REQUIRE_FALSE( measure.hasValue(2002) );
+      REQUIRE_FALSE( measure.hasValue(2000) );
+      REQUIRE_FALSE( measure.hasValue(2011) );
+      REQUIRE_THROWS_AS( measure.getValue(2002), std::out_of_range );
+      REQUIRE_THROWS_WITH( measure.getValue(2002), "No value found for year 2002" );
+
+    } // THEN
+
+    THEN( "the values are held densely from the first to the last year" ) {
+
+      REQUIRE( measure.getFirstYear() == 2001 );
+      REQUIRE( measure.getLastYear() == 2010 );
+      REQUIRE( measure.getDenseValues() == std::vector<double>{10, 0, 30, 0, 50, 0, 0, 0, 0, 100} );
+      REQUIRE( measure.getValues() == std::map<int,double>{{2001, 10}, {2003, 30}, {2005, 50}, {2010, 100}} );
+
+    } // THEN
+
+    THEN( "iterating over the Measure visits each year with a value in order" ) {
+
+      std::vector<int> years;
+      std::vector<double> values;
+      for (auto yearValue : measure) {
+        years.push_back(yearValue.first);
+        values.push_back(yearValue.second);
+      }
+
+      REQUIRE( years == std::vector<int>{2001, 2003, 2005, 2010} );
+      REQUIRE( values == std::vector<double>{10, 30, 50, 100} );
+
+    } // THEN
+
+    THEN( "the statistics only use years with a value" ) {
+
+      REQUIRE( measure.getDifference() == 90 );
+      REQUIRE( measure.getDifferenceAsPercentage() == 900 );
+      REQUIRE( measure.getAverage() == 47.5 );
+
+    } // THEN
+
+    WHEN( "a value is replaced" ) {
+
+      measure.setValue(2003, 35);
+
+      THEN( "the size does not change" ) {
+
+        REQUIRE( measure.size() == 4 );
+        REQUIRE( measure.getValue(2003) == 35 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a Measure with the same values set in a different order is compared" ) {
+
+      Measure other("pop", "Population");
+      other.setValue(2010, 100);
+      other.setValue(2003, 30);
+      other.setValue(2001, 10);
+      other.setValue(2005, 50);
+
+      THEN( "they are equal" ) {
+
+        REQUIRE( measure == other );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "a Measure with a zero in a different year is compared" ) {
+
+      Measure first("pop", "Population");
+      first.setValue(2001, 1);
+      first.setValue(2002, 0);
+      first.setValue(2004, 1);
+
+      Measure second("pop", "Population");
+      second.setValue(2001, 1);
+      second.setValue(2003, 0);
+      second.setValue(2004, 1);
+
+      THEN( "they are not equal" ) {
+
+        REQUIRE_FALSE( first == second );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "an empty Measure" ) {
+
+    Measure measure("pop", "Population");
+
+    THEN( "the statistics are 0" ) {
+
+      REQUIRE( measure.size() == 0 );
+      REQUIRE( measure.getDifference() == 0 );
+      REQUIRE( measure.getDifferenceAsPercentage() == 0 );
+      REQUIRE( measure.getAverage() == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a Measure refuses years far from the rest", "[Measure][dense]" ) {
+
+  GIVEN( "a Measure with values for 2001 and 2005" ) {
+
+    Measure measure("pop", "Population");
+    measure.setValue(2001, 10);
+    measure.setValue(2005, 50);
+
+    THEN( "a year more than MAX_YEAR_SPAN away is refused, and nothing is added" ) {
+
+      REQUIRE_THROWS_AS( measure.setValue(2001 + Measure::MAX_YEAR_SPAN, 1), std::out_of_range );
+      REQUIRE_THROWS_AS( measure.setValue(2005 - Measure::MAX_YEAR_SPAN, 1), std::out_of_range );
+      REQUIRE_THROWS_AS( measure.setValue(INT_MIN, 1), std::out_of_range );
+      REQUIRE_THROWS_AS( measure.setValue(INT_MAX, 1), std::out_of_range );
+      REQUIRE( measure.size() == 2 );
+      REQUIRE( measure.getFirstYear() == 2001 );
+      REQUIRE( measure.getLastYear() == 2005 );
+      REQUIRE_FALSE( measure.hasValue(INT_MIN) );
+      REQUIRE_FALSE( measure.hasValue(INT_MAX) );
+
+    } // THEN
+
+    THEN( "a year just inside the span is kept" ) {
+
+      measure.setValue(2001 + Measure::MAX_YEAR_SPAN - 1, 1);
+      REQUIRE( measure.getValue(2001 + Measure::MAX_YEAR_SPAN - 1) == 1 );
+      REQUIRE( measure.size() == 3 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "StatsWales JSON with a year out of range" ) {
+
+    auto json = [](const std::string& year) {
+      return "{\"value\":[{\"Data\":1.5,\"Localauthority_Code\":\"W06000011\","
+             "\"Localauthority_ItemName_ENG\":\"Swansea\",\"Measure_Code\":\"Pop\","
+             "\"Measure_ItemName_ENG\":\"Population\",\"Year_Code\":" + year + "}]}";
+    };
+
+    THEN( "it is refused where it is parsed, as a number or as text" ) {
+
+      for (std::string year : {"99999", "0", "-2011", "2011.5", "1e300", "\"99999\""}) {
+        Areas areas = Areas();
+        REQUIRE_THROWS_AS( areas.populate(json(year), BethYw::WelshStatsJSON,
+                                          BethYw::InputFiles::POPDEN.COLS,
+                                          nullptr, nullptr, nullptr),
+                           std::runtime_error );
+      }
+
+      Areas areas = Areas();
+      areas.populate(json("2011"), BethYw::WelshStatsJSON, BethYw::InputFiles::POPDEN.COLS,
+                     nullptr, nullptr, nullptr);
+      REQUIRE( areas.getArea("W06000011").getMeasure("pop").getValue(2011) == 1.5 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
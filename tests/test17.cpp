@@ -0,0 +1,191 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../intern.h"
+#include "../area.h"
+#include "../measure.h"
+
+SCENARIO( "strings can be interned", "[InternTable]" ) {
+
+  GIVEN( "an empty InternTable" ) {
+
+    InternTable strings;
+
+    WHEN( "the same string is interned twice" ) {
+
+      InternId first = strings.intern("W06000011");
+      InternId second = strings.intern(std::string("W06000011"));
+
+      THEN( "the same ID is returned and the string is stored once" ) {
+
+        REQUIRE( first == second );
+        REQUIRE( strings.size() == 1 );
+        REQUIRE( strings.lookup(first) == "W06000011" );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "different strings are interned" ) {
+
+      InternId pop = strings.intern("pop");
+      InternId area = strings.intern("area");
+
+      THEN( "different IDs are returned" ) {
+
+        REQUIRE( pop != area );
+        REQUIRE( strings.lookup(pop) == "pop" );
+        REQUIRE( strings.lookup(area) == "area" );
+
+      } // THEN
+
+      THEN( "internLower gives the ID of the lowercase string" ) {
+
+        REQUIRE( strings.internLower("POP") == pop );
+        REQUIRE( strings.size() == 2 );
+        REQUIRE( InternTable::toLower('P') == 'p' );
+        REQUIRE( InternTable::toLower('\xC9') == '\xC9' );
+
+      } // THEN
+
+      THEN( "find only finds strings already in the table" ) {
+
+        InternId id = 0;
+        REQUIRE( strings.find("area", id) );
+        REQUIRE( id == area );
+        REQUIRE_FALSE( strings.find("dens", id) );
+        REQUIRE( strings.size() == 2 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "strings are interned through an InternCache" ) {
+
+      InternId pop = strings.intern("pop");
+      InternCache cache(strings);
+
+      THEN( "it gives the same IDs as the table, and adds new strings to it" ) {
+
+        REQUIRE( cache.intern("pop") == pop );
+        REQUIRE( cache.internLower("POP") == pop );
+        REQUIRE( cache.internLower("Pop") == pop );
+        InternId area = cache.intern("area");
+        REQUIRE( cache.intern("area") == area );
+        REQUIRE( strings.lookup(area) == "area" );
+        REQUIRE( strings.size() == 2 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the strings in the table are visited" ) {
+
+      strings.intern("pop");
+      strings.intern("area");
+      strings.intern("dens");
+      std::vector<std::string> visited;
+      strings.forEach(2, [&](InternId id, const std::string& str) {
+        REQUIRE( id == visited.size() );
+        visited.push_back(str);
+      });
+
+      THEN( "the strings below the end are visited in order of ID" ) {
+
+        REQUIRE( visited == std::vector<std::string>{"pop", "area"} );
+
+      } // THEN
+
+    } // WHEN
+
+    THEN( "looking up an unknown ID throws std::out_of_range" ) {
+
+      REQUIRE_THROWS_AS( strings.lookup(42), std::out_of_range );
+
+    } // THEN
+
+    WHEN( "the same strings are interned from several threads" ) {
+
+      std::vector<std::vector<InternId>> ids(4);
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < ids.size(); t++) {
+        workers.emplace_back([&, t]() {
+          for (int i = 0; i < 1000; i++) {
+            ids[t].push_back(strings.intern("code" + std::to_string(i)));
+          }
+        });
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+
+      THEN( "every thread gets the same ID for each string" ) {
+
+        REQUIRE( strings.size() == 1000 );
+        for (size_t t = 1; t < ids.size(); t++) {
+          REQUIRE( ids[t] == ids[0] );
+        }
+        REQUIRE( strings.lookup(ids[0][7]) == "code7" );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "Area and Measure instances share interned strings", "[InternTable][Area][Measure]" ) {
+
+  GIVEN( "a Measure and an Area constructed from strings" ) {
+
+    InternTable &strings = InternTable::global();
+
+    Measure measure("Pop", "Population");
+    Area area("W06000011");
+    area.setName("ENG", "Swansea");
+
+    THEN( "their IDs refer to the same strings" ) {
+
+      REQUIRE( measure.getCodenameId() == strings.intern("pop") );
+      REQUIRE( measure.getLabelId() == strings.intern("Population") );
+      REQUIRE( area.getLocalAuthorityCodeId() == strings.intern("W06000011") );
+      REQUIRE( area.getName("eng") == "Swansea" );
+
+    } // THEN
+
+    WHEN( "a Measure is added to the Area by ID" ) {
+
+      Measure &stored = area.getMeasure(strings.intern("dens"), strings.intern("Population density"));
+      stored.setValue(2010, 1.5);
+
+      THEN( "it can be retrieved by codename in any case" ) {
+
+        REQUIRE( area.getMeasure("DENS").getValue(2010) == 1.5 );
+        REQUIRE( area.getMeasure("dens").getLabel() == "Population density" );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
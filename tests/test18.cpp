@@ -0,0 +1,131 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#include "../input.h"
+#include "../datasets.h"
+#include "../areas.h"
+#include "../facts.h"
+
+SCENARIO( "an Areas instance can be copied into a columnar FactTable", "[FactTable]" ) {
+
+  GIVEN( "an Areas instance populated with two areas" ) {
+
+    Areas areas = Areas();
+
+    Area swansea("W06000011");
+    Measure swanseaPop("Pop", "Population");
+    swanseaPop.setValue(2014, 100);
+    swanseaPop.setValue(2015, 200);
+    swansea.setMeasure("pop", swanseaPop);
+    Measure swanseaArea("area", "Land area");
+    swanseaArea.setValue(2015, 5);
+    swansea.setMeasure("area", swanseaArea);
+    areas.setArea("W06000011", swansea);
+
+    Area powys("W06000023");
+    Measure powysPop("pop", "Population");
+    powysPop.setValue(2015, 400);
+    powysPop.setValue(2017, 500);
+    powys.setMeasure("pop", powysPop);
+    areas.setArea("W06000023", powys);
+
+    FactTable table = areas.toFactTable();
+
+    THEN( "every value is in the table, partitioned by measure" ) {
+
+      REQUIRE( table.size() == 5 );
+      REQUIRE( table.getPartitions().size() == 2 );
+      REQUIRE( table.getPartition("POP").size() == 4 );
+      REQUIRE( table.getPartition("area").size() == 1 );
+
+    } // THEN
+
+    THEN( "each partition is sorted by year" ) {
+
+      auto &pop = table.getPartition("pop");
+      REQUIRE( pop.years == std::vector<int>{2014, 2015, 2015, 2017} );
+      REQUIRE( pop.values == std::vector<double>{100, 200, 400, 500} );
+
+      auto range = pop.yearRange(2015);
+      REQUIRE( range.first == 1 );
+      REQUIRE( range.second == 3 );
+
+    } // THEN
+
+    THEN( "values can be aggregated across areas for a year" ) {
+
+      REQUIRE( table.count("pop", 2015) == 2 );
+      REQUIRE( table.sum("pop", 2015) == 600 );
+      REQUIRE( table.average("pop", 2015) == 300 );
+      REQUIRE( table.count("pop", 2016) == 0 );
+      REQUIRE( table.average("pop", 2016) == 0 );
+
+    } // THEN
+
+    THEN( "a measure with no values throws std::out_of_range" ) {
+
+      REQUIRE_THROWS_AS( table.getPartition("dens"), std::out_of_range );
+      REQUIRE_THROWS_WITH( table.getPartition("dens"), "No measure found matching dens" );
+
+    } // THEN
+
+    WHEN( "the Areas instance is modified" ) {
+
+      areas.getArea("W06000011").getMeasure("pop").setValue(2016, 1);
+
+      THEN( "the existing table is unchanged" ) {
+
+        REQUIRE( table.size() == 5 );
+        REQUIRE( areas.toFactTable().size() == 6 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "popu1009.json loaded into an Areas instance" ) {
+
+    InputMmapFile input("../datasets/popu1009.json");
+    Areas areas = Areas();
+    areas.populateFromWelshStatsJSON(input.open(), BethYw::InputFiles::POPDEN.COLS);
+
+    FactTable table = areas.toFactTable();
+
+    THEN( "the total population for a year matches the sum over each Area" ) {
+
+      double expected = 0;
+      size_t count = 0;
+      for (auto &it : areas.getAreas()) {
+        const Measure &pop = it.second.getMeasure("pop");
+        if (pop.hasValue(2015)) {
+          expected += pop.getValue(2015);
+          count++;
+        }
+      }
+
+      REQUIRE( count > 0 );
+      REQUIRE( table.count("pop", 2015) == count );
+      REQUIRE( table.sum("pop", 2015) == Approx(expected) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
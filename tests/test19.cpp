@@ -0,0 +1,214 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+#include <tuple>
+
+#include "../input.h"
+#include "../datasets.h"
+#include "../filter.h"
+#include "../areas.h"
+
+SCENARIO( "a RecordFilter matches raw text against the filters", "[RecordFilter]" ) {
+
+  GIVEN( "no filters" ) {
+
+    RecordFilter filter(nullptr, nullptr, nullptr);
+
+    THEN( "everything is kept" ) {
+
+      REQUIRE( filter.keepArea("W06000011") );
+      REQUIRE( filter.keepMeasure("pop") );
+      REQUIRE( filter.keepYear(1991) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "empty filters" ) {
+
+    StringFilterSet areasFilter;
+    StringFilterSet measuresFilter;
+    YearFilterTuple yearsFilter(0, 0);
+    RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+
+    THEN( "everything is kept" ) {
+
+      REQUIRE( filter.keepArea("W06000011") );
+      REQUIRE( filter.keepMeasure("pop") );
+      REQUIRE( filter.keepYear(1991) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "filters for an area, a measure and a range of years" ) {
+
+    StringFilterSet areasFilter = {"W06000011"};
+    StringFilterSet measuresFilter = {"pop"};
+    YearFilterTuple yearsFilter(2010, 2015);
+    RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+
+    THEN( "areas are matched exactly" ) {
+
+      REQUIRE( filter.keepArea("W06000011") );
+      REQUIRE_FALSE( filter.keepArea("w06000011") );
+      REQUIRE_FALSE( filter.keepArea("W06000012") );
+
+    } // THEN
+
+    THEN( "measures are matched regardless of case" ) {
+
+      REQUIRE( filter.keepMeasure("pop") );
+      REQUIRE( filter.keepMeasure("POP") );
+      REQUIRE_FALSE( filter.keepMeasure("area") );
+
+    } // THEN
+
+    THEN( "years are matched inclusively" ) {
+
+      REQUIRE_FALSE( filter.keepYear(2009) );
+      REQUIRE( filter.keepYear(2010) );
+      REQUIRE( filter.keepYear(2015) );
+      REQUIRE_FALSE( filter.keepYear(2016) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a year filter with only one year set" ) {
+
+    YearFilterTuple yearsFilter(2010, 0);
+    RecordFilter filter(nullptr, nullptr, &yearsFilter);
+
+    THEN( "all years are kept" ) {
+
+      REQUIRE( filter.keepYear(1991) );
+      REQUIRE( filter.keepYear(2019) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "filters are applied while a StatsWales JSON file is parsed", "[RecordFilter][popu1009]" ) {
+
+  InputMmapFile input("../datasets/popu1009.json");
+  std::string_view contents = input.open();
+  auto cols = BethYw::InputFiles::POPDEN.COLS;
+
+  GIVEN( "popu1009.json parsed with an area, measure and year filter" ) {
+
+    StringFilterSet areasFilter = {"W06000011"};
+    StringFilterSet measuresFilter = {"POP"};
+    YearFilterTuple yearsFilter(2015, 2015);
+
+    Areas areas = Areas();
+    areas.populate(contents, BethYw::WelshStatsJSON, cols,
+                   &areasFilter, &measuresFilter, &yearsFilter);
+
+    THEN( "only the matching value is imported" ) {
+
+      REQUIRE( areas.size() == 1 );
+      REQUIRE( areas.getArea("W06000011").getName("eng") == "Swansea" );
+      REQUIRE( areas.getArea("W06000011").size() == 1 );
+
+      const Measure &pop = areas.getArea("W06000011").getMeasure("pop");
+      REQUIRE( pop.size() == 1 );
+      REQUIRE( pop.getValue(2015) == 242316 );
+
+    } // THEN
+
+    THEN( "the result matches the same value from an unfiltered import" ) {
+
+      Areas all = Areas();
+      all.populate(contents, BethYw::WelshStatsJSON, cols, nullptr, nullptr, nullptr);
+
+      REQUIRE( all.getArea("W06000011").getMeasure("pop").getValue(2015)
+               == areas.getArea("W06000011").getMeasure("pop").getValue(2015) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "popu1009.json parsed with a year filter that matches nothing" ) {
+
+    YearFilterTuple yearsFilter(1900, 1901);
+
+    Areas areas = Areas();
+    areas.populate(contents, BethYw::WelshStatsJSON, cols,
+                   nullptr, nullptr, &yearsFilter);
+
+    THEN( "no areas are created" ) {
+
+      REQUIRE( areas.size() == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "filters are applied while a CSV file is parsed", "[RecordFilter][csv]" ) {
+
+  GIVEN( "complete-popu1009-pop.csv parsed with a year filter" ) {
+
+    InputMmapFile input("../datasets/complete-popu1009-pop.csv");
+    auto cols = BethYw::InputFiles::COMPLETE_POP.COLS;
+
+    StringFilterSet measuresFilter = {"PoP"};
+    YearFilterTuple yearsFilter(2012, 2014);
+
+    Areas areas = Areas();
+    areas.populate(input.open(), BethYw::AuthorityByYearCSV, cols,
+                   nullptr, &measuresFilter, &yearsFilter);
+
+    THEN( "only the years in the range are imported" ) {
+
+      REQUIRE( areas.size() > 0 );
+
+      const Measure &pop = areas.getArea("W06000011").getMeasure("pop");
+      REQUIRE( pop.size() == 3 );
+      REQUIRE( pop.getFirstYear() == 2012 );
+      REQUIRE( pop.getLastYear() == 2014 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "areas.csv parsed with an area filter" ) {
+
+    InputMmapFile input("../datasets/areas.csv");
+    auto cols = BethYw::InputFiles::AREAS.COLS;
+
+    StringFilterSet areasFilter = {"W06000011", "W06000024"};
+
+    Areas areas = Areas();
+    areas.populate(input.open(), BethYw::AuthorityCodeCSV, cols,
+                   &areasFilter, nullptr, nullptr);
+
+    THEN( "only the matching areas are imported" ) {
+
+      REQUIRE( areas.size() == 2 );
+      REQUIRE( areas.getArea("W06000011").getName("eng") == "Swansea" );
+      REQUIRE( areas.getArea("W06000024").getName("cym") == "Merthyr Tudful" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,169 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "../input.h"
+#include "../datasets.h"
+#include "../filter.h"
+#include "../areas.h"
+#include "../snapshot.h"
+
+SCENARIO( "a Measure can be given its readings as a dense array", "[Measure][dense]" ) {
+
+  GIVEN( "a dense array with missing years at both ends and in the middle" ) {
+
+    double values[] = {9, 1.5, 9, 2.5, 9};
+    unsigned char present[] = {0, 1, 0, 1, 0};
+
+    Measure measure("pop", "Population");
+    measure.setValue(1990, 100);
+    measure.setDenseValues(2009, values, present, 5);
+
+    THEN( "the previous readings are replaced and the missing years are dropped" ) {
+
+      REQUIRE( measure.size() == 2 );
+      REQUIRE( measure.getFirstYear() == 2010 );
+      REQUIRE( measure.getLastYear() == 2012 );
+      REQUIRE( measure.getValue(2010) == 1.5 );
+      REQUIRE( measure.getValue(2012) == 2.5 );
+      REQUIRE_FALSE( measure.hasValue(2011) );
+      REQUIRE_FALSE( measure.hasValue(1990) );
+      REQUIRE( measure.getAverage() == 2 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "an Areas instance can be saved to a snapshot and loaded back", "[snapshot]" ) {
+
+  Areas original = Areas();
+
+  InputMmapFile areasFile("../datasets/areas.csv");
+  original.populate(areasFile.open(), BethYw::AuthorityCodeCSV,
+                    BethYw::InputFiles::AREAS.COLS);
+
+  InputMmapFile popden("../datasets/popu1009.json");
+  original.populate(popden.open(), BethYw::WelshStatsJSON,
+                    BethYw::InputFiles::POPDEN.COLS, nullptr, nullptr, nullptr);
+
+  std::ostringstream os;
+  BethYw::writeSnapshot(os, original);
+  const std::string snapshot = os.str();
+
+  GIVEN( "a snapshot of areas.csv and popu1009.json" ) {
+
+    THEN( "loading it gives the same data" ) {
+
+      Areas loaded = Areas();
+      BethYw::readSnapshot(snapshot, loaded);
+
+      REQUIRE( loaded.size() == original.size() );
+      for (const auto& codeArea : original.getAreas()) {
+        REQUIRE( loaded.getArea(codeArea.second.getLocalAuthorityCode()) == codeArea.second );
+      }
+      REQUIRE( loaded.getArea("W06000011").getName("cym") == "Abertawe" );
+      REQUIRE( loaded.getArea("W06000023").getMeasure("pop").getValue(2019) == 132435 );
+
+    } // THEN
+
+    THEN( "loading it with filters gives the same data as importing with them" ) {
+
+      StringFilterSet areasFilter = {"W06000011", "W06000023"};
+      StringFilterSet measuresFilter = {"Dens"};
+      YearFilterTuple yearsFilter(2005, 2010);
+      RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+
+      Areas loaded = Areas();
+      BethYw::readSnapshot(snapshot, loaded, &filter);
+
+      Areas imported = Areas();
+      imported.populate(areasFile.open(), BethYw::AuthorityCodeCSV,
+                        BethYw::InputFiles::AREAS.COLS, &areasFilter, nullptr, nullptr);
+      imported.populate(popden.open(), BethYw::WelshStatsJSON,
+                        BethYw::InputFiles::POPDEN.COLS,
+                        &areasFilter, &measuresFilter, &yearsFilter);
+
+      REQUIRE( loaded.size() == 2 );
+      REQUIRE( loaded.getArea("W06000011") == imported.getArea("W06000011") );
+      REQUIRE( loaded.getArea("W06000023") == imported.getArea("W06000023") );
+
+      const Measure &dens = loaded.getArea("W06000011").getMeasure("dens");
+      REQUIRE( dens.getFirstYear() == 2005 );
+      REQUIRE( dens.getLastYear() == 2010 );
+
+    } // THEN
+
+    THEN( "loading it into an Areas instance with data merges the two" ) {
+
+      Areas loaded = Areas();
+      Area extra("W06000011");
+      Measure measure("extra", "Extra measure");
+      measure.setValue(2000, 1);
+      extra.setMeasure("extra", measure);
+      loaded.setArea("W06000011", extra);
+
+      BethYw::readSnapshot(snapshot, loaded);
+
+      REQUIRE( loaded.getArea("W06000011").size() == original.getArea("W06000011").size() + 1 );
+      REQUIRE( loaded.getArea("W06000011").getName("eng") == "Swansea" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a buffer that is not a valid snapshot" ) {
+
+    THEN( "loading text throws an exception" ) {
+
+      Areas loaded = Areas();
+      const std::string text(64, 'x');
+
+      REQUIRE_THROWS_AS( BethYw::readSnapshot(text, loaded), std::runtime_error );
+      REQUIRE_THROWS_WITH( BethYw::readSnapshot(text, loaded),
+                           "BethYw::readSnapshot: Not a snapshot" );
+
+    } // THEN
+
+    THEN( "loading a truncated snapshot throws an exception" ) {
+
+      Areas loaded = Areas();
+      const std::string truncated = snapshot.substr(0, snapshot.size() / 2);
+
+      REQUIRE_THROWS_WITH( BethYw::readSnapshot(truncated, loaded),
+                           "BethYw::readSnapshot: Truncated snapshot" );
+
+    } // THEN
+
+    THEN( "loading a snapshot from a different version throws an exception" ) {
+
+      Areas loaded = Areas();
+      std::string future = snapshot;
+      future[8] = (char) (BethYw::SNAPSHOT_VERSION + 1);
+
+      REQUIRE_THROWS_WITH( BethYw::readSnapshot(future, loaded),
+                           "BethYw::readSnapshot: Unsupported snapshot version "
+                           + std::to_string(BethYw::SNAPSHOT_VERSION + 1) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,185 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "../input.h"
+#include "../datasets.h"
+#include "../jsonwriter.h"
+#include "../areas.h"
+
+SCENARIO( "a JSONWriter writes JSON text as it goes", "[JSONWriter]" ) {
+
+  GIVEN( "a JSONWriter with no stream" ) {
+
+    JSONWriter writer;
+
+    THEN( "an empty object is written as {}" ) {
+
+      writer.beginObject();
+      writer.endObject();
+
+      REQUIRE( writer.str() == "{}" );
+
+    } // THEN
+
+    THEN( "commas and colons are added between keys and values" ) {
+
+      writer.beginObject();
+      writer.key("a");
+      writer.beginObject();
+      writer.key(2015);
+      writer.value(1.5);
+      writer.key(2016);
+      writer.value(2.25);
+      writer.endObject();
+      writer.key("b");
+      writer.value("text");
+      writer.endObject();
+
+      REQUIRE( writer.str() == "{\"a\":{\"2015\":1.5,\"2016\":2.25},\"b\":\"text\"}" );
+
+    } // THEN
+
+    THEN( "numbers are written in their shortest form, with .0 on whole numbers" ) {
+
+      writer.beginObject();
+      writer.key("a");
+      writer.value(98.195805);
+      writer.key("b");
+      writer.value(69123);
+      writer.key("c");
+      writer.value(0.1 + 0.2);
+      writer.key("d");
+      writer.value(std::numeric_limits<double>::quiet_NaN());
+      writer.endObject();
+
+      REQUIRE( writer.str() == "{\"a\":98.195805,\"b\":69123.0,\"c\":0.30000000000000004,\"d\":null}" );
+
+    } // THEN
+
+    THEN( "strings are escaped" ) {
+
+      writer.beginObject();
+      writer.key("quote\"back\\slash");
+      writer.value("line\nbreak\ttab\x01 Ynys Môn");
+      writer.endObject();
+
+      REQUIRE( writer.str() == "{\"quote\\\"back\\\\slash\":\"line\\nbreak\\ttab\\u0001 Ynys Môn\"}" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a JSONWriter with a stream" ) {
+
+    std::ostringstream os;
+
+    THEN( "everything is written to the stream once the writer is destroyed" ) {
+
+      {
+        JSONWriter writer(os);
+        writer.beginObject();
+        writer.key("pop");
+        writer.value(1234.5);
+        writer.endObject();
+      }
+
+      REQUIRE( os.str() == "{\"pop\":1234.5}" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "an Areas instance can be written as JSON", "[Areas][JSON]" ) {
+
+  GIVEN( "an empty Areas instance" ) {
+
+    Areas areas = Areas();
+
+    THEN( "the JSON is {}" ) {
+
+      REQUIRE( areas.toJSON() == "{}" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "an Areas instance with an Area that has names and a Measure" ) {
+
+    Areas areas = Areas();
+    Area area("W06000011");
+    area.setName("eng", "Swansea");
+    area.setName("cym", "Abertawe");
+    Measure measure("Pop", "Population");
+    measure.setValue(2015, 242316);
+    measure.setValue(2016, 243000.5);
+    area.setMeasure("Pop", measure);
+    areas.setArea("W06000011", area);
+    areas.setArea("W06000001", Area("W06000001"));
+
+    const std::string expected =
+        "{\"W06000001\":{},"
+        "\"W06000011\":{\"measures\":{\"pop\":{\"2015\":242316.0,\"2016\":243000.5}},"
+        "\"names\":{\"cym\":\"Abertawe\",\"eng\":\"Swansea\"}}}";
+
+    THEN( "toJSON() gives the areas, measures and names in order, leaving out empty objects" ) {
+
+      REQUIRE( areas.toJSON() == expected );
+
+    } // THEN
+
+    THEN( "writeJSON() writes the same JSON to a stream" ) {
+
+      std::ostringstream os;
+      areas.writeJSON(os);
+
+      REQUIRE( os.str() == expected );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "complete-popu1009-popden.csv imported with areas.csv" ) {
+
+    Areas areas = Areas();
+    InputMmapFile areasFile("../datasets/areas.csv");
+    areas.populate(areasFile.open(), BethYw::AuthorityCodeCSV,
+                   BethYw::InputFiles::AREAS.COLS);
+    InputMmapFile popden("../datasets/complete-popu1009-popden.csv");
+    areas.populate(popden.open(), BethYw::AuthorityByYearCSV,
+                   BethYw::InputFiles::COMPLETE_POPDEN.COLS, nullptr, nullptr, nullptr);
+
+    THEN( "the JSON matches the expected output" ) {
+
+      std::ifstream stream("../tests/output9. bethyw -d complete-popden -j.json");
+      REQUIRE( stream.is_open() );
+      const std::string expected((std::istreambuf_iterator<char>(stream)),
+                                 std::istreambuf_iterator<char>());
+
+      REQUIRE( areas.toJSON() == expected );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,150 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "../tablewriter.h"
+#include "../areas.h"
+
+SCENARIO( "a TableWriter formats cells like a default stream", "[TableWriter]" ) {
+
+  GIVEN( "a TableWriter for a string stream" ) {
+
+    std::ostringstream os;
+
+    THEN( "numbers are right-aligned to six significant figures, as with std::setw" ) {
+
+      const double values[] = {711.6801, 97.126504, 69123, 0.000012345, 1234567.8, -2.5, 0};
+
+      std::ostringstream expected;
+      {
+        TableWriter writer(os);
+        for (double value : values) {
+          writer.number(value, 10);
+          expected << std::setw(10) << value;
+        }
+        writer.integer(2015, 10);
+        expected << std::setw(10) << 2015;
+        writer.text("Average", 13);
+        expected << std::setw(13) << "Average";
+      }
+
+      REQUIRE( os.str() == expected.str() );
+
+    } // THEN
+
+    THEN( "nothing reaches the stream until the writer is flushed or destroyed" ) {
+
+      TableWriter writer(os);
+      writer.text("pop");
+
+      REQUIRE( os.str().empty() );
+
+      writer.flush();
+
+      REQUIRE( os.str() == "pop" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "Areas, Area and Measure objects are printed as tables", "[TableWriter][output]" ) {
+
+  Measure measure("Pop", "Population");
+  measure.setValue(2015, 242316);
+  measure.setValue(2016, 1234.5);
+
+  const std::string measureTable =
+      "Population(pop)\n"
+      "      2015      2016      Average       Diff.  %Diff.\n"
+      "    242316    1234.5\n";
+
+  GIVEN( "a Measure" ) {
+
+    THEN( "it is printed as its label, codename, years and values" ) {
+
+      std::ostringstream os;
+      os << measure;
+
+      REQUIRE( os.str() == measureTable );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "Areas with both names, one name and no names" ) {
+
+    Area both("W06000011");
+    both.setName("eng", "Swansea");
+    both.setName("cym", "Abertawe");
+    both.setMeasure("pop", measure);
+
+    Area english("E12000001");
+    english.setName("eng", "North East");
+
+    Area unnamed("W06000099");
+
+    THEN( "an Area with both names prints both" ) {
+
+      std::ostringstream os;
+      os << both;
+
+      REQUIRE( os.str() == "Swansea / Abertawe (W06000011)\n" + measureTable );
+
+    } // THEN
+
+    THEN( "an Area with one name prints only that name" ) {
+
+      std::ostringstream os;
+      os << english;
+
+      REQUIRE( os.str() == "North East (E12000001)\n<no measures>\n" );
+
+    } // THEN
+
+    THEN( "an Area with no names is printed as Unnamed" ) {
+
+      std::ostringstream os;
+      os << unnamed;
+
+      REQUIRE( os.str() == "Unnamed (W06000099)\n<no measures>\n" );
+
+    } // THEN
+
+    THEN( "Areas prints each Area in order of local authority code" ) {
+
+      Areas areas = Areas();
+      areas.setArea("W06000099", unnamed);
+      areas.setArea("W06000011", both);
+      areas.setArea("E12000001", english);
+
+      std::ostringstream os;
+      os << areas;
+
+      REQUIRE( os.str() ==
+               "North East (E12000001)\n<no measures>\n"
+               "Swansea / Abertawe (W06000011)\n" + measureTable +
+               "Unnamed (W06000099)\n<no measures>\n" );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
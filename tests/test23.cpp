@@ -0,0 +1,236 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../serve.h"
+
+#ifndef _WIN32
+namespace {
+
+//Connects to the socket at path, retrying while the server starts up
+int connectTo(const std::string& path) {
+  for (int attempt = 0; attempt < 100; attempt++) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    path.copy(address.sun_path, path.size());
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address),
+                  sizeof(address)) == 0) {
+      return fd;
+    }
+    ::close(fd);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return -1;
+}
+
+//Reads from fd until size bytes have arrived, or it is closed or times out
+std::string receiveFrom(int fd, size_t size) {
+  std::string received;
+  char chunk[4096];
+  while (received.size() < size) {
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) {
+      break;
+    }
+    received.append(chunk, static_cast<size_t>(n));
+  }
+  return received;
+}
+
+} // namespace
+#endif
+
+SCENARIO( "a QueryServer answers queries as bethyw would", "[QueryServer][serve]" ) {
+
+  const std::string dir = "../datasets/";
+
+  GIVEN( "a QueryServer with the popden and trains datasets loaded" ) {
+
+    BethYw::QueryServer server(dir,
+                               {BethYw::InputFiles::POPDEN,
+                                BethYw::InputFiles::TRAINS},
+                               {}, {}, std::make_tuple(0, 0), 1);
+
+    THEN( "a JSON query gives the same output as importing with the same filters" ) {
+
+      StringFilterSet areasFilter = {"W06000011"};
+      Areas expected = Areas();
+      BethYw::loadAreas(expected, dir, areasFilter);
+      BethYw::loadDatasets(expected, dir, {BethYw::InputFiles::POPDEN},
+                           areasFilter, {}, std::make_tuple(0, 0));
+
+      REQUIRE( server.query("-d popden -a W06000011 -j") ==
+               expected.toJSON() + "\n" );
+
+    } // THEN
+
+    THEN( "a table query with measure and year filters gives the same output as importing" ) {
+
+      StringFilterSet areasFilter = {"W06000011", "W06000012"};
+      StringFilterSet measuresFilter = {"pop"};
+      YearFilterTuple yearsFilter = std::make_tuple(2010, 2015);
+      Areas expected = Areas();
+      BethYw::loadAreas(expected, dir, areasFilter);
+      BethYw::loadDatasets(expected, dir, {BethYw::InputFiles::POPDEN},
+                           areasFilter, measuresFilter, yearsFilter);
+
+      std::ostringstream os;
+      os << expected << '\n';
+
+      REQUIRE( server.query("--datasets popden --areas W06000011,W06000012 "
+                            "--measures pop --years 2010-2015") == os.str() );
+
+    } // THEN
+
+    THEN( "a query for a dataset that was not loaded throws" ) {
+
+      REQUIRE_THROWS_AS( server.query("-d aqi -j"), std::invalid_argument );
+
+    } // THEN
+
+    THEN( "a query using a startup option throws" ) {
+
+      REQUIRE_THROWS_AS( server.query("-d popden --dir /tmp"),
+                         std::invalid_argument );
+      REQUIRE_THROWS_AS( server.query("-d popden --serve x.sock"),
+                         std::invalid_argument );
+
+    } // THEN
+
+    THEN( "a query with an unexpected argument throws" ) {
+
+      REQUIRE_THROWS_AS( server.query("-d popden W06000011"),
+                         std::invalid_argument );
+
+    } // THEN
+
+#ifndef _WIN32
+    THEN( "queries sent over the socket get an OK or ERROR response" ) {
+
+      const std::string path = "/tmp/bethyw-test23-" +
+                               std::to_string(::getpid()) + ".sock";
+      std::atomic<bool> stopping(false);
+      std::thread serving([&]() { server.serve(path, 2, stopping); });
+
+      int fd = connectTo(path);
+      REQUIRE( fd >= 0 );
+
+      const std::string queries = "-d popden -a W06000011 -j\n-d aqi\n";
+      REQUIRE( ::send(fd, queries.data(), queries.size(), 0) ==
+               static_cast<ssize_t>(queries.size()) );
+
+      const std::string okBody = server.query("-d popden -a W06000011 -j");
+      const std::string errorBody = "Dataset not loaded by server: aqi";
+      const std::string expected =
+          "OK " + std::to_string(okBody.size()) + "\n" + okBody +
+          "ERROR " + std::to_string(errorBody.size()) + "\n" + errorBody;
+
+      std::string received = receiveFrom(fd, expected.size());
+      ::close(fd);
+
+      stopping = true;
+      serving.join();
+
+      REQUIRE( received == expected );
+      REQUIRE( ::access(path.c_str(), F_OK) != 0 );
+
+    } // THEN
+
+    THEN( "a client that stays connected without sending does not hold up another" ) {
+
+      const std::string path = "/tmp/bethyw-test23-idle-" +
+                               std::to_string(::getpid()) + ".sock";
+      std::atomic<bool> stopping(false);
+      std::thread serving([&]() { server.serve(path, 1, stopping); });
+
+      int idle = connectTo(path);
+      REQUIRE( idle >= 0 );
+      int busy = connectTo(path);
+      REQUIRE( busy >= 0 );
+
+      //don't wait forever if the server never answers
+      timeval timeout = {5, 0};
+      ::setsockopt(busy, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+      const std::string request = "-d popden -a W06000011 -m pop -y 2015";
+      const std::string line = request + "\n";
+      REQUIRE( ::send(busy, line.data(), line.size(), 0) ==
+               static_cast<ssize_t>(line.size()) );
+
+      const std::string body = server.query(request);
+      const std::string expected = "OK " + std::to_string(body.size()) + "\n" + body;
+      std::string received = receiveFrom(busy, expected.size());
+      ::close(busy);
+      ::close(idle);
+
+      stopping = true;
+      serving.join();
+
+      REQUIRE( received == expected );
+
+    } // THEN
+#endif
+
+  } // GIVEN
+
+  GIVEN( "a QueryServer with only the popden dataset loaded" ) {
+
+    BethYw::QueryServer server(dir, {BethYw::InputFiles::POPDEN},
+                               {}, {}, std::make_tuple(0, 0), 1);
+
+    THEN( "a query without -d is answered from the loaded dataset" ) {
+
+      StringFilterSet areasFilter = {"W06000024"};
+      Areas expected = Areas();
+      BethYw::loadAreas(expected, dir, areasFilter);
+      BethYw::loadDatasets(expected, dir, {BethYw::InputFiles::POPDEN},
+                           areasFilter, {}, std::make_tuple(0, 0));
+
+      std::ostringstream os;
+      os << expected << '\n';
+
+      REQUIRE( server.query("-a W06000024") == os.str() );
+
+    } // THEN
+
+    THEN( "a query naming a dataset that was not loaded still throws" ) {
+
+      REQUIRE_THROWS_AS( server.query("-d trains -a W06000024"),
+                         std::invalid_argument );
+      REQUIRE_THROWS_AS( server.query("-d all"), std::invalid_argument );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,194 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include "../lib_json.hpp"
+
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../stats.h"
+#include "../areas.h"
+
+SCENARIO( "the parsers count the records they read, filter out and merge", "[stats]" ) {
+
+  const std::string dir = "../datasets/";
+
+  GIVEN( "a filter for one area" ) {
+
+    StringFilterSet areasFilter = {"W06000011"};
+
+    THEN( "importing areas.csv counts one record kept and the rest filtered out" ) {
+
+      Areas areas = Areas();
+      BethYw::RunStats stats;
+      BethYw::loadAreas(areas, dir, areasFilter, &stats);
+
+      REQUIRE( stats.imports.size() == 1 );
+      const BethYw::ImportStats& import = stats.imports[0];
+      REQUIRE( import.name == "areas" );
+      REQUIRE( import.bytesRead > 0 );
+      REQUIRE( import.recordsParsed == 22 );
+      REQUIRE( import.recordsMerged == 1 );
+      REQUIRE( import.recordsFiltered == 21 );
+
+    } // THEN
+
+    THEN( "the counts for a StatsWales file add up, on one thread or several" ) {
+
+      for (unsigned int threads : {1u, 4u}) {
+        Areas areas = Areas();
+        BethYw::RunStats stats;
+        BethYw::loadDatasets(areas, dir, {BethYw::InputFiles::POPDEN},
+                             areasFilter, {}, std::make_tuple(0, 0), threads,
+                             &stats);
+
+        REQUIRE( stats.imports.size() == 1 );
+        const BethYw::ImportStats& import = stats.imports[0];
+        REQUIRE( import.name == "popden" );
+        REQUIRE( import.recordsParsed == 1000 );
+        REQUIRE( import.recordsMerged > 0 );
+        REQUIRE( import.recordsParsed ==
+                 import.recordsMerged + import.recordsFiltered );
+
+        size_t values = 0;
+        for (const Measure* measure :
+             areas.getArea("W06000011").getMeasuresInOrder()) {
+          values += measure->size();
+        }
+        REQUIRE( import.recordsMerged == values );
+      }
+
+    } // THEN
+
+    THEN( "a CSV file with a column per year counts rows read and values merged" ) {
+
+      Areas areas = Areas();
+      BethYw::RunStats stats;
+      YearFilterTuple yearsFilter = std::make_tuple(2011, 2013);
+      BethYw::loadDatasets(areas, dir, {BethYw::InputFiles::COMPLETE_POP},
+                           areasFilter, {}, yearsFilter, 1, &stats);
+
+      const BethYw::ImportStats& import = stats.imports[0];
+      REQUIRE( import.recordsParsed == 22 );
+      REQUIRE( import.recordsFiltered == 21 );
+      REQUIRE( import.recordsMerged == 3 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "no RunStats" ) {
+
+    THEN( "importing gives the same data as with one" ) {
+
+      Areas without = Areas();
+      BethYw::loadDatasets(without, dir, {BethYw::InputFiles::TRAINS},
+                           {}, {}, std::make_tuple(0, 0));
+
+      Areas with = Areas();
+      BethYw::RunStats stats;
+      BethYw::loadDatasets(with, dir, {BethYw::InputFiles::TRAINS},
+                           {}, {}, std::make_tuple(0, 0), 1, &stats);
+
+      REQUIRE( with.toJSON() == without.toJSON() );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a RunStats report can be written as a table or as JSON", "[stats]" ) {
+
+  GIVEN( "the figures for two imports" ) {
+
+    BethYw::RunStats stats;
+    BethYw::ImportStats first;
+    first.name = "popden";
+    first.bytesRead = 1000;
+    first.recordsParsed = 10;
+    first.recordsFiltered = 4;
+    first.recordsMerged = 6;
+    first.parseMs = 2.5;
+    BethYw::ImportStats second = first;
+    second.name = "trains";
+    second.mergeMs = 0.5;
+    stats.imports = {first, second};
+    stats.outputBytes = 1234;
+    stats.formatMs = 0.25;
+
+    THEN( "the JSON report has each import, the totals and the output" ) {
+
+      std::ostringstream os;
+      stats.writeJSON(os);
+      auto report = nlohmann::json::parse(os.str());
+
+      REQUIRE( report["imports"]["popden"]["recordsMerged"] == 6 );
+      REQUIRE( report["imports"]["trains"]["wallMs"] == 3.0 );
+      REQUIRE( report["total"]["bytesRead"] == 2000 );
+      REQUIRE( report["total"]["recordsParsed"] == 20 );
+      REQUIRE( report["format"]["outputBytes"] == 1234 );
+
+    } // THEN
+
+    THEN( "the table has a heading, a row per import and a total row" ) {
+
+      std::ostringstream os;
+      stats.writeTable(os);
+      std::istringstream lines(os.str());
+      std::string line;
+
+      std::getline(lines, line);
+      REQUIRE( line.rfind("Import", 0) == 0 );
+      std::getline(lines, line);
+      REQUIRE( line.rfind("popden", 0) == 0 );
+      std::getline(lines, line);
+      REQUIRE( line.rfind("trains", 0) == 0 );
+      std::getline(lines, line);
+      REQUIRE( line.rfind("Total", 0) == 0 );
+      REQUIRE( line.find("2000") != std::string::npos );
+      std::getline(lines, line);
+      REQUIRE( line.rfind("Output 1234 bytes", 0) == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a CountingStreamBuf counts what passes through it", "[stats]" ) {
+
+  GIVEN( "a CountingStreamBuf in front of a string stream" ) {
+
+    std::ostringstream target;
+    BethYw::CountingStreamBuf counter(target.rdbuf());
+    std::ostream os(&counter);
+
+    THEN( "everything written arrives, and is counted" ) {
+
+      os << "pop" << ' ' << 2015 << std::endl;
+
+      REQUIRE( target.str() == "pop 2015\n" );
+      REQUIRE( counter.bytes() == 9 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
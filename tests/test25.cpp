@@ -0,0 +1,143 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "../datasets.h"
+#include "../generate.h"
+#include "../areas.h"
+
+namespace {
+
+std::string generate(const BethYw::InputFileSource& source,
+                     const BethYw::GeneratorSettings& settings) {
+  std::ostringstream os;
+  BethYw::DatasetGenerator(source, settings).write(os);
+  return os.str();
+}
+
+} // namespace
+
+SCENARIO( "a DatasetGenerator writes deterministic synthetic datasets", "[DatasetGenerator]" ) {
+
+  GIVEN( "settings for 5 areas, 2 measures and 10 years" ) {
+
+    BethYw::GeneratorSettings settings;
+    settings.areas = 5;
+    settings.measures = 2;
+    settings.firstYear = 2001;
+    settings.lastYear = 2010;
+    settings.seed = 42;
+
+    THEN( "the same settings give the same bytes, and another seed different ones" ) {
+
+      const std::string first = generate(BethYw::InputFiles::POPDEN, settings);
+
+      REQUIRE( generate(BethYw::InputFiles::POPDEN, settings) == first );
+
+      settings.seed = 43;
+
+      REQUIRE( generate(BethYw::InputFiles::POPDEN, settings) != first );
+
+    } // THEN
+
+    THEN( "a generated StatsWales JSON file parses into every area, measure and year" ) {
+
+      Areas areas = Areas();
+      areas.populate(generate(BethYw::InputFiles::POPDEN, settings),
+                     BethYw::WelshStatsJSON,
+                     BethYw::InputFiles::POPDEN.COLS,
+                     nullptr, nullptr, nullptr);
+
+      REQUIRE( areas.size() == 5 );
+      const Area& last = areas.getArea(BethYw::DatasetGenerator::areaCode(4));
+      REQUIRE( last.getLocalAuthorityCode() == "W06000005" );
+      REQUIRE( last.size() == 2 );
+      REQUIRE( last.getMeasure("popden-m2").size() == 10 );
+      REQUIRE( last.getMeasure("popden-m2").getFirstYear() == 2001 );
+
+    } // THEN
+
+    THEN( "a single measure JSON dataset uses the measure from its columns" ) {
+
+      Areas areas = Areas();
+      areas.populate(generate(BethYw::InputFiles::TRAINS, settings),
+                     BethYw::WelshStatsJSON,
+                     BethYw::InputFiles::TRAINS.COLS,
+                     nullptr, nullptr, nullptr);
+
+      REQUIRE( areas.size() == 5 );
+      REQUIRE( areas.getArea("W06000001").getMeasure("rail").size() == 10 );
+
+    } // THEN
+
+    THEN( "duplicate rows add rows but not values" ) {
+
+      settings.duplicates = 0.5;
+      const std::string duplicated = generate(BethYw::InputFiles::COMPLETE_POP, settings);
+      settings.duplicates = 0;
+      const std::string plain = generate(BethYw::InputFiles::COMPLETE_POP, settings);
+
+      REQUIRE( duplicated.size() > plain.size() );
+
+      Areas areas = Areas();
+      areas.populate(duplicated,
+                     BethYw::AuthorityByYearCSV,
+                     BethYw::InputFiles::COMPLETE_POP.COLS,
+                     nullptr, nullptr, nullptr);
+
+      REQUIRE( areas.size() == 5 );
+      REQUIRE( areas.getArea("W06000003").getMeasure("pop").size() == 10 );
+
+    } // THEN
+
+    THEN( "a generated areas.csv names every area" ) {
+
+      Areas areas = Areas();
+      areas.populate(generate(BethYw::InputFiles::AREAS, settings),
+                     BethYw::AuthorityCodeCSV,
+                     BethYw::InputFiles::AREAS.COLS);
+
+      REQUIRE( areas.size() == 5 );
+      REQUIRE( areas.getArea("W06000002").getName("eng") == "Area 2" );
+      REQUIRE( areas.getArea("W06000002").getName("cym") == "Ardal 2" );
+
+    } // THEN
+
+    THEN( "settings that make no sense are rejected" ) {
+
+      BethYw::GeneratorSettings bad = settings;
+      bad.areas = 0;
+      REQUIRE_THROWS_AS( BethYw::DatasetGenerator(BethYw::InputFiles::POPDEN, bad),
+                         std::invalid_argument );
+
+      bad = settings;
+      bad.firstYear = 2011;
+      REQUIRE_THROWS_AS( BethYw::DatasetGenerator(BethYw::InputFiles::POPDEN, bad),
+                         std::invalid_argument );
+
+      bad = settings;
+      bad.duplicates = 1;
+      REQUIRE_THROWS_AS( BethYw::DatasetGenerator(BethYw::InputFiles::POPDEN, bad),
+                         std::invalid_argument );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
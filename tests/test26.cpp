@@ -0,0 +1,265 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "../datasets.h"
+#include "../filter.h"
+#include "../index.h"
+#include "../input.h"
+#include "../areas.h"
+
+namespace {
+
+//Imports a file twice, reading all of it and through its index, as JSON
+std::tuple<std::string, std::string> importBothWays(
+    std::string_view contents,
+    const BethYw::InputFileSource& source,
+    const StringFilterSet& areasFilter,
+    const StringFilterSet& measuresFilter,
+    const YearFilterTuple& yearsFilter) {
+  BethYw::DatasetIndex index = BethYw::DatasetIndex::build(contents, source, 0);
+
+  Areas whole = Areas();
+  whole.populate(contents, source.PARSER, source.COLS,
+                 &areasFilter, &measuresFilter, &yearsFilter);
+  Areas indexed = Areas();
+  indexed.populateFromIndex(contents, index, source.PARSER, source.COLS,
+                            &areasFilter, &measuresFilter, &yearsFilter);
+  return std::make_tuple(whole.toJSON(), indexed.toJSON());
+}
+
+} // namespace
+
+SCENARIO( "a DatasetIndex finds the records for the filtered areas and measures", "[DatasetIndex]" ) {
+
+  const std::string dir = "../datasets/";
+
+  GIVEN( "the popden StatsWales export" ) {
+
+    const BethYw::InputFileSource& source = BethYw::InputFiles::POPDEN;
+    InputMmapFile input(dir + source.FILE);
+    std::string_view contents = input.open();
+    BethYw::DatasetIndex index = BethYw::DatasetIndex::build(contents, source, 0);
+
+    THEN( "records with the same area and measure are grouped into runs" ) {
+
+      REQUIRE( index.runs() > 0 );
+      REQUIRE( index.runs() < 1000 );
+      REQUIRE( index.getFileSize() == contents.size() );
+      REQUIRE( index.getHeaderSize() == 0 );
+
+    } // THEN
+
+    THEN( "a filter for one area selects a small part of the file" ) {
+
+      StringFilterSet areasFilter = {"W06000011"};
+      RecordFilter filter(&areasFilter, nullptr, nullptr);
+      std::vector<BethYw::ByteRange> ranges;
+
+      REQUIRE( index.select(filter, ranges) );
+      REQUIRE_FALSE( ranges.empty() );
+      for (const BethYw::ByteRange& range : ranges) {
+        REQUIRE( contents[range.first] == '{' );
+        REQUIRE( contents[range.second - 1] == '}' );
+      }
+
+    } // THEN
+
+    THEN( "no filter selects the whole file, which is then read in order" ) {
+
+      RecordFilter filter(nullptr, nullptr, nullptr);
+      std::vector<BethYw::ByteRange> ranges;
+
+      REQUIRE_FALSE( index.select(filter, ranges) );
+
+    } // THEN
+
+    THEN( "importing through the index gives the same data as reading it all" ) {
+
+      for (const StringFilterSet& areasFilter : std::vector<StringFilterSet>{
+               {"W06000011"}, {"W06000011", "W06000023"}, {"W06999999"}, {}}) {
+        for (const StringFilterSet& measuresFilter : std::vector<StringFilterSet>{
+                 {"DENS"}, {"pop", "area"}, {}}) {
+          auto imports = importBothWays(contents, source, areasFilter,
+                                        measuresFilter, std::make_tuple(2000, 2010));
+          REQUIRE( std::get<0>(imports) == std::get<1>(imports) );
+        }
+      }
+
+    } // THEN
+
+    THEN( "the index can be written and read back" ) {
+
+      std::stringstream stream;
+      index.write(stream);
+      BethYw::DatasetIndex copy = BethYw::DatasetIndex::read(stream.str());
+
+      REQUIRE( copy.runs() == index.runs() );
+      REQUIRE( copy.isFor(source, contents.size(), 0) );
+      REQUIRE_FALSE( copy.isFor(source, contents.size(), 1) );
+      REQUIRE_FALSE( copy.isFor(BethYw::InputFiles::AQI, contents.size(), 0) );
+
+      StringFilterSet areasFilter = {"W06000011"};
+      RecordFilter filter(&areasFilter, nullptr, nullptr);
+      std::vector<BethYw::ByteRange> ranges, copyRanges;
+      index.select(filter, ranges);
+      copy.select(filter, copyRanges);
+      REQUIRE( ranges == copyRanges );
+
+    } // THEN
+
+    THEN( "an index that is truncated or not an index is rejected" ) {
+
+      std::stringstream stream;
+      index.write(stream);
+      const std::string written = stream.str();
+
+      REQUIRE_THROWS_AS( BethYw::DatasetIndex::read(written.substr(0, written.size() - 1)),
+                         std::runtime_error );
+      REQUIRE_THROWS_AS( BethYw::DatasetIndex::read("BYWSNAP"),
+                         std::runtime_error );
+      REQUIRE_THROWS_AS( BethYw::DatasetIndex::read(std::string(written.size(), 'x')),
+                         std::runtime_error );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "the CSV files" ) {
+
+    THEN( "importing through the index gives the same data as reading it all" ) {
+
+      for (const BethYw::InputFileSource* source : {&BethYw::InputFiles::AREAS,
+                                                    &BethYw::InputFiles::COMPLETE_POP}) {
+        InputMmapFile input(dir + source->FILE);
+        std::string_view contents = input.open();
+        for (const StringFilterSet& areasFilter : std::vector<StringFilterSet>{
+                 {"W06000024"}, {"W06000001", "W06000024"}, {}}) {
+          for (const StringFilterSet& measuresFilter : std::vector<StringFilterSet>{
+                   {"POP"}, {"area"}, {}}) {
+            auto imports = importBothWays(contents, *source, areasFilter,
+                                          measuresFilter, std::make_tuple(0, 0));
+            REQUIRE( std::get<0>(imports) == std::get<1>(imports) );
+          }
+        }
+      }
+
+    } // THEN
+
+    THEN( "the index of complete-pop skips the header line" ) {
+
+      const BethYw::InputFileSource& source = BethYw::InputFiles::COMPLETE_POP;
+      InputMmapFile input(dir + source.FILE);
+      std::string_view contents = input.open();
+      BethYw::DatasetIndex index = BethYw::DatasetIndex::build(contents, source, 0);
+
+      REQUIRE( index.getHeaderSize() == contents.find('\n') + 1 );
+
+      StringFilterSet areasFilter = {"W06000024"};
+      RecordFilter filter(&areasFilter, nullptr, nullptr);
+      std::vector<BethYw::ByteRange> ranges;
+      REQUIRE( index.select(filter, ranges) );
+      REQUIRE( ranges.size() == 1 );
+      REQUIRE( std::string(contents.substr(ranges[0].first, 9)) == "W06000024" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a dataset file in a directory of its own" ) {
+
+    const BethYw::InputFileSource& source = BethYw::InputFiles::COMPLETE_POP;
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path()
+        / ("bethyw-test26-" + std::to_string(std::rand()));
+    std::filesystem::create_directories(tmp);
+    const std::string path = (tmp / source.FILE).string();
+    std::filesystem::copy_file(dir + source.FILE, path);
+
+    THEN( "the sidecar index is written on first load and reused until the file changes" ) {
+
+      {
+        InputMmapFile input(path);
+        auto index = BethYw::loadDatasetIndex(path, input.open(), source);
+        REQUIRE( index.has_value() );
+        REQUIRE( std::filesystem::exists(path + BethYw::INDEX_SUFFIX) );
+      }
+
+      //a sidecar that does not match the file is replaced
+      {
+        std::ofstream file(path, std::ios::app);
+        file << "\nW06999999,1,2,3,4,5,6,7,8,9,10,11\n";
+      }
+      {
+        InputMmapFile input(path);
+        std::string_view contents = input.open();
+        auto index = BethYw::loadDatasetIndex(path, contents, source);
+        REQUIRE( index.has_value() );
+        REQUIRE( index->getFileSize() == contents.size() );
+
+        std::ifstream sidecar(path + BethYw::INDEX_SUFFIX, std::ios::binary);
+        std::string written((std::istreambuf_iterator<char>(sidecar)),
+                            std::istreambuf_iterator<char>());
+        REQUIRE( BethYw::DatasetIndex::read(written).getFileSize() == contents.size() );
+
+        StringFilterSet areasFilter = {"W06999999"};
+        Areas areas = Areas();
+        areas.populateFromIndex(contents, *index, source.PARSER, source.COLS,
+                                &areasFilter, nullptr, nullptr);
+        REQUIRE( areas.size() == 1 );
+        REQUIRE( areas.getArea("W06999999").getMeasure("pop").size() == 11 );
+      }
+
+    } // THEN
+
+    THEN( "loads writing the sidecars at the same time leave whole files and nothing else" ) {
+
+      InputMmapFile input(path);
+      std::string_view contents = input.open();
+      std::vector<std::thread> loaders;
+      for (int i = 0; i < 4; i++) {
+        loaders.emplace_back([&]() { BethYw::loadDatasetIndex(path, contents, source); });
+      }
+      for (auto& loader : loaders) {
+        loader.join();
+      }
+
+      std::ifstream sidecar(path + BethYw::INDEX_SUFFIX, std::ios::binary);
+      std::string written((std::istreambuf_iterator<char>(sidecar)),
+                          std::istreambuf_iterator<char>());
+      REQUIRE( BethYw::DatasetIndex::read(written).getFileSize() == contents.size() );
+
+      size_t files = 0;
+      for (const auto& entry : std::filesystem::directory_iterator(tmp)) {
+        REQUIRE( entry.path().extension() != ".part" );
+        files++;
+      }
+      REQUIRE( files == 3 );
+
+    } // THEN
+
+    std::filesystem::remove_all(tmp);
+
+  } // GIVEN
+
+} // SCENARIO
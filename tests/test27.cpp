@@ -0,0 +1,211 @@
+
+
+
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../index.h"
+#include "../input.h"
+#include "../stats.h"
+#include "../summary.h"
+#include "../areas.h"
+
+SCENARIO( "a BloomFilter never misses a string that was inserted", "[BloomFilter]" ) {
+
+  GIVEN( "a filter sized for 1000 strings at a 1% false positive rate" ) {
+
+    BethYw::BloomFilter filter(1000, 0.01);
+    for (int i = 0; i < 1000; i++) {
+      filter.insert("W" + std::to_string(i));
+    }
+
+    THEN( "every string inserted may be in it" ) {
+
+      for (int i = 0; i < 1000; i++) {
+        REQUIRE( filter.mayContain("W" + std::to_string(i)) );
+      }
+
+    } // THEN
+
+    THEN( "few strings that were not inserted appear to be" ) {
+
+      int falsePositives = 0;
+      for (int i = 0; i < 10000; i++) {
+        falsePositives += filter.mayContain("X" + std::to_string(i));
+      }
+      REQUIRE( falsePositives < 300 );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "an empty filter" ) {
+
+    BethYw::BloomFilter filter;
+
+    THEN( "it contains nothing" ) {
+
+      REQUIRE_FALSE( filter.mayContain("W06000011") );
+      REQUIRE_FALSE( filter.mayContain("") );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a DatasetSummary tells when a file has nothing for the filters", "[DatasetSummary]" ) {
+
+  const std::string dir = "../datasets/";
+
+  GIVEN( "the summaries of popden and trains" ) {
+
+    InputMmapFile popdenInput(dir + BethYw::InputFiles::POPDEN.FILE);
+    std::string_view popdenContents = popdenInput.open();
+    BethYw::DatasetSummary popden = BethYw::DatasetSummary::build(
+        BethYw::DatasetIndex::build(popdenContents, BethYw::InputFiles::POPDEN, 0));
+
+    InputMmapFile trainsInput(dir + BethYw::InputFiles::TRAINS.FILE);
+    BethYw::DatasetSummary trains = BethYw::DatasetSummary::build(
+        BethYw::DatasetIndex::build(trainsInput.open(), BethYw::InputFiles::TRAINS, 0));
+
+    THEN( "an area only in trains rules out popden but not trains" ) {
+
+      StringFilterSet areasFilter = {"W06000024"};
+
+      REQUIRE_FALSE( popden.mayMatch(&areasFilter, nullptr, nullptr) );
+      REQUIRE( trains.mayMatch(&areasFilter, nullptr, nullptr) );
+
+      areasFilter.insert("W06000011");
+      REQUIRE( popden.mayMatch(&areasFilter, nullptr, nullptr) );
+
+    } // THEN
+
+    THEN( "measures are checked in any case" ) {
+
+      StringFilterSet measuresFilter = {"DENS"};
+
+      REQUIRE( popden.mayMatch(nullptr, &measuresFilter, nullptr) );
+      REQUIRE_FALSE( trains.mayMatch(nullptr, &measuresFilter, nullptr) );
+
+      measuresFilter = {"Rail"};
+      REQUIRE_FALSE( popden.mayMatch(nullptr, &measuresFilter, nullptr) );
+      REQUIRE( trains.mayMatch(nullptr, &measuresFilter, nullptr) );
+
+    } // THEN
+
+    THEN( "years outside the file's range rule it out" ) {
+
+      REQUIRE( popden.getFirstYear() == 1991 );
+      REQUIRE( popden.getLastYear() > 2010 );
+
+      YearFilterTuple before = std::make_tuple(1900, 1990);
+      YearFilterTuple overlapping = std::make_tuple(1900, 1991);
+      YearFilterTuple all = std::make_tuple(0, 0);
+
+      REQUIRE_FALSE( popden.mayMatch(nullptr, nullptr, &before) );
+      REQUIRE( popden.mayMatch(nullptr, nullptr, &overlapping) );
+      REQUIRE( popden.mayMatch(nullptr, nullptr, &all) );
+
+    } // THEN
+
+    THEN( "no filters match anything" ) {
+
+      StringFilterSet none;
+      REQUIRE( popden.mayMatch(&none, &none, nullptr) );
+      REQUIRE( popden.mayMatch(nullptr, nullptr, nullptr) );
+
+    } // THEN
+
+    THEN( "a summary can be written and read back" ) {
+
+      std::stringstream stream;
+      popden.write(stream);
+      const std::string written = stream.str();
+      BethYw::DatasetSummary copy = BethYw::DatasetSummary::read(written);
+
+      REQUIRE( copy.isFor(BethYw::InputFiles::POPDEN, popdenContents.size(), 0) );
+      REQUIRE_FALSE( copy.isFor(BethYw::InputFiles::TRAINS, popdenContents.size(), 0) );
+      REQUIRE_FALSE( copy.isFor(BethYw::InputFiles::POPDEN, popdenContents.size() + 1, 0) );
+
+      StringFilterSet areasFilter = {"W06000024"};
+      REQUIRE_FALSE( copy.mayMatch(&areasFilter, nullptr, nullptr) );
+      areasFilter = {"W06000011"};
+      REQUIRE( copy.mayMatch(&areasFilter, nullptr, nullptr) );
+
+      REQUIRE_THROWS_AS( BethYw::DatasetSummary::read(written.substr(0, written.size() - 8)),
+                         std::runtime_error );
+      REQUIRE_THROWS_AS( BethYw::DatasetSummary::read("BYWINDEX"),
+                         std::runtime_error );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a copy of the datasets directory" ) {
+
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path()
+        / ("bethyw-test27-" + std::to_string(std::rand()));
+    std::filesystem::create_directories(tmp);
+    std::filesystem::copy(dir, tmp);
+    const std::string copy = tmp.string() + "/";
+
+    THEN( "loadDatasets skips the files the summaries rule out, once they are built" ) {
+
+      StringFilterSet areasFilter = {"W06000024"};
+      const std::vector<BethYw::InputFileSource> datasets = {
+          BethYw::InputFiles::POPDEN, BethYw::InputFiles::TRAINS};
+
+      Areas expected = Areas();
+      BethYw::loadDatasets(expected, copy, datasets, areasFilter, {},
+                           std::make_tuple(0, 0));
+
+      REQUIRE_FALSE( BethYw::loadDatasetSummary(copy + BethYw::InputFiles::POPDEN.FILE,
+                                                BethYw::InputFiles::POPDEN).has_value() );
+
+      for (int run = 0; run < 2; run++) {
+        for (unsigned int threads : {1u, 2u}) {
+          Areas areas = Areas();
+          BethYw::RunStats stats;
+          BethYw::loadDatasets(areas, copy, datasets, areasFilter, {},
+                               std::make_tuple(0, 0), threads, &stats, true);
+
+          REQUIRE( areas.toJSON() == expected.toJSON() );
+          REQUIRE( stats.imports.size() == 2 );
+          REQUIRE( stats.imports[0].name == "popden" );
+          REQUIRE( stats.imports[1].bytesRead > 0 );
+          if (run > 0) {
+            REQUIRE( stats.imports[0].bytesRead == 0 );
+            REQUIRE( stats.imports[0].parseMs == 0 );
+          }
+        }
+      }
+
+      REQUIRE( BethYw::loadDatasetSummary(copy + BethYw::InputFiles::POPDEN.FILE,
+                                          BethYw::InputFiles::POPDEN).has_value() );
+
+    } // THEN
+
+    std::filesystem::remove_all(tmp);
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,210 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <atomic>
+#include <future>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../datasets.h"
+#include "../generate.h"
+#include "../scheduler.h"
+#include "../areas.h"
+
+SCENARIO( "a TaskScheduler runs every task in a TaskGroup", "[TaskScheduler]" ) {
+
+  GIVEN( "a scheduler with four worker threads" ) {
+
+    BethYw::TaskScheduler scheduler(4);
+
+    REQUIRE( scheduler.getThreads() == 4 );
+    REQUIRE_FALSE( scheduler.isWorkerThread() );
+
+    THEN( "a thousand tasks all run before wait() returns" ) {
+
+      std::atomic<int> sum(0);
+      BethYw::TaskGroup group(scheduler);
+      for (int i = 1; i <= 1000; i++) {
+        group.run([&sum, i]() { sum += i; });
+      }
+      group.wait();
+
+      REQUIRE( sum == 500500 );
+
+    } // THEN
+
+    THEN( "tasks run on the worker threads" ) {
+
+      std::atomic<bool> onWorker(true);
+      BethYw::TaskGroup group(scheduler);
+      for (int i = 0; i < 100; i++) {
+        group.run([&]() {
+          if (!scheduler.isWorkerThread()) {
+            onWorker = false;
+          }
+        });
+      }
+      group.wait();
+
+      REQUIRE( onWorker );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a scheduler with a single worker thread" ) {
+
+    BethYw::TaskScheduler scheduler(1);
+
+    THEN( "tasks can wait for tasks they submit without deadlocking" ) {
+
+      std::vector<int> totals(10, 0);
+      BethYw::TaskGroup outer(scheduler);
+      for (int i = 0; i < 10; i++) {
+        outer.run([&, i]() {
+          std::vector<int> parts(10, 0);
+          BethYw::TaskGroup inner(scheduler);
+          for (int j = 0; j < 10; j++) {
+            inner.run([&, j]() { parts[j] = i * 10 + j; });
+          }
+          inner.wait();
+          for (int part : parts) {
+            totals[i] += part;
+          }
+        });
+      }
+      outer.wait();
+
+      for (int i = 0; i < 10; i++) {
+        REQUIRE( totals[i] == i * 100 + 45 );
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a TaskGroup can be cancelled", "[TaskScheduler]" ) {
+
+  GIVEN( "a scheduler with a single worker thread, which runs tasks in the order submitted" ) {
+
+    BethYw::TaskScheduler scheduler(1);
+    std::atomic<int> ran(0);
+
+    THEN( "an exception from a task is rethrown by wait() and the tasks not started are skipped" ) {
+
+      BethYw::TaskGroup group(scheduler);
+      group.run([]() { throw std::runtime_error("Failed"); });
+      for (int i = 0; i < 100; i++) {
+        group.run([&]() { ran++; });
+      }
+
+      REQUIRE_THROWS_AS( group.wait(), std::runtime_error );
+      REQUIRE( group.isCancelled() );
+      REQUIRE( ran == 0 );
+
+    } // THEN
+
+    THEN( "cancel() skips the tasks that have not started" ) {
+
+      std::promise<void> start, release;
+      std::future<void> started = start.get_future();
+      std::shared_future<void> released = release.get_future().share();
+
+      BethYw::TaskGroup group(scheduler);
+      group.run([&]() {
+        start.set_value();
+        released.wait();
+        ran++;
+      });
+      for (int i = 0; i < 100; i++) {
+        group.run([&]() { ran++; });
+      }
+      started.wait();
+      group.cancel();
+      release.set_value();
+      group.wait();
+
+      REQUIRE( ran == 1 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a TaskScheduler::Scope installs the global scheduler", "[TaskScheduler]" ) {
+
+  GIVEN( "a scheduler with two worker threads" ) {
+
+    BethYw::TaskScheduler scheduler(2);
+    BethYw::TaskScheduler* before = &BethYw::TaskScheduler::global();
+
+    THEN( "it is the global scheduler until the Scope is destroyed" ) {
+
+      {
+        BethYw::TaskScheduler::Scope scope(scheduler);
+        REQUIRE( &BethYw::TaskScheduler::global() == &scheduler );
+      }
+      REQUIRE( &BethYw::TaskScheduler::global() == before );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "large outputs formatted in blocks are the same as formatted on one thread", "[TaskScheduler]" ) {
+
+  GIVEN( "an Areas instance with a thousand areas" ) {
+
+    BethYw::GeneratorSettings settings;
+    settings.areas = 1000;
+    settings.firstYear = 2010;
+    settings.lastYear = 2012;
+    std::ostringstream generated;
+    BethYw::DatasetGenerator(BethYw::InputFiles::POPDEN, settings).write(generated);
+
+    Areas areas = Areas();
+    areas.populate(generated.str(),
+                   BethYw::WelshStatsJSON,
+                   BethYw::InputFiles::POPDEN.COLS,
+                   nullptr, nullptr, nullptr);
+    REQUIRE( areas.size() == 1000 );
+
+    THEN( "the JSON is the same" ) {
+
+      std::ostringstream single, blocks;
+      areas.writeJSON(single);
+      areas.writeJSON(blocks, 4);
+
+      REQUIRE( blocks.str() == single.str() );
+
+    } // THEN
+
+    THEN( "the tables are the same" ) {
+
+      std::ostringstream single, blocks;
+      single << areas;
+      areas.writeTables(blocks, 4);
+
+      REQUIRE( blocks.str() == single.str() );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,124 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../areaparts.h"
+#include "../intern.h"
+#include "../scheduler.h"
+#include "../areas.h"
+
+SCENARIO( "an AreaParts merges the parts handed over from many threads in chunk order", "[AreaParts]" ) {
+
+  GIVEN( "forty parts, each giving every one of a hundred areas a value for its own year and a shared year" ) {
+
+    std::vector<Areas> parts(40);
+    for (size_t i = 0; i < parts.size(); i++) {
+      for (int a = 0; a < 100; a++) {
+        Area area("W" + std::to_string(80000000 + a));
+        Measure measure("pop", "Population");
+        measure.setValue(2000 + static_cast<int>(i), i);
+        measure.setValue(1999, i);
+        area.setMeasure("pop", measure);
+        area.setName("eng", "Part " + std::to_string(i));
+        parts[i].setArea(area.getLocalAuthorityCode(), area);
+      }
+    }
+
+    Areas expected = Areas();
+    for (const Areas& part : parts) {
+      Areas copy = part;
+      expected.merge(std::move(copy));
+    }
+
+    WHEN( "the parts are added by tasks in any order and moved into an Areas instance" ) {
+
+      BethYw::TaskScheduler scheduler(4);
+      AreaParts combined(7);
+      BethYw::TaskGroup group(scheduler);
+      for (size_t i = parts.size(); i-- > 0;) {
+        group.run([&, i]() { combined.merge(std::move(parts[i]), i); });
+      }
+      group.wait();
+
+      REQUIRE( combined.size() == 100 );
+      REQUIRE( parts[0].size() == 0 );
+
+      Areas result = Areas();
+      {
+        BethYw::TaskScheduler::Scope scope(scheduler);
+        combined.moveInto(result, 4);
+      }
+
+      THEN( "the result is the same as merging the parts one after another" ) {
+
+        REQUIRE( result.size() == 100 );
+        REQUIRE( result.toJSON() == expected.toJSON() );
+
+      } // THEN
+
+      THEN( "the last part's value and name win" ) {
+
+        const Area& area = result.getArea("W80000042");
+        REQUIRE( area.getMeasure("pop").getValue(1999) == 39 );
+        REQUIRE( area.getMeasure("pop").getValue(2000) == 0 );
+        REQUIRE( area.getName("eng") == "Part 39" );
+
+      } // THEN
+
+      THEN( "the AreaParts is left empty" ) {
+
+        REQUIRE( combined.size() == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+  GIVEN( "an Areas instance that already has an area" ) {
+
+    Areas areas = Areas();
+    Area existing("W80000001");
+    existing.setName("cym", "Hen");
+    areas.setArea("W80000001", existing);
+
+    THEN( "areas added with setArea() are combined with it" ) {
+
+      AreaParts combined;
+      Area later("W80000001");
+      later.setName("eng", "New");
+      combined.setArea(later.getLocalAuthorityCodeId(), later, 0);
+      combined.moveInto(areas);
+
+      REQUIRE( areas.size() == 1 );
+      REQUIRE( areas.getArea("W80000001").getName("cym") == "Hen" );
+      REQUIRE( areas.getArea("W80000001").getName("eng") == "New" );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "no shards" ) {
+
+    THEN( "a AreaParts cannot be constructed" ) {
+
+      REQUIRE_THROWS_AS( AreaParts(0), std::invalid_argument );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,204 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../datasets.h"
+#include "../generate.h"
+#include "../pipeline.h"
+#include "../scheduler.h"
+#include "../stats.h"
+#include "../areas.h"
+
+SCENARIO( "a BoundedQueue holds a limited number of items in order", "[Pipeline]" ) {
+
+  GIVEN( "a queue with room for two items" ) {
+
+    BethYw::BoundedQueue<int> queue(2);
+    int item = 1;
+
+    THEN( "a third item is refused until one is popped" ) {
+
+      REQUIRE( queue.tryPush(item) );
+      item = 2;
+      REQUIRE( queue.tryPush(item) );
+      REQUIRE( queue.full() );
+      item = 3;
+      REQUIRE_FALSE( queue.tryPush(item) );
+
+      int popped = 0;
+      REQUIRE( queue.tryPop(popped) );
+      REQUIRE( popped == 1 );
+      REQUIRE( queue.tryPush(item) );
+      REQUIRE( queue.tryPop(popped) );
+      REQUIRE( popped == 2 );
+      REQUIRE( queue.tryPop(popped) );
+      REQUIRE( popped == 3 );
+      REQUIRE_FALSE( queue.tryPop(popped) );
+
+    } // THEN
+
+    THEN( "it is only drained once it is closed and empty" ) {
+
+      REQUIRE( queue.tryPush(item) );
+      queue.close();
+      REQUIRE_FALSE( queue.isDrained() );
+
+      int popped = 0;
+      REQUIRE( queue.tryPop(popped) );
+      REQUIRE( queue.isDrained() );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "no room at all" ) {
+
+    THEN( "a queue cannot be constructed" ) {
+
+      REQUIRE_THROWS_AS( BethYw::BoundedQueue<int>(0), std::invalid_argument );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "PipelineStages pass items through small queues in order", "[Pipeline]" ) {
+
+  for (unsigned int threads : {1u, 4u}) {
+
+    GIVEN( "a source, a doubling stage and a sink, on " + std::to_string(threads) + " threads" ) {
+
+      BethYw::TaskScheduler scheduler(threads);
+      BethYw::BoundedQueue<int> numbers(2);
+      BethYw::BoundedQueue<int> doubled(2);
+      std::vector<int> results;
+      int next = 0;
+
+      std::unique_ptr<BethYw::PipelineStage> source, twice, sink;
+      BethYw::TaskGroup group(scheduler);
+      source = std::make_unique<BethYw::PipelineStage>(group, [&]() {
+        while (next < 1000 && numbers.tryPush(next)) {
+          next++;
+          twice->wake();
+        }
+        if (next == 1000) {
+          numbers.close();
+          twice->wake();
+        }
+      });
+      twice = std::make_unique<BethYw::PipelineStage>(group, [&]() {
+        int number = 0;
+        while (!doubled.full() && numbers.tryPop(number)) {
+          source->wake();
+          number *= 2;
+          doubled.tryPush(number);
+          sink->wake();
+        }
+        if (numbers.isDrained()) {
+          doubled.close();
+          sink->wake();
+        }
+      });
+      sink = std::make_unique<BethYw::PipelineStage>(group, [&]() {
+        int number = 0;
+        while (doubled.tryPop(number)) {
+          twice->wake();
+          results.push_back(number);
+        }
+      });
+
+      source->wake();
+      group.wait();
+
+      THEN( "every item reaches the sink, in order" ) {
+
+        REQUIRE( doubled.isDrained() );
+        REQUIRE( results.size() == 1000 );
+        for (int i = 0; i < 1000; i++) {
+          REQUIRE( results[i] == i * 2 );
+        }
+
+      } // THEN
+
+    } // GIVEN
+
+  }
+
+} // SCENARIO
+
+SCENARIO( "a StatsWales JSON file imported through the pipeline is the same as one parsed in one go", "[Pipeline]" ) {
+
+  GIVEN( "a generated file of a few blocks, with duplicate rows" ) {
+
+    BethYw::GeneratorSettings settings;
+    settings.areas = 200;
+    settings.duplicates = 0.1;
+    std::ostringstream generated;
+    BethYw::DatasetGenerator(BethYw::InputFiles::POPDEN, settings).write(generated);
+    const std::string buffer = generated.str();
+    REQUIRE( buffer.size() > 2 * 1024 * 1024 );
+    REQUIRE( buffer.size() < 8 * 1024 * 1024 );
+
+    BethYw::TaskScheduler scheduler(4);
+    BethYw::TaskScheduler::Scope scope(scheduler);
+
+    THEN( "the areas and the counts of rows are the same" ) {
+
+      Areas single = Areas();
+      BethYw::ImportStats singleStats;
+      single.populateFromWelshStatsJSON(buffer, BethYw::InputFiles::POPDEN.COLS,
+          nullptr, nullptr, nullptr, 1, &singleStats);
+
+      Areas staged = Areas();
+      BethYw::ImportStats stagedStats;
+      staged.populateFromWelshStatsJSON(buffer, BethYw::InputFiles::POPDEN.COLS,
+          nullptr, nullptr, nullptr, 4, &stagedStats);
+
+      REQUIRE( staged.toJSON() == single.toJSON() );
+      REQUIRE( stagedStats.recordsParsed == singleStats.recordsParsed );
+      REQUIRE( stagedStats.recordsMerged == singleStats.recordsMerged );
+
+    } // THEN
+
+    THEN( "the filters are applied in the same way" ) {
+
+      StringFilterSet areasFilter = {BethYw::DatasetGenerator::areaCode(7),
+                                     BethYw::DatasetGenerator::areaCode(150)};
+      StringFilterSet measuresFilter = {"POPDEN-M2"};
+      YearFilterTuple yearsFilter = std::make_tuple(2000, 2010);
+
+      Areas single = Areas();
+      BethYw::ImportStats singleStats;
+      single.populateFromWelshStatsJSON(buffer, BethYw::InputFiles::POPDEN.COLS,
+          &areasFilter, &measuresFilter, &yearsFilter, 1, &singleStats);
+
+      Areas staged = Areas();
+      BethYw::ImportStats stagedStats;
+      staged.populateFromWelshStatsJSON(buffer, BethYw::InputFiles::POPDEN.COLS,
+          &areasFilter, &measuresFilter, &yearsFilter, 4, &stagedStats);
+
+      REQUIRE( staged.size() == 2 );
+      REQUIRE( staged.toJSON() == single.toJSON() );
+      REQUIRE( stagedStats.recordsFiltered == singleStats.recordsFiltered );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,160 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <climits>
+#include <string>
+#include <tuple>
+
+#include "../filter.h"
+#include "../intern.h"
+#include "../areas.h"
+
+SCENARIO( "a RecordFilter matches interned IDs against the filters", "[RecordFilter]" ) {
+
+  InternTable& strings = InternTable::global();
+
+  GIVEN( "no filters" ) {
+
+    RecordFilter filter(nullptr, nullptr, nullptr);
+
+    THEN( "every ID and year is kept" ) {
+
+      REQUIRE( filter.keepArea(strings.intern("W06000011")) );
+      REQUIRE( filter.keepMeasure(strings.internLower("pop")) );
+      REQUIRE( filter.keepArea(InternId(UINT_MAX)) );
+      REQUIRE( filter.keepYear(INT_MIN) );
+      REQUIRE( filter.keepYear(-1) );
+      REQUIRE( filter.keepYear(INT_MAX) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "filters for an area, a measure and a range of years" ) {
+
+    StringFilterSet areasFilter = {"W06000011"};
+    StringFilterSet measuresFilter = {"Pop"};
+    YearFilterTuple yearsFilter = std::make_tuple(2010, 2012);
+    RecordFilter filter(&areasFilter, &measuresFilter, &yearsFilter);
+
+    THEN( "only the ID of the area is kept" ) {
+
+      REQUIRE( filter.keepArea(strings.intern("W06000011")) );
+      REQUIRE_FALSE( filter.keepArea(strings.intern("W06000012")) );
+      REQUIRE_FALSE( filter.keepArea(strings.intern("w06000011")) );
+      REQUIRE_FALSE( filter.keepArea(InternId(UINT_MAX)) );
+
+    } // THEN
+
+    THEN( "only the ID of the lowercase measure codename is kept" ) {
+
+      REQUIRE( filter.keepMeasure(strings.internLower("POP")) );
+      REQUIRE_FALSE( filter.keepMeasure(strings.internLower("dens")) );
+
+    } // THEN
+
+    THEN( "the ID and text checks agree" ) {
+
+      REQUIRE( filter.keepArea(strings.intern("W06000011")) == filter.keepArea("W06000011") );
+      REQUIRE( filter.keepMeasure(strings.internLower("pop")) == filter.keepMeasure("PoP") );
+
+    } // THEN
+
+    THEN( "only the years in the range are kept" ) {
+
+      REQUIRE_FALSE( filter.keepYear(2009) );
+      REQUIRE( filter.keepYear(2010) );
+      REQUIRE( filter.keepYear(2012) );
+      REQUIRE_FALSE( filter.keepYear(2013) );
+      REQUIRE_FALSE( filter.keepYear(-2011) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "filters for codes that are not in the table yet" ) {
+
+    const size_t size = strings.size();
+    StringFilterSet areasFilter = {"W99000031-unseen"};
+    StringFilterSet measuresFilter = {"Unseen-Measure"};
+    RecordFilter filter(&areasFilter, &measuresFilter, nullptr);
+
+    THEN( "building the filter does not add them" ) {
+
+      REQUIRE( strings.size() == size );
+
+    } // THEN
+
+    THEN( "their IDs are kept once they are added" ) {
+
+      REQUIRE( filter.keepArea(strings.intern("W99000031-unseen")) );
+      REQUIRE( filter.keepMeasure(strings.internLower("UNSEEN-measure")) );
+      REQUIRE_FALSE( filter.keepArea(strings.intern("W99000032-unseen")) );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a range of years the wrong way round" ) {
+
+    YearFilterTuple yearsFilter = std::make_tuple(2012, 2010);
+    RecordFilter filter(nullptr, nullptr, &yearsFilter);
+
+    THEN( "no year is kept" ) {
+
+      REQUIRE_FALSE( filter.keepYear(2010) );
+      REQUIRE_FALSE( filter.keepYear(2011) );
+      REQUIRE_FALSE( filter.keepYear(2012) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "Areas are copied through a filter by ID", "[RecordFilter]" ) {
+
+  GIVEN( "two areas with two measures each" ) {
+
+    Areas data = Areas();
+    for (std::string code : {"W06000011", "W06000012"}) {
+      Area area(code);
+      Measure pop("pop", "Population");
+      pop.setValue(2010, 1);
+      pop.setValue(2011, 2);
+      Measure dens("dens", "Density");
+      dens.setValue(2010, 3);
+      area.setMeasure("pop", pop);
+      area.setMeasure("dens", dens);
+      data.setArea(code, area);
+    }
+
+    THEN( "only the values that pass the filter are copied" ) {
+
+      StringFilterSet areasFilter = {"W06000012"};
+      StringFilterSet measuresFilter = {"POP"};
+      YearFilterTuple yearsFilter = std::make_tuple(2011, 2011);
+      Areas copy = Areas();
+      copy.merge(data, RecordFilter(&areasFilter, &measuresFilter, &yearsFilter));
+
+      REQUIRE( copy.size() == 1 );
+      const Area& area = copy.getArea("W06000012");
+      REQUIRE( area.size() == 1 );
+      REQUIRE( area.getMeasure("pop").size() == 1 );
+      REQUIRE( area.getMeasure("pop").getValue(2011) == 2 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
@@ -0,0 +1,217 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <string>
+#include <tuple>
+
+#include "../datasets.h"
+#include "../filter.h"
+#include "../index.h"
+#include "../input.h"
+#include "../intern.h"
+#include "../summary.h"
+#include "../areas.h"
+
+SCENARIO( "a PatternMatcher matches codes against codes and glob patterns", "[PatternMatcher]" ) {
+
+  GIVEN( "a matcher with nothing in it" ) {
+
+    PatternMatcher matcher;
+
+    THEN( "it is empty and matches nothing" ) {
+
+      REQUIRE( matcher.empty() );
+      REQUIRE_FALSE( matcher.matches("W06000011") );
+      REQUIRE_FALSE( matcher.matches("") );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a matcher with a code, a prefix and a glob" ) {
+
+    PatternMatcher matcher;
+    matcher.insert("W06000011");
+    matcher.insert("W07*");
+    matcher.insert("E0?00*1");
+
+    THEN( "the code is only matched exactly" ) {
+
+      REQUIRE( matcher.matches("W06000011") );
+      REQUIRE_FALSE( matcher.matches("W0600001") );
+      REQUIRE_FALSE( matcher.matches("W060000111") );
+      REQUIRE_FALSE( matcher.matches("w06000011") );
+
+    } // THEN
+
+    THEN( "the prefix matches any code starting with it" ) {
+
+      REQUIRE( matcher.matches("W07") );
+      REQUIRE( matcher.matches("W07000041") );
+      REQUIRE_FALSE( matcher.matches("W0") );
+
+    } // THEN
+
+    THEN( "the glob's wildcards match any one and any run of characters" ) {
+
+      REQUIRE( matcher.matches("E0100001") );
+      REQUIRE( matcher.matches("E0900121") );
+      REQUIRE( matcher.matches("E02001") );
+      REQUIRE_FALSE( matcher.matches("E001") );
+      REQUIRE_FALSE( matcher.matches("E0100002") );
+
+    } // THEN
+
+    THEN( "it knows it holds patterns but does not match everything" ) {
+
+      REQUIRE( matcher.hasPatterns() );
+      REQUIRE_FALSE( matcher.matchesAll() );
+      REQUIRE( PatternMatcher::isPattern("W07*") );
+      REQUIRE( PatternMatcher::isPattern("W0?") );
+      REQUIRE_FALSE( PatternMatcher::isPattern("W06000011") );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a matcher that ignores case" ) {
+
+    PatternMatcher matcher(true);
+    matcher.insert("PM*");
+    matcher.insert("pop");
+
+    THEN( "codes in any case are matched" ) {
+
+      REQUIRE( matcher.matches("pm10") );
+      REQUIRE( matcher.matches("Pm2-5") );
+      REQUIRE( matcher.matches("POP") );
+      REQUIRE_FALSE( matcher.matches("popden") );
+      REQUIRE( matcher.hasPatterns() );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "a matcher with a lone *" ) {
+
+    PatternMatcher matcher;
+    matcher.insert("*");
+
+    THEN( "it matches everything" ) {
+
+      REQUIRE( matcher.matchesAll() );
+      REQUIRE( matcher.matches("") );
+      REQUIRE( matcher.matches("anything") );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a RecordFilter matches codes and their IDs against patterns", "[RecordFilter][PatternMatcher]" ) {
+
+  InternTable& strings = InternTable::global();
+  InternId before = strings.intern("W06000031");
+
+  StringFilterSet areasFilter = {"W06*", "W07000041"};
+  StringFilterSet measuresFilter = {"PM*"};
+  RecordFilter filter(&areasFilter, &measuresFilter, nullptr);
+
+  THEN( "codes in the raw text are matched" ) {
+
+    REQUIRE( filter.keepArea("W06000031") );
+    REQUIRE( filter.keepArea("W07000041") );
+    REQUIRE_FALSE( filter.keepArea("W07000042") );
+    REQUIRE( filter.keepMeasure("pm10") );
+    REQUIRE_FALSE( filter.keepMeasure("pop") );
+
+  } // THEN
+
+  THEN( "IDs interned before and after the filter was built are matched" ) {
+
+    REQUIRE( filter.keepArea(before) );
+    REQUIRE( filter.keepArea(strings.intern("W06000032-after")) );
+    REQUIRE_FALSE( filter.keepArea(strings.intern("W08000032-after")) );
+    REQUIRE( filter.keepMeasure(strings.internLower("PM99-after")) );
+    REQUIRE_FALSE( filter.keepMeasure(strings.internLower("pop")) );
+    REQUIRE_FALSE( filter.keepArea(InternId(-1)) );
+
+  } // THEN
+
+  THEN( "a lone * keeps everything" ) {
+
+    StringFilterSet everything = {"*"};
+    RecordFilter all(&everything, &everything, nullptr);
+
+    REQUIRE( all.keepArea("E01") );
+    REQUIRE( all.keepMeasure(InternId(-1)) );
+
+  } // THEN
+
+} // SCENARIO
+
+SCENARIO( "patterns select the same records as the codes they match", "[PatternMatcher][popu1009]" ) {
+
+  const std::string dir = "../datasets/";
+  auto source = BethYw::InputFiles::POPDEN;
+  InputMmapFile input(dir + source.FILE);
+  std::string_view contents = input.open();
+
+  GIVEN( "popu1009.json parsed with a pattern and with the codes it matches" ) {
+
+    StringFilterSet patterns = {"W0600001?"};
+    StringFilterSet codes;
+    for (int i = 10; i <= 19; i++) {
+      codes.insert("W060000" + std::to_string(i));
+    }
+    StringFilterSet measuresFilter = {"pop*"};
+    StringFilterSet measuresCodes = {"pop", "popden"};
+
+    Areas byPattern = Areas();
+    byPattern.populate(contents, source.PARSER, source.COLS,
+                       &patterns, &measuresFilter, nullptr);
+
+    Areas byCode = Areas();
+    byCode.populate(contents, source.PARSER, source.COLS,
+                    &codes, &measuresCodes, nullptr);
+
+    THEN( "the same areas and values are imported" ) {
+
+      REQUIRE( byPattern.size() > 0 );
+      REQUIRE( byPattern.toJSON() == byCode.toJSON() );
+
+    } // THEN
+
+  } // GIVEN
+
+  GIVEN( "the summary of popu1009.json" ) {
+
+    BethYw::DatasetSummary summary = BethYw::DatasetSummary::build(
+        BethYw::DatasetIndex::build(contents, source, 0));
+
+    THEN( "a pattern may always match" ) {
+
+      StringFilterSet areasFilter = {"X99*"};
+      StringFilterSet measuresFilter = {"nothing?"};
+
+      REQUIRE( summary.mayMatch(&areasFilter, &measuresFilter, nullptr) );
+
+      areasFilter = {"X99000000"};
+      REQUIRE_FALSE( summary.mayMatch(&areasFilter, nullptr, nullptr) );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
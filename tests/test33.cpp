@@ -0,0 +1,210 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../analytics.h"
+#include "../datasets.h"
+#include "../input.h"
+#include "../areas.h"
+
+SCENARIO( "values are added up without losing precision", "[SeriesBatch]" ) {
+
+  GIVEN( "large values that cancel out around a small one" ) {
+
+    std::vector<double> values = {1e16, 1, -1e16, 1, 1};
+
+    THEN( "the small values are not lost" ) {
+
+      REQUIRE( stableSum(values.data(), values.size()) == 3 );
+      REQUIRE( stableSum(values.data(), 3) == 1 );
+      REQUIRE( stableSum(values.data(), 0) == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a SeriesBatch calculates statistics for every series at once", "[SeriesBatch]" ) {
+
+  GIVEN( "three series with gaps, and one with no readings" ) {
+
+    SeriesBatch batch({{0, 0}, {0, 1}, {1, 0}, {1, 1}}, 2010, 2014);
+    //10, _, 30, _, 50
+    batch.setValue(0, 2010, 10);
+    batch.setValue(0, 2012, 30);
+    batch.setValue(0, 2014, 50);
+    //_, 100, 121, _, _
+    batch.setValue(1, 2011, 100);
+    batch.setValue(1, 2012, 121);
+    //-4, -4, -4, -4, 8
+    for (int year = 2010; year <= 2013; year++) {
+      batch.setValue(2, year, -4);
+    }
+    batch.setValue(2, 2014, 8);
+
+    THEN( "the readings can be read back" ) {
+
+      REQUIRE( batch.size() == 4 );
+      REQUIRE( batch.getFirstYear() == 2010 );
+      REQUIRE( batch.getLastYear() == 2014 );
+      REQUIRE( batch.getValue(1, 2012) == 121 );
+      REQUIRE_FALSE( batch.hasValue(0, 2011) );
+      REQUIRE_FALSE( batch.hasValue(0, 2015) );
+      REQUIRE_THROWS_AS( batch.getValue(0, 2011), std::out_of_range );
+      REQUIRE_THROWS_AS( batch.setValue(4, 2010, 1), std::out_of_range );
+      REQUIRE_THROWS_AS( batch.setValue(0, 2009, 1), std::out_of_range );
+
+    } // THEN
+
+    WHEN( "the batch is summarised" ) {
+
+      SeriesSummary summary = batch.summarise();
+      REQUIRE( summary.size() == 4 );
+
+      THEN( "the counts, means and extremes are those of the readings" ) {
+
+        REQUIRE( summary.counts == std::vector<size_t>{3, 2, 5, 0} );
+        REQUIRE( summary.means == std::vector<double>{30, 110.5, -1.6, 0} );
+        REQUIRE( summary.minimums == std::vector<double>{10, 100, -4, 0} );
+        REQUIRE( summary.maximums == std::vector<double>{50, 121, 8, 0} );
+
+      } // THEN
+
+      THEN( "the standard deviations are those of the readings" ) {
+
+        REQUIRE( summary.deviations[0] == Approx(std::sqrt(800.0 / 3)) );
+        REQUIRE( summary.deviations[1] == Approx(10.5) );
+        REQUIRE( summary.deviations[2] == Approx(4.8) );
+        REQUIRE( summary.deviations[3] == 0 );
+
+      } // THEN
+
+      THEN( "the changes are from the first to the last reading" ) {
+
+        REQUIRE( summary.firsts == std::vector<double>{10, 100, -4, 0} );
+        REQUIRE( summary.lasts == std::vector<double>{50, 121, 8, 0} );
+        REQUIRE( summary.differences == std::vector<double>{40, 21, 12, 0} );
+        REQUIRE( summary.percentages[0] == 400 );
+        REQUIRE( summary.percentages[1] == Approx(21) );
+        REQUIRE( summary.percentages[2] == -300 );
+        REQUIRE( summary.percentages[3] == 0 );
+
+      } // THEN
+
+      THEN( "the compound annual growth rate is over the years between them" ) {
+
+        REQUIRE( summary.growthRates[0] == Approx(std::pow(5.0, 0.25) - 1) );
+        REQUIRE( summary.growthRates[1] == Approx(0.21) );
+        //not defined from a negative reading
+        REQUIRE( summary.growthRates[2] == 0 );
+        REQUIRE( summary.growthRates[3] == 0 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the year-over-year growth is calculated" ) {
+
+      SeriesBatch growth = batch.growth();
+
+      THEN( "there is a reading only where both years have one" ) {
+
+        REQUIRE( growth.size() == 4 );
+        REQUIRE_FALSE( growth.hasValue(0, 2010) );
+        REQUIRE_FALSE( growth.hasValue(0, 2012) );
+        REQUIRE( growth.getValue(1, 2012) == Approx(21) );
+        REQUIRE_FALSE( growth.hasValue(1, 2013) );
+        REQUIRE( growth.getValue(2, 2011) == 0 );
+        REQUIRE( growth.getValue(2, 2014) == -300 );
+
+      } // THEN
+
+    } // WHEN
+
+    WHEN( "the rolling mean over two years is calculated" ) {
+
+      SeriesBatch rolling = batch.rollingMean(2);
+
+      THEN( "each year is the mean of the readings in its window" ) {
+
+        REQUIRE( rolling.getValue(0, 2010) == 10 );
+        REQUIRE( rolling.getValue(0, 2011) == 10 );
+        REQUIRE( rolling.getValue(0, 2012) == 30 );
+        REQUIRE( rolling.getValue(1, 2012) == 110.5 );
+        REQUIRE( rolling.getValue(1, 2013) == 121 );
+        REQUIRE_FALSE( rolling.hasValue(1, 2014) );
+        REQUIRE( rolling.getValue(2, 2014) == 2 );
+        REQUIRE_FALSE( rolling.hasValue(3, 2012) );
+
+      } // THEN
+
+      THEN( "a window of no years is refused" ) {
+
+        REQUIRE_THROWS_AS( batch.rollingMean(0), std::invalid_argument );
+
+      } // THEN
+
+    } // WHEN
+
+  } // GIVEN
+
+} // SCENARIO
+
+SCENARIO( "a SeriesBatch built from Areas agrees with each Measure", "[SeriesBatch][popu1009]" ) {
+
+  GIVEN( "popu1009.json imported into an Areas instance" ) {
+
+    InputMmapFile input("../datasets/popu1009.json");
+    Areas areas = Areas();
+    areas.populate(input.open(), BethYw::WelshStatsJSON, BethYw::InputFiles::POPDEN.COLS,
+                   nullptr, nullptr, nullptr);
+
+    SeriesBatch batch = areas.toSeriesBatch();
+    SeriesSummary summary = batch.summarise();
+
+    THEN( "there is a series for every measure of every area" ) {
+
+      size_t series = 0;
+      for (const auto& area : areas.getAreas()) {
+        series += area.second.size();
+      }
+      REQUIRE( series > 0 );
+      REQUIRE( batch.size() == series );
+
+    } // THEN
+
+    THEN( "the statistics match those of each Measure" ) {
+
+      size_t i = 0;
+      for (const auto& area : areas.getAreas()) {
+        for (const auto& measure : area.second.getMeasuresById()) {
+          REQUIRE( batch.getKeys()[i].area == area.first );
+          REQUIRE( batch.getKeys()[i].measure == measure.first );
+          REQUIRE( summary.counts[i] == static_cast<size_t>(measure.second.size()) );
+          REQUIRE( summary.means[i] == Approx(measure.second.getAverage()) );
+          REQUIRE( summary.differences[i] == measure.second.getDifference() );
+          REQUIRE( summary.percentages[i] == Approx(measure.second.getDifferenceAsPercentage()) );
+          i++;
+        }
+      }
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO
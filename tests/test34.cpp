@@ -0,0 +1,68 @@
+/*
+  +---------------------------------------+
+  | BETH YW? WELSH GOVERNMENT DATA PARSER |
+  +---------------------------------------+
+
+  AUTHOR: 963620
+
+  Catch2 test script — https://github.com/catchorg/Catch2
+  Catch2 is licensed under the BOOST license.
+ */
+
+#include "../lib_catch.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "../bethyw.h"
+#include "../datasets.h"
+#include "../areas.h"
+
+SCENARIO( "a dataset that fails to load stops loadDatasets", "[loadDatasets]" ) {
+
+  const std::string dir = "../datasets/";
+  const BethYw::InputFileSource missing = {
+    "missing",
+    "Missing dataset",
+    "missing.json",
+    BethYw::WelshStatsJSON,
+    BethYw::InputFiles::POPDEN.COLS
+  };
+  const std::string exceptionMessage =
+      "InputMmapFile::open: Failed to open file " + dir + missing.FILE;
+
+  GIVEN( "a missing dataset between two that exist" ) {
+
+    std::vector<BethYw::InputFileSource> datasets = {
+      BethYw::InputFiles::POPDEN, missing, BethYw::InputFiles::TRAINS};
+
+    THEN( "on one thread, the error is rethrown after the datasets before it are loaded" ) {
+
+      Areas areas = Areas();
+      REQUIRE_THROWS_WITH( BethYw::loadDatasets(areas, dir, datasets,
+                                                {}, {}, std::make_tuple(0, 0), 1),
+                           exceptionMessage );
+
+      Areas popden = Areas();
+      BethYw::loadDatasets(popden, dir, {BethYw::InputFiles::POPDEN},
+                           {}, {}, std::make_tuple(0, 0), 1);
+      REQUIRE( areas.size() > 0 );
+      REQUIRE( areas.toJSON() == popden.toJSON() );
+
+    } // THEN
+
+    THEN( "on several threads, the error is rethrown before any dataset is merged" ) {
+
+      Areas areas = Areas();
+      REQUIRE_THROWS_WITH( BethYw::loadDatasets(areas, dir, datasets,
+                                                {}, {}, std::make_tuple(0, 0), 4),
+                           exceptionMessage );
+      REQUIRE( areas.size() == 0 );
+
+    } // THEN
+
+  } // GIVEN
+
+} // SCENARIO